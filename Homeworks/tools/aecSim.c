@@ -0,0 +1,282 @@
+/*
+ *    ======== aecSim.c ========
+ *    Linux harness for the NLMS echo canceller (aec.c). Runs a far-end
+ *    (reference) and a microphone recording through aecProcess in 64-sample
+ *    blocks, as audioProcBlock does, and prints the ERLE of every
+ *    second and the time aecProcess takes per block.
+ *
+ *    Build and run on a Linux host:
+ *        make aecsim
+ *        ./aecsim [-t taps] [-m mu] [-o out.raw] [far.raw mic.raw]
+ *
+ *    The recordings are raw 16-bit little-endian mono at 8 kHz, the far
+ *    end being what the DAC played and the mic what the ADC took in over
+ *    the same samples. -o writes the cancelled signal the same way.
+ *    Without recordings a synthetic room is used: speech-like noise played
+ *    through a decaying echo path, with a near-end noise floor, and the
+ *    path changes half way through so reconvergence shows up too. The
+ *    synthetic run exits non-zero if the canceller does not reach
+ *    SIM_MIN_ERLE in the last second before and after the change.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "aec.h"
+
+#define SIM_RATE        8000
+#define SIM_BLOCK       64              /* AUDIO_BLOCKSIZE */
+#define SIM_WINDOW      SIM_RATE        /* samples per ERLE line */
+#define SIM_SECONDS     20
+#define SIM_PATH_LEN    96              /* synthetic echo path, < taps */
+#define SIM_MIN_ERLE    20.0            /* dB */
+
+static uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+/* xorshift64*, so every run is the same */
+static double uniform(void)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+
+    return ((double)((rng * 2685821657736338717ull) >> 11) / 9007199254740992.0);
+}
+
+static int16_t sat16(double v)
+{
+    return (v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t)lrint(v));
+}
+
+/*
+ *  ======== echoPath ========
+ *  A room as a short delay and an exponentially decaying random tail,
+ *  scaled so the echo comes back about 6 dB below what was played.
+ */
+static void echoPath(double *h)
+{
+    double   energy = 0;
+    unsigned i;
+
+    for (i = 0; i < SIM_PATH_LEN; i++) {
+        h[i] = i < 8 ? 0 : (uniform() - 0.5) * exp(-(double)i / 20.0);
+        energy += h[i] * h[i];
+    }
+    for (i = 0; i < SIM_PATH_LEN; i++) {
+        h[i] *= 0.5 / sqrt(energy);
+    }
+}
+
+/*
+ *  ======== synthesize ========
+ *  White noise through a two-pole resonance, gated on and off at a
+ *  syllable rate, is close enough to speech for an NLMS filter.
+ */
+static unsigned synthesize(int16_t **farOut, int16_t **micOut)
+{
+    unsigned n = SIM_SECONDS * SIM_RATE;
+    int16_t *far = malloc(n * sizeof(*far));
+    int16_t *mic = malloc(n * sizeof(*mic));
+    double   h[SIM_PATH_LEN], y1 = 0, y2 = 0, acc;
+    unsigned i, k;
+
+    if (far == NULL || mic == NULL) {
+        return (0);
+    }
+
+    for (i = 0; i < n; i++) {
+        double gate = 0.5 + 0.5 * sin(2 * M_PI * 4.0 * i / SIM_RATE);
+        double y = (uniform() - 0.5) * 12000 + 1.6 * y1 - 0.8 * y2;
+
+        y2 = y1;
+        y1 = y;
+        far[i] = sat16(y * (0.2 + 0.8 * gate) * 0.5);
+    }
+
+    echoPath(h);
+    for (i = 0; i < n; i++) {
+        if (i == n / 2) {
+            echoPath(h);
+        }
+        acc = (uniform() - 0.5) * 20;   /* near-end floor, about -65 dBFS */
+        for (k = 0; k < SIM_PATH_LEN && k <= i; k++) {
+            acc += h[k] * far[i - k];
+        }
+        mic[i] = sat16(acc);
+    }
+
+    *farOut = far;
+    *micOut = mic;
+
+    return (n);
+}
+
+/*
+ *  ======== load ========
+ *  Reads a raw recording; returns the number of samples.
+ */
+static unsigned load(const char *path, int16_t **out)
+{
+    FILE    *f = fopen(path, "rb");
+    long     size;
+    uint8_t *raw;
+    int16_t *s;
+    unsigned i, n;
+
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) < 0) {
+        perror(path);
+        return (0);
+    }
+    rewind(f);
+
+    n = (unsigned)(size / 2);
+    raw = malloc(n * 2 + 1);
+    s = malloc(n * sizeof(*s) + 1);
+    if (raw == NULL || s == NULL || fread(raw, 2, n, f) != n) {
+        fprintf(stderr, "aecsim: cannot read %s\n", path);
+        fclose(f);
+        return (0);
+    }
+    fclose(f);
+
+    for (i = 0; i < n; i++) {
+        s[i] = (int16_t)(raw[2 * i] | (raw[2 * i + 1] << 8));
+    }
+    free(raw);
+    *out = s;
+
+    return (n);
+}
+
+static double erleDb(double mic, double err)
+{
+    return (err > 0 && mic > 0 ? 10.0 * log10(mic / err) : 0.0);
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+int main(int argc, char *argv[])
+{
+    static Aec aec;
+    int16_t   *far, *mic, out[SIM_BLOCK];
+    const char *outPath = NULL;
+    FILE      *of = NULL;
+    unsigned   taps = AEC_DEF_TAPS, n, farN, i, j;
+    int        mu = AEC_DEF_MU, opt, synthetic;
+    double     micE = 0, errE = 0, settled[2] = {0, 0};
+    uint64_t   t, ns = 0, worst = 0;
+    unsigned   blocks = 0;
+
+    while ((opt = getopt(argc, argv, "t:m:o:")) != -1) {
+        switch (opt) {
+            case 't':
+                taps = atoi(optarg);
+                break;
+            case 'm':
+                mu = atoi(optarg);
+                break;
+            case 'o':
+                outPath = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: aecsim [-t taps] [-m mu] "
+                    "[-o out.raw] [far.raw mic.raw]\n");
+                return (2);
+        }
+    }
+
+    synthetic = optind == argc;
+    if (synthetic) {
+        n = synthesize(&far, &mic);
+    }
+    else if (argc - optind == 2) {
+        farN = load(argv[optind], &far);
+        n = load(argv[optind + 1], &mic);
+        n = farN < n ? farN : n;
+    }
+    else {
+        fprintf(stderr, "aecsim: need both a far-end and a mic file\n");
+        return (2);
+    }
+    if (n < SIM_BLOCK) {
+        fprintf(stderr, "aecsim: no input\n");
+        return (2);
+    }
+    if (outPath != NULL && (of = fopen(outPath, "wb")) == NULL) {
+        perror(outPath);
+        return (2);
+    }
+
+    aecInit(&aec, taps, (int16_t)mu);
+    printf("aecsim: %s, %u samples, %u taps, mu %d/32768\n",
+        synthetic ? "synthetic room" : "recording", n, aec.taps, mu);
+    printf("   time    ERLE\n");
+
+    for (i = 0; i + SIM_BLOCK <= n; i += SIM_BLOCK) {
+        t = nowNs();
+        aecProcess(&aec, &far[i], &mic[i], out, SIM_BLOCK);
+        t = nowNs() - t;
+        ns += t;
+        worst = t > worst ? t : worst;
+        blocks++;
+
+        for (j = 0; j < SIM_BLOCK; j++) {
+            micE += (double)mic[i + j] * mic[i + j];
+            errE += (double)out[j] * out[j];
+            if (of != NULL) {
+                uint8_t le[2] = {(uint8_t)out[j], (uint8_t)(out[j] >> 8)};
+
+                fwrite(le, 1, 2, of);
+            }
+        }
+
+        if ((i + SIM_BLOCK) % SIM_WINDOW == 0) {
+            unsigned end = i + SIM_BLOCK;
+
+            printf("%6.1f s %6.1f dB\n", (double)end / SIM_RATE,
+                erleDb(micE, errE));
+
+            /* the last second before the path change, and before the end */
+            if (end > n / 2 - SIM_RATE && end <= n / 2) {
+                settled[0] = settled[0] == 0 ? erleDb(micE, errE) :
+                    fmin(settled[0], erleDb(micE, errE));
+            }
+            if (end > n - SIM_RATE) {
+                settled[1] = settled[1] == 0 ? erleDb(micE, errE) :
+                    fmin(settled[1], erleDb(micE, errE));
+            }
+            micE = errE = 0;
+        }
+    }
+    if (of != NULL) {
+        fclose(of);
+    }
+
+    printf("overall ERLE %.1f dB (aecErleTenthsDb %d)\n",
+        aecErleTenthsDb(&aec) / 10.0, aecErleTenthsDb(&aec));
+    printf("aecProcess: %.0f ns/block mean, %llu ns worst, "
+        "%.2f ns per sample-tap; a block lasts %u us\n",
+        (double)ns / blocks, (unsigned long long)worst,
+        (double)ns / blocks / SIM_BLOCK / aec.taps,
+        SIM_BLOCK * 1000000u / SIM_RATE);
+
+    if (synthetic) {
+        printf("settled ERLE %.1f dB before the path change, %.1f dB "
+            "after (need %.0f)\n", settled[0], settled[1], SIM_MIN_ERLE);
+        return (settled[0] < SIM_MIN_ERLE || settled[1] < SIM_MIN_ERLE);
+    }
+
+    return (0);
+}
@@ -0,0 +1,544 @@
+/*
+ *    ======== clipSend.c ========
+ *    Linux sender for the clip upload (clipXfer.h): pushes a raw clip
+ *    into a board's arena on AUDIOCLIP_PORT, keeping a window of chunks in
+ *    flight, resending the holes the board's selective ACKs point at and
+ *    anything unacknowledged after a timeout.
+ *
+ *    The clip is the bare payload in one RTP format, for example from sox:
+ *        sox in.wav -r 8000 -c 1 -t raw -e signed -b 16 -B clip.raw  (l16)
+ *        sox in.wav -r 8000 -c 1 -t raw -e u-law clip.raw            (pcmu)
+ *
+ *    -T runs the receiver (clipXfer.c) in a thread on the loopback
+ *    interface, dropping datagrams both ways at several loss rates, and
+ *    checks every upload arrives intact. The exit status is 0 only if all
+ *    of it passed.
+ *
+ *    Build and run on a Linux host:
+ *        make clipsend
+ *        ./clipsend -f pcmu <IP-addr> clip.raw
+ *        ./clipsend -T
+ *    then "-clip play" on the board's control port or console.
+ */
+
+#include <poll.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "audioClip.h"
+#include "clipXfer.h"
+#include "rtp.h"
+
+#define DEF_CHUNK       1024
+#define DEF_WINDOW      16          /* no more than CLIPXFER_WINDOW helps */
+#define DEF_RTO_MS      20          /* least retransmission timeout */
+#define GIVE_UP_MS      5000        /* without an ACK */
+#define MAX_CLIP        (1 << 20)
+
+typedef struct {
+    unsigned chunkSize;
+    unsigned window;
+    unsigned rtoMs;
+    uint16_t session;
+} SendOpts;
+
+typedef struct {
+    ClipStatus status;
+    uint32_t   sent;            /* DATA packets, first copies and resends */
+    uint32_t   resent;
+    uint32_t   timeouts;
+    uint32_t   acks;
+    uint64_t   us;
+} SendResult;
+
+static const char *const statusNames[] = {
+    "ok", "done", "bad crc", "bad size", "bad format", "bad session"
+};
+
+static uint64_t nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+static const char *statusName(ClipStatus s)
+{
+    return ((unsigned)s <= CLIP_BAD_SESSION ? statusNames[s] : "?");
+}
+
+/*
+ *  ======== waitAck ========
+ *  The next ACK for this session within timeoutUs; false on timeout.
+ */
+static bool waitAck(int sock, uint16_t session, uint64_t timeoutUs,
+    ClipAck *ack)
+{
+    uint8_t       buf[64];
+    struct pollfd pfd = { sock, POLLIN, 0 };
+    uint64_t      end = nowUs() + timeoutUs;
+    uint64_t      now;
+    ssize_t       n;
+
+    while ((now = nowUs()) < end || timeoutUs == 0) {
+        n = recv(sock, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n >= 0) {
+            if (clipReadAck(buf, n, ack) && ack->session == session) {
+                return (true);
+            }
+            continue;
+        }
+        if (timeoutUs == 0 ||
+                poll(&pfd, 1, (int)((end - now + 999) / 1000)) <= 0) {
+            break;
+        }
+    }
+
+    return (false);
+}
+
+/*
+ *  ======== sendChunk ========
+ */
+static void sendChunk(int sock, const SendOpts *o, const uint8_t *clip,
+    uint32_t len, uint32_t chunk, SendResult *r)
+{
+    static uint8_t pkt[CLIPXFER_DATA_HDR_LEN + CLIPXFER_MAX_CHUNK];
+    uint32_t       off = chunk * o->chunkSize;
+    unsigned       n = len - off < o->chunkSize ? len - off : o->chunkSize;
+
+    n = clipWriteData(pkt, o->session, chunk, clip + off, n);
+    send(sock, pkt, n, 0);
+    r->sent++;
+}
+
+/*
+ *  ======== sendClip ========
+ *  One upload over a connected socket. Returns true if the board
+ *  answered DONE; r->status says what it answered in any case.
+ */
+static bool sendClip(int sock, const SendOpts *o, const uint8_t *clip,
+    uint32_t len, uint8_t format, SendResult *r)
+{
+    uint8_t   pkt[CLIPXFER_START_LEN];
+    uint32_t  chunks = (len + o->chunkSize - 1) / o->chunkSize;
+    uint64_t *sentUs = calloc(chunks, sizeof(*sentUs));
+    uint8_t  *acked = calloc(chunks, 1);
+    uint8_t  *copies = calloc(chunks, 1);
+    uint64_t  start = nowUs(), lastAck, now, rttUs = 0, rtoUs;
+    uint32_t  base = 0, next = 0, c;
+    ClipAck   ack;
+    unsigned  i, tries;
+    bool      answered = false, done = false;
+
+    memset(r, 0, sizeof(*r));
+    r->status = CLIP_BAD_SESSION;
+    if (sentUs == NULL || acked == NULL || copies == NULL) {
+        goto out;
+    }
+
+    /* START, until the board answers it */
+    clipWriteStart(pkt, o->session, len, format, o->chunkSize,
+        clipCrc32(0, clip, len));
+    for (tries = 0; tries < GIVE_UP_MS / (DEF_RTO_MS * 10); tries++) {
+        now = nowUs();
+        send(sock, pkt, sizeof(pkt), 0);
+        if (waitAck(sock, o->session, DEF_RTO_MS * 10000, &ack)) {
+            rttUs = nowUs() - now;
+            answered = true;
+            break;
+        }
+    }
+    if (!answered) {
+        fprintf(stderr, "clipsend: no answer to START\n");
+        goto out;
+    }
+    r->acks++;
+    r->status = ack.status;
+    if (ack.status != CLIP_OK) {
+        goto out;
+    }
+
+    lastAck = nowUs();
+    while (!done) {
+        /* fill the window */
+        while (next < chunks && next < base + o->window) {
+            sendChunk(sock, o, clip, len, next, r);
+            sentUs[next] = nowUs();
+            copies[next] = 1;
+            next++;
+        }
+
+        rtoUs = rttUs * 3 > o->rtoMs * 1000u ? rttUs * 3 : o->rtoMs * 1000u;
+        if (waitAck(sock, o->session, rtoUs / 4, &ack)) {
+            do {
+                now = nowUs();
+                r->acks++;
+                lastAck = now;
+                r->status = ack.status;
+                if (ack.status == CLIP_DONE) {
+                    done = true;
+                    break;
+                }
+                if (ack.status != CLIP_OK) {
+                    goto out;
+                }
+
+                /* RTT from chunks sent once (Karn) */
+                if (ack.next > base && ack.next <= chunks &&
+                        copies[ack.next - 1] == 1) {
+                    rttUs = (7 * rttUs + (now - sentUs[ack.next - 1])) / 8;
+                }
+                for (c = base; c < ack.next && c < chunks; c++) {
+                    acked[c] = 1;
+                }
+                if (ack.next > base) {
+                    base = ack.next < chunks ? ack.next : chunks;
+                }
+                for (i = 0; i < 32; i++) {
+                    if ((ack.sack >> i & 1) && ack.next + 1 + i < chunks) {
+                        acked[ack.next + 1 + i] = 1;
+                    }
+                }
+
+                /* holes below a chunk that arrived: resend after one RTT */
+                i = 32;
+                while (i > 0 && !(ack.sack >> (i - 1) & 1)) {
+                    i--;
+                }
+                for (c = base; c < ack.next + i && c < next; c++) {
+                    if (!acked[c] && now - sentUs[c] > rttUs + rttUs / 4) {
+                        sendChunk(sock, o, clip, len, c, r);
+                        sentUs[c] = nowUs();
+                        copies[c]++;
+                        r->resent++;
+                    }
+                }
+            } while (waitAck(sock, o->session, 0, &ack));
+            continue;
+        }
+
+        now = nowUs();
+        if (now - lastAck > GIVE_UP_MS * 1000ull) {
+            fprintf(stderr, "clipsend: no ACK for %u ms\n", GIVE_UP_MS);
+            goto out;
+        }
+
+        /* anything out longer than the timeout, whose ACK may be lost */
+        for (c = base; c < next; c++) {
+            if (!acked[c] && now - sentUs[c] > rtoUs) {
+                sendChunk(sock, o, clip, len, c, r);
+                sentUs[c] = nowUs();
+                copies[c]++;
+                r->resent++;
+                r->timeouts++;
+            }
+        }
+    }
+
+out:
+    r->us = nowUs() - start;
+    free(sentUs);
+    free(acked);
+    free(copies);
+
+    return (done);
+}
+
+/*
+ *  ======== report ========
+ */
+static void report(const char *what, uint32_t len, const SendResult *r)
+{
+    printf("%s%u bytes in %.1f ms, %.2f Mbit/s: %s; sent %u resent %u "
+        "(timeouts %u) acks %u\n", what, len, r->us / 1000.0,
+        r->us ? len * 8.0 / r->us : 0.0, statusName(r->status), r->sent,
+        r->resent, r->timeouts, r->acks);
+}
+
+/*
+ *  ======== loopback test ========
+ *  The board's receiver on 127.0.0.1 in a thread, with its own arena,
+ *  dropping a share of the datagrams it gets and of the ACKs it sends.
+ */
+typedef struct {
+    int           sock;
+    volatile bool stop;
+    unsigned      lossPct;
+    unsigned      seed;
+    uint32_t      dropped;
+    ClipRx        rx;
+    uint8_t       arena[AUDIOCLIP_ARENA_SIZE];
+} LoopRx;
+
+static bool lose(LoopRx *l)
+{
+    return (l->lossPct && (unsigned)rand_r(&l->seed) % 100 < l->lossPct);
+}
+
+static void *loopRxFxn(void *arg)
+{
+    LoopRx            *l = arg;
+    uint8_t            buf[2048], ack[CLIPXFER_ACK_LEN];
+    struct sockaddr_in from;
+    socklen_t          fromLen;
+    ssize_t            n;
+    unsigned           len;
+
+    while (!l->stop) {
+        fromLen = sizeof(from);
+        n = recvfrom(l->sock, buf, sizeof(buf), 0, (struct sockaddr *)&from,
+            &fromLen);
+        if (n < 0) {
+            continue;
+        }
+        if (lose(l)) {
+            l->dropped++;
+            continue;
+        }
+        len = clipRxPacket(&l->rx, buf, n, ack);
+        if (len > 0) {
+            if (lose(l)) {
+                l->dropped++;
+                continue;
+            }
+            sendto(l->sock, ack, len, 0, (struct sockaddr *)&from, fromLen);
+        }
+    }
+
+    return (NULL);
+}
+
+/*
+ *  ======== loopCase ========
+ *  One upload through a fresh receiver; true if the outcome was expected.
+ */
+static bool loopCase(const uint8_t *clip, uint32_t len, uint8_t format,
+    unsigned chunkSize, unsigned window, unsigned lossPct, ClipStatus want)
+{
+    static LoopRx      l;
+    struct sockaddr_in addr;
+    socklen_t          addrLen = sizeof(addr);
+    struct timeval     tv = { 0, 10000 };
+    pthread_t          thread;
+    SendOpts           o = { chunkSize, window, DEF_RTO_MS, 0 };
+    SendResult         r;
+    int                sock;
+    bool               ok;
+    char               what[80];
+
+    memset(&l, 0, sizeof(l));
+    clipRxInit(&l.rx, l.arena, sizeof(l.arena));
+    l.lossPct = lossPct;
+    l.seed = 1 + lossPct * 31 + window;
+    o.session = (uint16_t)(lossPct * 100 + window);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    l.sock = socket(AF_INET, SOCK_DGRAM, 0);
+    bind(l.sock, (struct sockaddr *)&addr, sizeof(addr));
+    getsockname(l.sock, (struct sockaddr *)&addr, &addrLen);
+    setsockopt(l.sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    connect(sock, (struct sockaddr *)&addr, sizeof(addr));
+    pthread_create(&thread, NULL, loopRxFxn, &l);
+
+    sendClip(sock, &o, clip, len, format, &r);
+
+    l.stop = true;
+    pthread_join(thread, NULL);
+    close(sock);
+    close(l.sock);
+
+    ok = r.status == want;
+    if (want == CLIP_DONE) {
+        ok = ok && l.rx.status == CLIP_DONE && l.rx.length == len &&
+            memcmp(l.arena, clip, len) == 0;
+    }
+    snprintf(what, sizeof(what), "%s chunk %4u window %2u loss %2u%%: ",
+        ok ? "pass" : "FAIL", chunkSize, window, lossPct);
+    report(what, len, &r);
+
+    return (ok);
+}
+
+/*
+ *  ======== shortCase ========
+ *  DATA cut short anywhere in its header, each copy in a buffer of
+ *  exactly its length (so a sanitizer build sees any read past it):
+ *  every one must be dropped and counted, and the transfer go on.
+ */
+static bool shortCase(const uint8_t *clip)
+{
+    static uint8_t arena[4 * DEF_CHUNK];
+    uint8_t        pkt[CLIPXFER_DATA_HDR_LEN + DEF_CHUNK];
+    uint8_t        ack[CLIPXFER_ACK_LEN];
+    uint8_t       *cut;
+    ClipRx         rx;
+    unsigned       len, n;
+    bool           ok = true;
+
+    clipRxInit(&rx, arena, sizeof(arena));
+    n = clipWriteStart(pkt, 7, sizeof(arena), RTP_PT_L16, DEF_CHUNK,
+        clipCrc32(0, clip, sizeof(arena)));
+    ok = clipRxPacket(&rx, pkt, n, ack) > 0 && rx.active;
+
+    n = clipWriteData(pkt, 7, 0, clip, DEF_CHUNK);
+    for (len = CLIPXFER_HDR_LEN; len < CLIPXFER_DATA_HDR_LEN; len++) {
+        cut = malloc(len);
+        memcpy(cut, pkt, len);
+        ok = ok && clipRxPacket(&rx, cut, len, ack) == 0;
+        free(cut);
+    }
+    ok = ok && rx.stats.badChunks == CLIPXFER_DATA_HDR_LEN - CLIPXFER_HDR_LEN &&
+        rx.received == 0;
+
+    /* the whole chunk still goes in */
+    clipRxPacket(&rx, pkt, n, ack);
+    ok = ok && rx.received == 1;
+
+    printf("%s short DATA headers: %u dropped\n", ok ? "pass" : "FAIL",
+        rx.stats.badChunks);
+
+    return (ok);
+}
+
+/*
+ *  ======== loopTest ========
+ */
+static int loopTest(void)
+{
+    static const unsigned loss[] = { 0, 1, 5, 20 };
+    static uint8_t clip[AUDIOCLIP_ARENA_SIZE + 1];
+    uint32_t       seed = 12345;
+    unsigned       i, failed = 0;
+
+    for (i = 0; i < sizeof(clip); i++) {
+        seed = seed * 1103515245 + 12345;
+        clip[i] = (uint8_t)(seed >> 16);
+    }
+
+    /* the clip CRC, against the usual check value */
+    if (clipCrc32(0, "123456789", 9) != 0xCBF43926) {
+        printf("FAIL crc32\n");
+        failed++;
+    }
+
+    for (i = 0; i < sizeof(loss) / sizeof(loss[0]); i++) {
+        failed += !loopCase(clip, 60001, RTP_PT_L16, DEF_CHUNK, DEF_WINDOW,
+            loss[i], CLIP_DONE);
+    }
+
+    /* the smallest chunks fill the arena; a window past the receiver's */
+    failed += !loopCase(clip, AUDIOCLIP_ARENA_SIZE, RTP_PT_PCMU,
+        CLIPXFER_MIN_CHUNK, CLIPXFER_WINDOW, 5, CLIP_DONE);
+    failed += !loopCase(clip, 40000, RTP_PT_DVI4, CLIPXFER_MAX_CHUNK,
+        2 * CLIPXFER_WINDOW, 5, CLIP_DONE);
+
+    /* refusals */
+    failed += !loopCase(clip, AUDIOCLIP_ARENA_SIZE + 1, RTP_PT_L16,
+        DEF_CHUNK, DEF_WINDOW, 0, CLIP_BAD_SIZE);
+    failed += !loopCase(clip, 1000, 99, DEF_CHUNK, DEF_WINDOW, 0,
+        CLIP_BAD_FORMAT);
+    failed += !shortCase(clip);
+
+    printf("%s\n", failed ? "FAILED" : "all passed");
+
+    return (failed ? 1 : 0);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s [-p port] [-f l16|pcmu|pcma|dvi4] "
+        "[-c chunk] [-w window] [-t rto-ms] host file\n"
+        "       %s -T    (loopback test)\n", prog, prog);
+    exit(2);
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    SendOpts           o = { DEF_CHUNK, DEF_WINDOW, DEF_RTO_MS, 0 };
+    SendResult         r;
+    struct sockaddr_in addr;
+    uint8_t           *clip;
+    uint8_t            format = RTP_PT_L16;
+    unsigned           port = AUDIOCLIP_PORT;
+    size_t             len;
+    FILE              *f;
+    int                sock, c;
+
+    while ((c = getopt(argc, argv, "p:f:c:w:t:T")) != -1) {
+        switch (c) {
+            case 'p':
+                port = strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                format = !strcmp(optarg, "pcmu") ? RTP_PT_PCMU :
+                    !strcmp(optarg, "pcma") ? RTP_PT_PCMA :
+                    !strcmp(optarg, "dvi4") ? RTP_PT_DVI4 : RTP_PT_L16;
+                break;
+            case 'c':
+                o.chunkSize = strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                o.window = strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                o.rtoMs = strtoul(optarg, NULL, 0);
+                break;
+            case 'T':
+                return (loopTest());
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (optind + 2 != argc || o.window == 0 ||
+            o.chunkSize < CLIPXFER_MIN_CHUNK ||
+            o.chunkSize > CLIPXFER_MAX_CHUNK) {
+        usage(argv[0]);
+    }
+
+    f = fopen(argv[optind + 1], "rb");
+    clip = malloc(MAX_CLIP);
+    if (f == NULL || clip == NULL) {
+        perror(argv[optind + 1]);
+        return (1);
+    }
+    len = fread(clip, 1, MAX_CLIP, f);
+    fclose(f);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, argv[optind], &addr.sin_addr) != 1) {
+        usage(argv[0]);
+    }
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0 || connect(sock, (struct sockaddr *)&addr,
+            sizeof(addr)) < 0) {
+        perror("socket");
+        return (1);
+    }
+
+    o.session = (uint16_t)(time(NULL) ^ getpid());
+    sendClip(sock, &o, clip, (uint32_t)len, format, &r);
+    report("clipsend: ", (uint32_t)len, &r);
+
+    return (r.status == CLIP_DONE ? 0 : 1);
+}
@@ -0,0 +1,125 @@
+/*
+ *    ======== clockSyncSim.c ========
+ *    Linux simulation for the clock sync servo (clockSync.c). Two clocks
+ *    with a fixed offset and a relative drift exchange timestamps once a
+ *    period over a link with random queueing delay, a fraction of it on
+ *    one leg only, and the servo's prediction of the remote clock is
+ *    checked against the truth after every exchange.
+ *
+ *    Build and run on a Linux host:
+ *        make clocksim
+ *        ./clocksim [drift-ppm [jitter-us [seconds [period-ms [seed]]]]]
+ *
+ *    The exit status is 0 if the error stayed within SIM_BOUND_US once
+ *    locked.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "clockSync.h"
+
+#define SIM_BASE_US     80.0        /* one-way wire and stack time */
+#define SIM_SERVER_US   15.0        /* server turnaround */
+#define SIM_BURST_PCT   10          /* exchanges that hit a long queue */
+#define SIM_BURST_US    3000.0
+#define SIM_SETTLE_S    60          /* error is judged after this */
+#define SIM_BOUND_US    50.0
+
+static uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+/* xorshift64*, so a seed reproduces a run exactly */
+static double uniform(void)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+
+    return ((double)((rng * 2685821657736338717ull) >> 11) / 9007199254740992.0);
+}
+
+static double expo(double mean)
+{
+    return (-mean * log(1.0 - uniform()));
+}
+
+/* one leg of the link: fixed part, queueing, the odd long burst */
+static double leg(double jitter)
+{
+    double d = SIM_BASE_US + expo(jitter);
+
+    if (uniform() * 100 < SIM_BURST_PCT) {
+        d += uniform() * SIM_BURST_US;
+    }
+
+    return (d);
+}
+
+int main(int argc, char *argv[])
+{
+    double    driftPpm = argc > 1 ? atof(argv[1]) : 50.0;
+    double    jitter   = argc > 2 ? atof(argv[2]) : 30.0;
+    unsigned  seconds  = argc > 3 ? atoi(argv[3]) : 600;
+    unsigned  periodMs = argc > 4 ? atoi(argv[4]) : 1000;
+    double    localRate = 1.0 + driftPpm / 1e6;
+    double    localOff = 123456789.0;       /* local - true at t = 0, us */
+    double    remoteOff = 5000000.0;
+    double    t, maxErr = 0, sumSq = 0;
+    unsigned  judged = 0;
+    int       lockedAt = -1;
+    ClockSync cs;
+
+    if (argc > 5) {
+        rng ^= strtoull(argv[5], NULL, 0) * 0x2545F4914F6CDD1Dull;
+    }
+    clockSyncInit(&cs);
+
+    printf("clocksim: drift %.1f ppm, jitter %.0f us, %u s, every %u ms\n",
+        driftPpm, jitter, seconds, periodMs);
+
+    for (t = 1e6; t < seconds * 1e6; t += periodMs * 1000.0) {
+        /* true times of the four events */
+        double   e1 = t;
+        double   e2 = e1 + leg(jitter);
+        double   e3 = e2 + SIM_SERVER_US;
+        double   e4 = e3 + leg(jitter);
+        uint64_t t1 = (uint64_t)(e1 * localRate + localOff);
+        uint64_t t2 = (uint64_t)(e2 + remoteOff);
+        uint64_t t3 = (uint64_t)(e3 + remoteOff);
+        uint64_t t4 = (uint64_t)(e4 * localRate + localOff);
+        double   now, err;
+
+        clockSyncSample(&cs, t1, t2, t3, t4);
+        if (!clockSyncLocked(&cs)) {
+            continue;
+        }
+        if (lockedAt < 0) {
+            lockedAt = (int)(t / 1e6);
+        }
+
+        /* check halfway to the next exchange, where prediction is worst */
+        now = e4 + periodMs * 500.0;
+        err = (double)clockSyncToRemote(&cs,
+                (uint64_t)(now * localRate + localOff)) - (now + remoteOff);
+        if (t / 1e6 < SIM_SETTLE_S) {
+            continue;
+        }
+        judged++;
+        sumSq += err * err;
+        if (fabs(err) > maxErr) {
+            maxErr = fabs(err);
+        }
+    }
+
+    printf("locked after %d s; after %d s: rms %.2f us, max %.2f us over %u "
+        "checks\n", lockedAt, SIM_SETTLE_S, judged ? sqrt(sumSq / judged) : 0.0,
+        maxErr, judged);
+    printf("drift estimate %d ppb (true %.0f ppb); exchanges %u, rejected %u, "
+        "steps %u\n", cs.driftPpb,
+        (1.0 / localRate - 1.0) * 1e9, cs.stats.exchanges, cs.stats.rejected,
+        cs.stats.steps);
+
+    return (judged > 0 && maxErr <= SIM_BOUND_US ? 0 : 1);
+}
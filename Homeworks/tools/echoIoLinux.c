@@ -0,0 +1,173 @@
+/*
+ *    ======== echoIoLinux.c ========
+ *    Linux shim and main() for the portable echo core: a host reference
+ *    server that batches with recvmmsg()/sendmmsg().
+ *
+ *    Build and run on a Linux host:
+ *        make udpechod
+ *        ./udpechod [port [batch [reflect]]]
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "echoCore.h"
+
+#define UDPPACKETSIZE 1472
+#define DEF_PORT      1000
+
+typedef struct {
+    int                sock;
+    struct mmsghdr     hdr[ECHO_MAX_BATCH];
+    struct iovec       iov[ECHO_MAX_BATCH];
+    struct sockaddr_in peer[ECHO_MAX_BATCH];
+    uint8_t            buf[ECHO_MAX_BATCH][UDPPACKETSIZE];
+} LinuxIo;
+
+/*
+ *  ======== setupHdrs ========
+ *  Points the kernel's message headers at whatever the core left in msgs.
+ */
+static void setupHdrs(LinuxIo *io, EchoMsg *msgs, unsigned n, bool rx)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        io->iov[i].iov_base = msgs[i].buf;
+        io->iov[i].iov_len  = rx ? msgs[i].cap : msgs[i].len;
+
+        memset(&io->hdr[i], 0, sizeof(io->hdr[i]));
+        io->hdr[i].msg_hdr.msg_name    = msgs[i].peer;
+        io->hdr[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        io->hdr[i].msg_hdr.msg_iov     = &io->iov[i];
+        io->hdr[i].msg_hdr.msg_iovlen  = 1;
+    }
+}
+
+/*
+ *  ======== recvBatch ========
+ */
+static int recvBatch(void *ctx, EchoMsg *msgs, unsigned max)
+{
+    LinuxIo *io = ctx;
+    int      n, i;
+
+    setupHdrs(io, msgs, max, true);
+
+    /* block for the first datagram, then take whatever else is queued */
+    do {
+        n = recvmmsg(io->sock, io->hdr, max, MSG_WAITFORONE, NULL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        perror("recvmmsg");
+        return (-1);
+    }
+
+    for (i = 0; i < n; i++) {
+        msgs[i].len = io->hdr[i].msg_len;
+    }
+
+    return (n);
+}
+
+/*
+ *  ======== sendBatch ========
+ */
+static int sendBatch(void *ctx, EchoMsg *msgs, unsigned n)
+{
+    LinuxIo *io = ctx;
+    unsigned done = 0;
+    int      r;
+
+    setupHdrs(io, msgs, n, false);
+
+    while (done < n) {
+        r = sendmmsg(io->sock, &io->hdr[done], n - done, 0);
+        if (r <= 0) {
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += r;
+    }
+
+    return ((int)done);
+}
+
+/*
+ *  ======== nowUs ========
+ */
+static uint64_t nowUs(void *ctx)
+{
+    struct timespec now;
+
+    (void)ctx;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000);
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    static LinuxIo     io;
+    static EchoMsg     msgs[ECHO_MAX_BATCH];
+    static EchoStats   stats;
+    const EchoIo       ops = { recvBatch, sendBatch, NULL, nowUs };
+    struct sockaddr_in addr;
+    int                port = argc > 1 ? atoi(argv[1]) : DEF_PORT;
+    int                batch = argc > 2 ? atoi(argv[2]) : ECHO_MAX_BATCH;
+    int                i;
+
+    if (batch < 1 || batch > ECHO_MAX_BATCH) {
+        fprintf(stderr, "batch must be 1..%d\n", ECHO_MAX_BATCH);
+        return (1);
+    }
+
+    io.sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (io.sock < 0) {
+        perror("socket");
+        return (1);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port        = htons(port);
+    if (bind(io.sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return (1);
+    }
+
+    for (i = 0; i < ECHO_MAX_BATCH; i++) {
+        msgs[i].buf  = io.buf[i];
+        msgs[i].cap  = UDPPACKETSIZE;
+        msgs[i].peer = &io.peer[i];
+    }
+
+    if (argc > 3 && strcmp(argv[3], "reflect") == 0) {
+        echoCoreMode = ECHO_MODE_REFLECT;
+    }
+
+    printf("udpechod: port %d, batch %d%s\n", port, batch,
+        echoCoreMode == ECHO_MODE_REFLECT ? ", reflect" : "");
+    echoCoreRun(&ops, &io, msgs, batch, &stats);
+
+    printf("packets %u bytes %u errors %u\n", stats.packets, stats.bytes,
+        stats.errors);
+    close(io.sock);
+
+    return (1);
+}
@@ -0,0 +1,184 @@
+/*
+ *    ======== fecSim.c ========
+ *    Linux loss-injection test for the XOR-parity FEC (fec.c). Streams
+ *    RTP packets shaped like audioTxFxn's through the encoder, drops
+ *    packets (media and parity alike) at random, optionally in bursts,
+ *    feeds the survivors to the decoder and checks every recovered packet
+ *    byte for byte against what was sent. Reports the residual loss and
+ *    the bandwidth overhead for each K.
+ *
+ *    Build and run on a Linux host:
+ *        make fecsim
+ *        ./fecsim [loss-% [burst-len [packets [seed]]]]
+ *
+ *    burst-len is the mean length of a loss run (Gilbert model); 1 gives
+ *    independent losses. The exit status is non-zero on any mismatch.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fec.h"
+#include "rtp.h"
+
+#define SIM_FRAME_BYTES 128     /* one 8 ms L16 block */
+
+static uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+/* xorshift64*, so a seed reproduces a run exactly */
+static double uniform(void)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+
+    return ((double)((rng * 2685821657736338717ull) >> 11) / 9007199254740992.0);
+}
+
+/*
+ *  Two-state Gilbert channel with the given loss rate and mean burst
+ *  length: once in the loss state it stays there with 1 - 1/burst.
+ */
+static int dropped(double loss, double burst)
+{
+    static int bad;
+    double     pGoodToBad = loss / (burst * (1.0 - loss));
+
+    if (bad) {
+        bad = uniform() >= 1.0 / burst;
+    }
+    else {
+        bad = uniform() < pGoodToBad;
+    }
+
+    return (bad);
+}
+
+/*
+ *  ======== buildPacket ========
+ *  Payload size varies like a sender changing frames per packet, so the
+ *  length recovery and zero padding get exercised.
+ */
+static unsigned buildPacket(uint8_t *p, uint16_t seq)
+{
+    RtpHeader hdr;
+    unsigned  frames = 1 + seq % 3;
+    unsigned  len, i;
+
+    hdr.pt     = RTP_PT_L16;
+    hdr.marker = (seq % 50) == 0;
+    hdr.seq    = seq;
+    hdr.ts     = seq * 160u;
+    hdr.ssrc   = 0xC0A80164;
+    len = rtpWriteHeader(p, &hdr);
+    for (i = 0; i < frames * SIM_FRAME_BYTES; i++) {
+        p[len++] = (uint8_t)(uniform() * 256);
+    }
+
+    return (len);
+}
+
+/*
+ *  ======== run ========
+ *  Returns the number of recovered packets that did not match.
+ */
+static unsigned run(unsigned k, double loss, double burst, unsigned count)
+{
+    static FecEncoder enc;
+    static FecDecoder dec;
+    static uint8_t    sent[65536][FEC_MAX_MEDIA];
+    static unsigned   sentLen[65536];
+    static bool       got[65536];
+    static uint32_t   rx[(FEC_PARITY_OFF + FEC_MAX_MEDIA + 3) / 4];
+    uint8_t          *buf = (uint8_t *)rx;
+    uint64_t          mediaBytes = 0, parityBytes = 0;
+    unsigned          lost = 0, missing = 0, bad = 0;
+    unsigned          i;
+
+    memset(&enc, 0, sizeof(enc));
+    fecEncInit(&enc, k);
+    fecDecInit(&dec);
+    memset(got, 0, sizeof(got));
+    if (count > 65536) {
+        count = 65536;
+    }
+
+    for (i = 0; i < count; i++) {
+        uint16_t seq = (uint16_t)(i + 65536 - 1000); /* crosses the wrap */
+        unsigned len = buildPacket(sent[seq], seq);
+        unsigned plen;
+
+        sentLen[seq] = len;
+        mediaBytes += len;
+
+        if (!dropped(loss, burst)) {
+            got[seq] = true;
+            fecDecMedia(&dec, sent[seq], len);
+        }
+        else {
+            lost++;
+        }
+
+        plen = fecEncAdd(&enc, sent[seq], len);
+        if (plen == 0) {
+            continue;
+        }
+        parityBytes += plen;
+        if (dropped(loss, burst)) {
+            continue;
+        }
+
+        /* the decoder works in place, so hand it a copy */
+        memcpy(buf, enc.packet, plen);
+        len = fecDecParity(&dec, buf, plen);
+        if (len) {
+            uint16_t rseq = (uint16_t)((buf[FEC_PARITY_OFF + 2] << 8) |
+                    buf[FEC_PARITY_OFF + 3]);
+
+            if (got[rseq] || len != sentLen[rseq] ||
+                    memcmp(&buf[FEC_PARITY_OFF], sent[rseq], len) != 0) {
+                bad++;
+            }
+            got[rseq] = true;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        if (!got[(uint16_t)(i + 65536 - 1000)]) {
+            missing++;
+        }
+    }
+
+    printf("k %2u: lost %5.2f%% -> %5.2f%% (recovered %u of %u), "
+        "overhead %5.1f%%, unrecoverable groups %u, mismatches %u\n",
+        k, 100.0 * lost / count, 100.0 * missing / count,
+        dec.stats.recovered, lost, 100.0 * parityBytes / mediaBytes,
+        dec.stats.unrecoverable, bad);
+
+    return (bad);
+}
+
+int main(int argc, char *argv[])
+{
+    double   loss  = (argc > 1 ? atof(argv[1]) : 2.0) / 100.0;
+    double   burst = argc > 2 ? atof(argv[2]) : 1.0;
+    unsigned count = argc > 3 ? atoi(argv[3]) : 50000;
+    unsigned k, bad = 0;
+
+    if (argc > 4) {
+        rng ^= strtoull(argv[4], NULL, 0) * 0x2545F4914F6CDD1Dull;
+    }
+    if (loss <= 0 || loss >= 1 || burst < 1) {
+        fprintf(stderr, "fecsim: loss must be in (0, 100), burst >= 1\n");
+        return (2);
+    }
+
+    printf("fecsim: %u packets, %.2f%% loss, mean burst %.1f\n", count,
+        loss * 100, burst);
+    for (k = 2; k <= FEC_MAX_K; k *= 2) {
+        bad += run(k, loss, burst, count);
+    }
+
+    return (bad ? 1 : 0);
+}
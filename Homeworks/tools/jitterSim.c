@@ -0,0 +1,346 @@
+/*
+ *    ======== jitterSim.c ========
+ *    Linux test for the jitter buffer (jitter.c) and the mixer's slot
+ *    handling (mixer.c). A sender makes packets of one or more 8 ms frames
+ *    with timestamps near the 32-bit wrap; a simulated network delays them
+ *    (a fixed path plus random jitter), loses some and holds some back so
+ *    the next overtakes them; jbGet runs once per frame of the local clock.
+ *    Every frame carries its index, so the order of what plays is checked
+ *    as well as the buffer's counters:
+ *
+ *      clean     nothing lost, late or reordered, every frame played once
+ *      loss      lost + underruns match the frames the network ate, and
+ *                each concealed frame is the last good one, faded
+ *      reorder   reordered counts the overtaken packets, none is late
+ *      jitter    the depth grows with the jitter, few frames are late,
+ *                and shrinks back once the jitter stops
+ *      late      a packet held up past its playout time counts as late
+ *      restart   the sender restarts with the same SSRC and new bases
+ *      idle      a mixer slot whose packets are all late expires
+ *
+ *    Build and run on a Linux host:
+ *        make jittersim && ./jittersim
+ *
+ *    The exit status is non-zero if any check failed.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jitter.h"
+#include "mixer.h"
+
+#define BLK             AUDIO_BLOCKSIZE
+#define SIM_FRAMES      3750            /* 30 s */
+#define SIM_TS0         0xFFFF0000u     /* wraps after 16 frames */
+#define SIM_SEQ0        65500
+#define SIM_SSRC        0x0A000002
+#define SIM_PATH        (20 * 8)        /* 20 ms one way, in samples */
+#define SIM_MAX_PACKETS (SIM_FRAMES + 16)
+#define SIM_MAX_FPP     8
+
+typedef struct {
+    uint16_t seq;
+    uint32_t ts;
+    unsigned first;                     /* index of the first frame */
+    unsigned nFrames;
+    uint32_t arrival;                   /* local clock, samples */
+    bool     lost;
+} Packet;
+
+typedef struct {
+    unsigned fpp;
+    unsigned lossPct;
+    unsigned reorderPct;
+    unsigned jitterMs;                  /* up to, uniformly; first half */
+    int      lateFrame;                 /* packet with this frame is held */
+    int      restartFrame;              /* the sender restarts here */
+} Scenario;
+
+typedef struct {
+    unsigned played;                    /* frames out of the buffer */
+    unsigned concealed;
+    unsigned badFade;                   /* concealment not as specified */
+    unsigned disorder;                  /* a frame older than one played */
+    unsigned missing;                   /* frames the network lost */
+    unsigned overtaken;                 /* packets held back a slot */
+    unsigned midTarget;                 /* targetDepth half way */
+    unsigned endTarget;
+} Outcome;
+
+static uint32_t rng = 12345;
+
+static unsigned rnd(unsigned n)
+{
+    rng = rng * 1103515245 + 12345;
+
+    return ((rng >> 8) % n);
+}
+
+/* frame k says which it is in sample 0; the rest is a ramp */
+static void makeFrame(int16_t *s, unsigned k)
+{
+    unsigned i;
+
+    s[0] = (int16_t)(k + 1);
+    for (i = 1; i < BLK; i++) {
+        s[i] = (int16_t)(1000 + 37 * i);
+    }
+}
+
+static int cmpArrival(const void *a, const void *b)
+{
+    const Packet *p = a;
+    const Packet *q = b;
+
+    return ((int32_t)(p->arrival - q->arrival) > 0) -
+        ((int32_t)(p->arrival - q->arrival) < 0);
+}
+
+/*
+ *  ======== buildPackets ========
+ *  The sender's packets with their arrival times, in arrival order.
+ */
+static unsigned buildPackets(const Scenario *sc, Packet *pk, Outcome *o)
+{
+    uint32_t tsBase = SIM_TS0;
+    uint16_t seq = SIM_SEQ0;
+    unsigned k, n = 0;
+
+    for (k = 0; k + sc->fpp <= SIM_FRAMES; k += sc->fpp) {
+        Packet  *p = &pk[n++];
+        uint32_t sent = (k + sc->fpp) * BLK;    /* complete at the sender */
+        unsigned jitter = k < SIM_FRAMES / 2 ? sc->jitterMs : 0;
+
+        if (sc->restartFrame >= 0 && k == (unsigned)sc->restartFrame) {
+            /* a reboot: same SSRC (our IP), new random bases */
+            tsBase = SIM_TS0 - 8000000;     /* 1000 s behind */
+            seq = 777;
+        }
+        p->seq = seq++;
+        p->ts = tsBase + k * BLK;
+        p->first = k;
+        p->nFrames = sc->fpp;
+        p->arrival = sent + SIM_PATH + (jitter ? rnd(jitter * 8) : 0);
+        p->lost = sc->lossPct && rnd(100) < sc->lossPct;
+        if (sc->lateFrame >= 0 && k <= (unsigned)sc->lateFrame &&
+                (unsigned)sc->lateFrame < k + sc->fpp) {
+            p->arrival += 300 * 8;      /* 300 ms, past any depth */
+        }
+        if (sc->reorderPct && rnd(100) < sc->reorderPct) {
+            /* the packet after this one overtakes it */
+            p->arrival += sc->fpp * BLK + 1;
+        }
+        if (p->lost) {
+            o->missing += sc->fpp;
+        }
+    }
+
+    qsort(pk, n, sizeof(pk[0]), cmpArrival);
+
+    return (n);
+}
+
+/*
+ *  ======== checkFade ========
+ *  The nth concealed frame in a row repeats the last good frame with the
+ *  gain ramping from (F-n)/F to (F-n-1)/F across it, F = JB_FADE_FRAMES.
+ */
+static bool checkFade(const int16_t *out, const int16_t *last, unsigned n)
+{
+    int32_t  g0 = n >= JB_FADE_FRAMES ? 0 :
+        32767 * (int32_t)(JB_FADE_FRAMES - n) / JB_FADE_FRAMES;
+    int32_t  g1 = n + 1 >= JB_FADE_FRAMES ? 0 :
+        32767 * (int32_t)(JB_FADE_FRAMES - n - 1) / JB_FADE_FRAMES;
+    unsigned i;
+
+    for (i = 0; i < BLK; i++) {
+        int32_t g = g0 + ((g1 - g0) * (int32_t)i) / BLK;
+
+        if (out[i] != (int16_t)((last[i] * g) >> 15)) {
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+/*
+ *  ======== run ========
+ */
+static void run(const Scenario *sc, JitterBuffer *jb, Outcome *o)
+{
+    static Packet  pk[SIM_MAX_PACKETS];
+    static int16_t samples[SIM_MAX_FPP * BLK];
+    int16_t        out[BLK], last[BLK];
+    unsigned       n, next = 0, fades = 0, i;
+    int            newest = -1;
+    uint32_t       now, concealments;
+    uint16_t       highest = SIM_SEQ0 - 1;
+
+    memset(o, 0, sizeof(*o));
+    memset(last, 0, sizeof(last));
+    jbInit(jb);
+    n = buildPackets(sc, pk, o);
+
+    /* until the sender is done and the buffer has played out */
+    for (now = 0; next < n || jbDepth(jb) > 0; now += BLK) {
+        for (; next < n && (int32_t)(pk[next].arrival - now) <= 0; next++) {
+            Packet *p = &pk[next];
+
+            if (p->lost) {
+                continue;
+            }
+            if ((int16_t)(p->seq - highest) < 0) {
+                o->overtaken++;
+            }
+            else {
+                highest = p->seq;
+            }
+            for (i = 0; i < p->nFrames; i++) {
+                makeFrame(&samples[i * BLK], p->first + i);
+            }
+            jbPut(jb, SIM_SSRC, p->seq, p->ts, samples, p->nFrames,
+                p->arrival);
+        }
+
+        concealments = jb->stats.lost + jb->stats.underruns +
+            jb->stats.stretched;
+        if (jbGet(jb, out)) {
+            int k = out[0] - 1;
+
+            /* a restart may go back to older frames; nothing else may */
+            if (k <= newest && sc->restartFrame < 0) {
+                o->disorder++;
+            }
+            newest = k;
+            memcpy(last, out, sizeof(last));
+            o->played++;
+            fades = 0;
+        }
+        else if (jb->stats.lost + jb->stats.underruns + jb->stats.stretched !=
+                concealments) {
+            o->badFade += !checkFade(out, last, fades++);
+            o->concealed++;
+        }
+        else {
+            /* the depth in front of a (re)started stream is silence */
+            for (i = 0; i < BLK; i++) {
+                o->badFade += out[i] != 0;
+            }
+        }
+
+        if (now == SIM_FRAMES / 2 * BLK) {
+            o->midTarget = jb->targetDepth;
+        }
+    }
+    o->endTarget = jb->targetDepth;
+}
+
+static unsigned verdict(const char *name, bool ok, const JitterBuffer *jb,
+    const Outcome *o)
+{
+    printf("%s %-8s played %4u concealed %3u lost %3u underruns %3u "
+        "late %3u reordered %3u resyncs %u depth %u->%u\n",
+        ok ? "pass" : "FAIL", name, o->played, o->concealed, jb->stats.lost,
+        jb->stats.underruns, jb->stats.late, jb->stats.reordered,
+        jb->stats.resyncs, o->midTarget, o->endTarget);
+
+    return (ok ? 0 : 1);
+}
+
+/*
+ *  ======== idleTest ========
+ *  A slot that only gets late frames must still go idle and free up.
+ */
+static unsigned idleTest(void)
+{
+    static Mixer   mix;
+    static int16_t frame[BLK];
+    int16_t        out[BLK];
+    unsigned       k;
+    bool           taken = false, ok;
+
+    mixInit(&mix, 1);
+    for (k = 0; k < 50; k++) {
+        makeFrame(frame, k);
+        mixPut(&mix, SIM_SSRC, (uint16_t)k, k * BLK, frame, 1, k * BLK);
+        mixGet(&mix, out);
+    }
+
+    /* the sender's frames now arrive with old timestamps only */
+    for (k = 0; k <= 2 * MIX_IDLE_FRAMES && mix.stats.expired == 0; k++) {
+        taken |= mixPut(&mix, SIM_SSRC, 49, 10 * BLK, frame, 1, 0);
+        mixGet(&mix, out);
+    }
+    ok = !taken && mix.stats.expired == 1 && mixStreams(&mix) == 0 &&
+        k <= MIX_IDLE_FRAMES + 1;
+
+    printf("%s idle     late-only stream expired after %u frames\n",
+        ok ? "pass" : "FAIL", k);
+
+    return (ok ? 0 : 1);
+}
+
+int main(void)
+{
+    static JitterBuffer jb;
+    static const Scenario clean   = { 2, 0, 0, 0, -1, -1 };
+    static const Scenario loss    = { 1, 5, 0, 0, -1, -1 };
+    static const Scenario reorder = { 1, 0, 5, 0, -1, -1 };
+    static const Scenario jitter  = { 2, 0, 0, 40, -1, -1 };
+    static const Scenario late    = { 2, 0, 0, 0, 1000, -1 };
+    static const Scenario restart = { 2, 0, 0, 0, -1, 2000 };
+    Outcome             o;
+    unsigned            failed = 0;
+    bool                ok;
+
+    /* every frame sent is played, dropped to shrink, or concealed */
+    run(&clean, &jb, &o);
+    ok = o.played + jb.stats.dropped == SIM_FRAMES && jb.stats.lost == 0 &&
+        jb.stats.underruns == 0 && jb.stats.late == 0 &&
+        jb.stats.reordered == 0 && o.disorder == 0 && o.badFade == 0;
+    failed += verdict("clean", ok, &jb, &o);
+
+    run(&loss, &jb, &o);
+    ok = o.played + jb.stats.dropped + jb.stats.lost == SIM_FRAMES &&
+        jb.stats.lost == o.missing && jb.stats.late == 0 &&
+        o.concealed > 0 && o.badFade == 0 && o.disorder == 0;
+    failed += verdict("loss", ok, &jb, &o);
+
+    run(&reorder, &jb, &o);
+    ok = o.played + jb.stats.dropped == SIM_FRAMES && o.overtaken > 0 &&
+        jb.stats.reordered == o.overtaken && jb.stats.late == 0 &&
+        jb.stats.lost == 0 && o.disorder == 0 && o.badFade == 0;
+    failed += verdict("reorder", ok, &jb, &o);
+
+    run(&jitter, &jb, &o);
+    ok = o.played + jb.stats.dropped + jb.stats.lost == SIM_FRAMES &&
+        o.midTarget >= 4 && o.endTarget <= 2 && jb.stats.dropped > 0 &&
+        jb.stats.late < SIM_FRAMES / 100 && o.disorder == 0 &&
+        o.badFade == 0;
+    failed += verdict("jitter", ok, &jb, &o);
+
+    /* missing when due, so concealed and skipped, then late */
+    run(&late, &jb, &o);
+    ok = o.played + jb.stats.dropped + jb.stats.lost == SIM_FRAMES &&
+        jb.stats.late == late.fpp && jb.stats.lost == late.fpp &&
+        o.disorder == 0 && o.badFade == 0;
+    failed += verdict("late", ok, &jb, &o);
+
+    /* what was buffered at the restart is thrown away, nothing else */
+    run(&restart, &jb, &o);
+    ok = jb.stats.resyncs == 1 && jb.stats.late == 0 &&
+        jb.stats.lost == 0 && o.badFade == 0 &&
+        o.played + jb.stats.dropped >= SIM_FRAMES - restart.fpp - 2;
+    failed += verdict("restart", ok, &jb, &o);
+
+    failed += idleTest();
+
+    printf("%s\n", failed ? "FAILED" : "all passed");
+
+    return (failed ? 1 : 0);
+}
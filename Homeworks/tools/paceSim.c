@@ -0,0 +1,234 @@
+/*
+ *    ======== paceSim.c ========
+ *    Linux checks for the token bucket (tokenBucket.c) behind udpPace.
+ *
+ *      rate      greedy senders of several sizes on a simulated clock:
+ *                bytes sent must match burst + rate * time to within the
+ *                one send still waiting
+ *      conform   random sizes at random times, dropping without tokens:
+ *                no window may carry more than burst + rate * length
+ *      reserve   a best-effort flood beside an 8 ms paced stream: the
+ *                stream must never wait and the flood gets the rest
+ *      wall      a greedy sender on the real clock, sleeping out each
+ *                wait with usleep() as the board does
+ *
+ *    Build and run on a Linux host:
+ *        make pacesim && ./pacesim
+ *
+ *    The exit status is 0 if every check passed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "tokenBucket.h"
+
+#define SIM_SECONDS     10
+#define WALL_RATE       1250000     /* 10 Mbit/s, the firmware default */
+#define WALL_BURST      16384
+#define WALL_LEN        1500
+#define WALL_US         2000000
+#define WALL_TOLERANCE  0.01
+
+static uint64_t rng = 0x9E3779B97F4A7C15ull;
+
+/* xorshift64*, so every run is the same */
+static uint32_t random32(void)
+{
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+
+    return ((uint32_t)((rng * 0x2545F4914F6CDD1Dull) >> 32));
+}
+
+/*
+ *  ======== checkRate ========
+ */
+static int checkRate(uint32_t rate, uint32_t burst, unsigned len)
+{
+    TokenBucket b;
+    uint64_t    now = 0, end = SIM_SECONDS * 1000000ull;
+    uint64_t    bytes = 0;
+    double      expect, err;
+
+    tbInit(&b, rate, burst, 0);
+    while (now < end) {
+        uint32_t wait = tbTake(&b, len, 0, now);
+
+        if (wait == 0) {
+            bytes += len;
+        }
+        now += wait;
+    }
+    expect = burst + (double)rate * now / 1e6;
+    err = bytes - expect;
+    printf("rate    %8u B/s burst %5u len %5u: %llu bytes, %+.0f from "
+        "expected (%.4f%%)\n", rate, burst, len, (unsigned long long)bytes,
+        err, 100.0 * err / expect);
+
+    /*
+     *  Short by the send (or the bucket) whose tokens are in hand when
+     *  the run ends, plus the microsecond its wait rounded up; over only
+     *  by the debt of a send bigger than the bucket.
+     */
+    return (err >= -((len < burst ? len : burst) + rate / 1e6) &&
+        err <= (double)(len > burst ? len - burst : 0) ? 0 : 1);
+}
+
+/*
+ *  ======== checkConform ========
+ *  A(t) - A(s) <= burst + rate * (t - s) for all s < t, i.e. A(t) -
+ *  rate * t never rises more than burst above its lowest earlier point.
+ *  A send larger than the bucket overdraws it by up to its excess.
+ */
+static int checkConform(uint32_t rate, uint32_t burst)
+{
+    TokenBucket b;
+    uint64_t    now = 0, bytes = 0;
+    double      low = 0.0, worst = 0.0;
+    unsigned    sent = 0, dropped = 0, maxLen = 0;
+    unsigned    i;
+
+    tbInit(&b, rate, burst, 0);
+    for (i = 0; i < 200000; i++) {
+        unsigned len = 16 + random32() % 1500;
+        double   before;
+
+        now += random32() % 2000;
+        before = bytes - (double)rate * now / 1e6;
+        if (before < low) {
+            low = before;
+        }
+        if (tbTake(&b, len, 0, now) != 0) {
+            dropped++;
+            continue;
+        }
+        bytes += len;
+        sent++;
+        if (len > maxLen) {
+            maxLen = len;
+        }
+        if (bytes - (double)rate * now / 1e6 - low > worst) {
+            worst = bytes - (double)rate * now / 1e6 - low;
+        }
+    }
+    printf("conform %8u B/s burst %5u: %u sent, %u dropped, worst window "
+        "%.0f bytes over rate\n", rate, burst, sent, dropped, worst);
+
+    return (worst <= burst + (maxLen > burst ? maxLen - burst : 0) ? 0 : 1);
+}
+
+/*
+ *  ======== checkReserve ========
+ */
+static int checkReserve(uint32_t rate, uint32_t burst, unsigned reserve)
+{
+    TokenBucket b;
+    uint64_t    now, end = SIM_SECONDS * 1000000ull;
+    uint64_t    nextStream = 0, streamBytes = 0, floodBytes = 0;
+    uint32_t    maxWait = 0;
+    unsigned    streamLen = 1036 + 28, floodLen = 1472 + 28;
+    double      floodShare;
+
+    tbInit(&b, rate, burst, 0);
+    for (now = 0; now < end; now += 100) {
+        if (now >= nextStream) {
+            uint32_t wait = tbTake(&b, streamLen, 0, now);
+
+            if (wait == 0) {
+                streamBytes += streamLen;
+                nextStream += 8000;
+            }
+            else if (wait > maxWait) {
+                maxWait = wait;
+            }
+        }
+        if (tbTake(&b, floodLen, reserve, now) == 0) {
+            floodBytes += floodLen;
+        }
+    }
+    floodShare = floodBytes / ((double)rate * SIM_SECONDS - streamBytes +
+        burst);
+    printf("reserve %8u B/s reserve %4u: stream max wait %u us, flood got "
+        "%.1f%% of what was left\n", rate, reserve, maxWait,
+        100.0 * floodShare);
+
+    return (maxWait == 0 && floodShare > 0.95 ? 0 : 1);
+}
+
+/*
+ *  ======== nowUs ========
+ */
+static uint64_t nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+/*
+ *  ======== checkWall ========
+ *  Oversleeping costs nothing: the tokens accrue meanwhile, so the rate
+ *  holds as long as the bucket covers the scheduler's lateness.
+ */
+static int checkWall(void)
+{
+    TokenBucket b;
+    uint64_t    start = nowUs(), now = start;
+    uint64_t    bytes = 0;
+    unsigned    waits = 0;
+    double      expect, err;
+
+    tbInit(&b, WALL_RATE, WALL_BURST, start);
+    while (now - start < WALL_US) {
+        uint32_t wait = tbTake(&b, WALL_LEN, 0, now);
+
+        if (wait == 0) {
+            bytes += WALL_LEN;
+        }
+        else {
+            usleep(wait);
+            waits++;
+        }
+        now = nowUs();
+    }
+    expect = WALL_BURST + (double)WALL_RATE * (now - start) / 1e6;
+    err = (bytes - expect) / expect;
+    printf("wall    %8u B/s burst %5u len %5u: %.3f s, %u sleeps, "
+        "%.3f%% from expected\n", WALL_RATE, WALL_BURST, WALL_LEN,
+        (now - start) / 1e6, waits, 100.0 * err);
+
+    return (err > -WALL_TOLERANCE && err < WALL_TOLERANCE ? 0 : 1);
+}
+
+/*
+ *  ======== main ========
+ */
+int main(void)
+{
+    static const uint32_t rates[] = { 8000, 16000, 125000, 1250000 };
+    static const unsigned lens[] = { 60, 1064, 1500, 20000 };
+    unsigned r, l;
+    int      failed = 0;
+
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+            failed += checkRate(rates[r], 16384, lens[l]);
+        }
+    }
+    failed += checkConform(125000, 4096);
+    failed += checkConform(1250000, 16384);
+    failed += checkReserve(1250000, 16384, 4096);
+    failed += checkReserve(250000, 8192, 4096);
+    failed += checkWall();
+
+    printf("%s\n", failed ? "FAILED" : "passed");
+
+    return (failed ? 1 : 0);
+}
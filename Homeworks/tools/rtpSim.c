@@ -0,0 +1,372 @@
+/*
+ *    ======== rtpSim.c ========
+ *    Linux test for the RTP packetiser audioTxFxn uses (rtpPacker.c). A
+ *    sender thread feeds it from a simulated capture clock, one 64-sample
+ *    block every 8 ms with an overrun now and then, and its packets go to
+ *    a receiver on the loopback interface that checks:
+ *
+ *      - the header: version, payload type, SSRC, a sequence number that
+ *        steps by one across the 16-bit wrap, a timestamp that continues
+ *        from the last packet unless the marker says a block was lost;
+ *      - the payload: its length for the frames carried, and the decoded
+ *        samples against the source (bit-exact for L16, SNR for the
+ *        companded and ADPCM formats, each DVI4 packet decoded alone);
+ *      - the pacing: every packet is sent on the capture block that
+ *        completes it, by the simulated clock, not before and not after.
+ *        How late it arrives by the host's wall clock depends on the
+ *        host's scheduling, so that is only reported.
+ *
+ *    Build and run on a Linux host:
+ *        make rtpsim
+ *        ./rtpsim [seconds-per-case]
+ *
+ *    Every payload type runs at 1, 2 and AUDIOTX_MAX_FPP frames per
+ *    packet, and then a stream that switches to DVI4 halfway, as -tx or
+ *    the feedback ladder would, where the first DVI4 packet alone must
+ *    meet the DVI4 SNR. The exit status is non-zero if any check failed.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "adpcm.h"
+#include "rtp.h"
+#include "rtpPacker.h"
+
+#define SIM_RATE        8000
+#define SIM_BLOCK       64              /* AUDIO_BLOCKSIZE */
+#define SIM_BLOCK_NS    (1000000000ull * SIM_BLOCK / SIM_RATE)
+#define SIM_MAX_FPP     8               /* AUDIOTX_MAX_FPP */
+#define SIM_SSRC        0xC0A80164
+#define SIM_OVERRUN     37              /* every 37th block is lost */
+
+typedef struct {
+    int       sock;
+    uint8_t   pt;
+    uint8_t   switchPt;                 /* from switchTs on */
+    uint32_t  switchTs;
+    unsigned  fpp;
+    unsigned  blocks;
+    uint64_t  startNs;                  /* capture clock epoch */
+    uint32_t  clock;                    /* simulated: samples captured */
+    uint32_t  sentAt[65536];            /* clock each seq was sent at */
+    RtpPacker packer;
+} Sender;
+
+typedef struct {
+    unsigned packets;
+    unsigned header;                    /* packets failing header checks */
+    unsigned payload;
+    unsigned early;                     /* by the simulated clock */
+    unsigned late;
+    double   worstMs;                   /* wall clock, reported only */
+    double   signal;
+    double   noise;
+    double   firstSignal;               /* the first packet switched to */
+    double   firstNoise;
+    bool     exact;
+} Result;
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+/* the microphone: two tones, so every sample differs from the last */
+static int16_t source(uint32_t i)
+{
+    return ((int16_t)lrint(9000 * sin(2 * M_PI * 440 * i / SIM_RATE) +
+        3000 * sin(2 * M_PI * 1330 * i / SIM_RATE)));
+}
+
+/* true if any block in n samples from ts was one the capture lost */
+static bool lost(uint32_t ts, unsigned n)
+{
+    uint32_t b;
+
+    for (b = ts / SIM_BLOCK; b < (ts + n) / SIM_BLOCK; b++) {
+        if (b % SIM_OVERRUN == SIM_OVERRUN - 1) {
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+/*
+ *  ======== sendFxn ========
+ *  The packer's send callback: notes the capture clock it went out at.
+ */
+static void sendFxn(void *arg, uint8_t *packet, unsigned len)
+{
+    Sender *s = arg;
+
+    s->sentAt[s->packer.hdr.seq] = s->clock;
+    send(s->sock, packet, len, 0);
+}
+
+/*
+ *  ======== boundaryFxn ========
+ *  The packer's boundary callback: switches format on the first packet
+ *  at or past switchTs.
+ */
+static void boundaryFxn(void *arg)
+{
+    Sender *s = arg;
+
+    if (s->clock - SIM_BLOCK >= s->switchTs) {
+        rtpPackerSetFormat(&s->packer, s->switchPt, s->fpp);
+    }
+}
+
+/*
+ *  ======== senderFxn ========
+ *  Stands in for audioTxFxn, sleeping until each block is complete where
+ *  it waits in audioCaptureRead(). A lost block leaves a gap in the
+ *  timestamps.
+ */
+static void *senderFxn(void *arg)
+{
+    Sender         *s = arg;
+    static uint8_t  packet[RTP_HDR_LEN + SIM_MAX_FPP * SIM_BLOCK * 2];
+    int16_t         block[SIM_BLOCK];
+    struct timespec due;
+    uint64_t        t;
+    uint32_t        ts;
+    unsigned        b, i;
+
+    /* the sequence number crosses the wrap early on */
+    rtpPackerInit(&s->packer, packet, SIM_BLOCK, SIM_SSRC, 65536 - 5, s->pt,
+        s->fpp, sendFxn, boundaryFxn, s);
+
+    for (b = 0; b < s->blocks; b++) {
+        t = s->startNs + (b + 1) * SIM_BLOCK_NS;
+        due.tv_sec = t / 1000000000u;
+        due.tv_nsec = t % 1000000000u;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+        ts = b * SIM_BLOCK;
+        s->clock = ts + SIM_BLOCK;
+        if (lost(ts, SIM_BLOCK)) {
+            continue;
+        }
+        for (i = 0; i < SIM_BLOCK; i++) {
+            block[i] = source(ts + i);
+        }
+        rtpPackerBlock(&s->packer, block, ts);
+    }
+
+    return (NULL);
+}
+
+/*
+ *  ======== check ========
+ *  One received datagram against what the sender must have put in it.
+ */
+static void check(Result *r, const Sender *s, const uint8_t *p, unsigned len,
+    uint64_t arrivalNs)
+{
+    static RtpHeader last;
+    static uint32_t  lastEnd;
+    int16_t          pcm[SIM_MAX_FPP * SIM_BLOCK];
+    RtpHeader        h;
+    unsigned         off, plen, n, i;
+    uint32_t         due;
+    double           ms;
+    bool             ok;
+
+    if (!rtpReadHeader(p, len, &h, &off, &plen)) {
+        r->header++;
+        return;
+    }
+
+    ok = h.pt == (h.ts >= s->switchTs ? s->switchPt : s->pt) &&
+        h.ssrc == SIM_SSRC && off == RTP_HDR_LEN &&
+        h.ts % SIM_BLOCK == 0;
+    if (r->packets == 0) {
+        ok = ok && h.marker && h.seq == (uint16_t)(65536 - 5) && h.ts == 0;
+    }
+    else {
+        /* a marker exactly where a lost block left a gap */
+        ok = ok && h.seq == (uint16_t)(last.seq + 1) &&
+            h.marker == (h.ts != lastEnd) && h.ts >= lastEnd;
+    }
+
+    n = rtpUnpackPayload(h.pt, pcm, &p[off], plen);
+    if (n == 0 || n % SIM_BLOCK != 0 || n > s->fpp * SIM_BLOCK ||
+            plen != rtpPayloadBytes(h.pt, n) || lost(h.ts, n)) {
+        r->payload++;
+    }
+    else {
+        /* only the packet before a lost block may be short */
+        if (n < s->fpp * SIM_BLOCK && !lost(h.ts + n, SIM_BLOCK)) {
+            r->payload++;
+        }
+        bool first = s->switchPt != s->pt && h.ts >= s->switchTs &&
+            r->firstSignal == 0;
+
+        for (i = 0; i < n; i++) {
+            double x = source(h.ts + i);
+
+            r->signal += x * x;
+            r->noise += (pcm[i] - x) * (pcm[i] - x);
+            r->exact = r->exact && pcm[i] == source(h.ts + i);
+            if (first) {
+                r->firstSignal += x * x;
+                r->firstNoise += (pcm[i] - x) * (pcm[i] - x);
+            }
+        }
+    }
+    if (!ok) {
+        r->header++;
+    }
+
+    /*
+     *  Due when its last block was complete, the capture clock starting
+     *  at 0; one cut short by a lost block goes with the block after it.
+     */
+    due = h.ts + n + (n < s->fpp * SIM_BLOCK ? 2 * SIM_BLOCK : 0);
+    if ((int32_t)(s->sentAt[h.seq] - due) < 0) {
+        r->early++;
+    }
+    if ((int32_t)(s->sentAt[h.seq] - due) > 0) {
+        r->late++;
+    }
+    ms = ((double)arrivalNs - s->startNs) / 1e6 - (double)due * 1000 / SIM_RATE;
+    r->worstMs = ms > r->worstMs ? ms : r->worstMs;
+
+    last = h;
+    lastEnd = h.ts + n;
+    r->packets++;
+}
+
+/*
+ *  ======== runCase ========
+ */
+static bool runCase(const char *name, uint8_t pt, uint8_t switchPt,
+    unsigned fpp, unsigned seconds)
+{
+    static const double minSnr[] = { 30.0, 20.0 }; /* G.711, DVI4 */
+    static uint8_t      buf[2048];
+    struct sockaddr_in  addr;
+    socklen_t           addrLen = sizeof(addr);
+    struct timeval      tv = { 0, 200000 };
+    pthread_t           thread;
+    static Sender       s;
+    Result              r;
+    double              snr, firstSnr = 99.0;
+    int                 rx, n;
+    bool                ok;
+
+    memset(&r, 0, sizeof(r));
+    r.exact = true;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    rx = socket(AF_INET, SOCK_DGRAM, 0);
+    bind(rx, (struct sockaddr *)&addr, sizeof(addr));
+    getsockname(rx, (struct sockaddr *)&addr, &addrLen);
+    setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    s.sock = socket(AF_INET, SOCK_DGRAM, 0);
+    connect(s.sock, (struct sockaddr *)&addr, sizeof(addr));
+    s.pt = pt;
+    s.switchPt = switchPt;
+    s.fpp = fpp;
+    s.blocks = seconds * SIM_RATE / SIM_BLOCK;
+    s.switchTs = switchPt != pt ? s.blocks / 2 * SIM_BLOCK : UINT32_MAX;
+    s.startNs = nowNs();
+    pthread_create(&thread, NULL, senderFxn, &s);
+
+    while ((n = recv(rx, buf, sizeof(buf), 0)) > 0) {
+        check(&r, &s, buf, n, nowNs());
+    }
+
+    pthread_join(thread, NULL);
+    close(s.sock);
+    close(rx);
+
+    snr = r.noise > 0 ? 10 * log10(r.signal / r.noise) : 99.0;
+    ok = r.packets > 0 && r.header == 0 && r.payload == 0 && r.early == 0 &&
+        r.late == 0;
+    if (switchPt != pt) {
+        firstSnr = r.firstNoise > 0 ?
+            10 * log10(r.firstSignal / r.firstNoise) : 99.0;
+        ok = ok && r.firstSignal > 0 && snr >= minSnr[1] &&
+            firstSnr >= minSnr[switchPt == RTP_PT_DVI4];
+    }
+    else if (pt == RTP_PT_L16) {
+        ok = ok && r.exact;
+    }
+    else {
+        ok = ok && snr >= minSnr[pt == RTP_PT_DVI4];
+    }
+
+    printf("%s %-9s %u fpp: %4u packets, header %u, payload %u, "
+        "SNR %5.1f dB, early %u, late %u (arrival worst %.2f ms)\n",
+        ok ? "pass" : "FAIL", name, fpp, r.packets, r.header, r.payload,
+        snr, r.early, r.late, r.worstMs);
+    if (switchPt != pt) {
+        printf("     first packet after the switch: SNR %5.1f dB\n",
+            firstSnr);
+    }
+
+    return (ok);
+}
+
+int main(int argc, char *argv[])
+{
+    static const struct {
+        const char *name;
+        uint8_t     pt;
+    } types[] = {
+        { "l16", RTP_PT_L16 }, { "pcmu", RTP_PT_PCMU },
+        { "pcma", RTP_PT_PCMA }, { "dvi4", RTP_PT_DVI4 }
+    };
+    static const struct {
+        const char *name;
+        uint8_t     from, to;
+    } switches[] = {
+        { "l16>dvi4", RTP_PT_L16, RTP_PT_DVI4 },
+        { "pcmu>dvi4", RTP_PT_PCMU, RTP_PT_DVI4 }
+    };
+    static const unsigned fpps[] = { 1, 2, SIM_MAX_FPP };
+    unsigned seconds = argc > 1 ? atoi(argv[1]) : 2;
+    unsigned i, j, failed = 0;
+
+    if (seconds < 1) {
+        fprintf(stderr, "usage: rtpsim [seconds-per-case]\n");
+        return (2);
+    }
+
+    for (i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        for (j = 0; j < sizeof(fpps) / sizeof(fpps[0]); j++) {
+            failed += !runCase(types[i].name, types[i].pt, types[i].pt,
+                fpps[j], seconds);
+        }
+    }
+    for (i = 0; i < sizeof(switches) / sizeof(switches[0]); i++) {
+        for (j = 0; j < 2; j++) {
+            failed += !runCase(switches[i].name, switches[i].from,
+                switches[i].to, fpps[j], seconds);
+        }
+    }
+    printf("%s\n", failed ? "FAILED" : "all passed");
+
+    return (failed ? 1 : 0);
+}
@@ -0,0 +1,485 @@
+/*
+ *    ======== udpload.c ========
+ *    Host-side load generator and RTT benchmark for the UDP echo service.
+ *
+ *    Sends sequence-numbered, timestamped datagrams at a fixed rate to an
+ *    echo server (a board's echoFxn, or udpechod from echoIoLinux.c) and
+ *    reports throughput, loss, reordering, duplicates and an HDR-style RTT
+ *    histogram. Sends are scheduled on an absolute timeline and RTT is
+ *    measured from the scheduled send time, so a stalled sender shows up
+ *    as latency instead of hiding it (no coordinated omission).
+ *
+ *    With -t the datagrams are timestamp requests for the echo's reflect
+ *    mode (echoCore.h): the board writes its receive and transmit times
+ *    into them, so each RTT splits into time on the board (tx - rx) and
+ *    time on the network (the rest), each with its own histogram.
+ *
+ *    Build and run on a Linux host:
+ *        make udpload
+ *        ./udpload 192.168.1.100 1000 -r 2000 -s 256 -d 10
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <math.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#define UDPPACKETSIZE   1472        /* largest payload the board echoes */
+#define HDR_MAGIC       0x554C4731u /* "ULG1" */
+#define HDR_LEN         16          /* magic, seq, send time (ns) */
+#define TS_MAGIC        0x45545331u /* "ETS1": ask for reflector stamps */
+#define TS_LEN          32          /* + reflector rx, tx (us) */
+#define TS_RX_OFF       16
+#define TS_TX_OFF       24
+#define DRAIN_NS        1000000000ull
+
+/*
+ *  Log-linear histogram in nanoseconds: exact below 2048, then 1024 linear
+ *  sub-buckets per power of two (better than 0.1% resolution), the same
+ *  layout HdrHistogram uses with 3 significant digits.
+ */
+#define SUB_BITS        10
+#define SUB_COUNT       (1u << SUB_BITS)
+#define HIST_LEN        (2 * SUB_COUNT + 54 * SUB_COUNT)
+
+typedef struct {
+    uint64_t count[HIST_LEN];
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    double   sum;
+    double   sumSq;
+} Histogram;
+
+static struct {
+    const char *host;
+    const char *port;
+    unsigned    rate;               /* packets per second */
+    unsigned    size;               /* payload bytes */
+    unsigned    seconds;
+    bool        fullHistogram;
+    bool        stamps;             /* -t: reflect-mode requests */
+} opt = { NULL, "1000", 1000, 64, 5, false, false };
+
+static int       sock;
+static uint64_t  startNs;
+static uint64_t  numPackets;
+static uint8_t  *seen;              /* per-sequence receive count */
+static volatile bool sendDone = false;
+
+static Histogram rtt, board, network;
+static uint64_t  received, duplicates, reordered, late, bytesRcvd;
+static uint64_t  unstamped;         /* -t replies the server left alone */
+static uint64_t  sent, sendErrors;
+
+/*
+ *  ======== nowNs ========
+ */
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    v = htonl(v);
+    memcpy(p, &v, 4);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, 4);
+
+    return (ntohl(v));
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+    return (((uint64_t)get32(p) << 32) | get32(p + 4));
+}
+
+/*
+ *  ======== histIndex ========
+ */
+static unsigned histIndex(uint64_t v)
+{
+    unsigned e;
+
+    if (v < 2 * SUB_COUNT) {
+        return ((unsigned)v);
+    }
+    e = 63 - __builtin_clzll(v) - SUB_BITS;     /* v >> e in [1024, 2048) */
+
+    return (2 * SUB_COUNT + (e - 1) * SUB_COUNT +
+            (unsigned)((v >> e) - SUB_COUNT));
+}
+
+/*
+ *  ======== histValue ========
+ *  Highest value that lands in bucket i.
+ */
+static uint64_t histValue(unsigned i)
+{
+    unsigned e;
+
+    if (i < 2 * SUB_COUNT) {
+        return (i);
+    }
+    e = (i - 2 * SUB_COUNT) / SUB_COUNT + 1;
+
+    return ((((uint64_t)((i - 2 * SUB_COUNT) % SUB_COUNT + SUB_COUNT) + 1)
+            << e) - 1);
+}
+
+static void histRecord(Histogram *h, uint64_t v)
+{
+    unsigned i = histIndex(v);
+
+    if (i >= HIST_LEN) {
+        i = HIST_LEN - 1;
+    }
+    h->count[i]++;
+    if (h->total++ == 0 || v < h->min) {
+        h->min = v;
+    }
+    if (v > h->max) {
+        h->max = v;
+    }
+    h->sum   += (double)v;
+    h->sumSq += (double)v * v;
+}
+
+/*
+ *  ======== histPercentile ========
+ */
+static uint64_t histPercentile(const Histogram *h, double p)
+{
+    uint64_t want = (uint64_t)(p / 100.0 * h->total + 0.5);
+    uint64_t acc = 0;
+    unsigned i;
+
+    if (want < 1) {
+        want = 1;
+    }
+    for (i = 0; i < HIST_LEN; i++) {
+        acc += h->count[i];
+        if (acc >= want) {
+            uint64_t v = histValue(i);
+
+            return (v < h->max ? v : h->max);
+        }
+    }
+
+    return (h->max);
+}
+
+/*
+ *  ======== histPrint ========
+ *  Percentile distribution in HdrHistogram's text format (microseconds).
+ */
+static void histPrint(const Histogram *h)
+{
+    uint64_t acc = 0;
+    unsigned i;
+
+    printf("%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount",
+        "1/(1-Percentile)");
+    for (i = 0; i < HIST_LEN; i++) {
+        uint64_t v = histValue(i);
+        double   q;
+
+        if (h->count[i] == 0) {
+            continue;
+        }
+        acc += h->count[i];
+        q = (double)acc / h->total;
+        if (v > h->max) {
+            v = h->max;
+        }
+        if (q < 1.0) {
+            printf("%12.3f %14.12f %10" PRIu64 " %14.2f\n",
+                v / 1000.0, q, acc, 1.0 / (1.0 - q));
+        }
+        else {
+            printf("%12.3f %14.12f %10" PRIu64 "\n", v / 1000.0, q, acc);
+        }
+    }
+    {
+        double mean = h->sum / h->total;
+        double var = h->sumSq / h->total - mean * mean;
+
+        printf("#[Mean    = %12.3f, StdDeviation   = %12.3f]\n", mean / 1000.0,
+            (var > 0 ? sqrt(var) : 0.0) / 1000.0);
+    }
+    printf("#[Max     = %12.3f, Total count    = %12" PRIu64 "]\n",
+        h->max / 1000.0, h->total);
+}
+
+/*
+ *  ======== sender ========
+ */
+static void *sender(void *arg)
+{
+    static uint8_t  pkt[UDPPACKETSIZE];
+    const uint64_t  period = 1000000000ull / opt.rate;
+    uint64_t        seq;
+    struct timespec at;
+
+    (void)arg;
+    memset(pkt, 0xA5, sizeof(pkt));
+    if (opt.stamps) {
+        put32(pkt, TS_MAGIC);
+        memset(&pkt[TS_RX_OFF], 0, TS_LEN - TS_RX_OFF);
+    }
+    else {
+        put32(pkt, HDR_MAGIC);
+    }
+
+    for (seq = 0; seq < numPackets; seq++) {
+        uint64_t due = startNs + seq * period;
+
+        at.tv_sec  = due / 1000000000ull;
+        at.tv_nsec = due % 1000000000ull;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL)
+                == EINTR) {
+        }
+
+        /* intended send time, not actual: see the file header */
+        put32(&pkt[4], (uint32_t)seq);
+        put32(&pkt[8], (uint32_t)(due >> 32));
+        put32(&pkt[12], (uint32_t)due);
+
+        if (send(sock, pkt, opt.size, 0) == (ssize_t)opt.size) {
+            sent++;
+        }
+        else {
+            sendErrors++;
+        }
+    }
+    sendDone = true;
+
+    return (NULL);
+}
+
+/*
+ *  ======== receiver ========
+ */
+static void receiver(void)
+{
+    static uint8_t buf[UDPPACKETSIZE + 1];
+    uint64_t       highest = 0;
+    uint64_t       doneAt = 0;
+    bool           any = false;
+
+    for (;;) {
+        ssize_t  n = recv(sock, buf, sizeof(buf), 0);
+        uint64_t now = nowNs();
+        uint64_t seq, sentAt;
+
+        if (sendDone) {
+            if (doneAt == 0) {
+                doneAt = now;
+            }
+            else if (now - doneAt > DRAIN_NS) {
+                break;
+            }
+        }
+        if (n < 0) {
+            continue;               /* receive timeout: re-check the drain */
+        }
+        if (n < HDR_LEN ||
+                get32(buf) != (opt.stamps ? TS_MAGIC : HDR_MAGIC)) {
+            continue;
+        }
+
+        seq    = get32(&buf[4]);
+        sentAt = get64(&buf[8]);
+        if (seq >= numPackets) {
+            continue;
+        }
+        if (seen[seq]++) {
+            duplicates++;
+            continue;
+        }
+
+        received++;
+        bytesRcvd += n;
+        if (any && seq < highest) {
+            reordered++;
+        }
+        if (!any || seq > highest) {
+            highest = seq;
+            any = true;
+        }
+        if (doneAt != 0) {
+            late++;                 /* arrived after the last send */
+        }
+        histRecord(&rtt, now - sentAt);
+
+        if (opt.stamps) {
+            uint64_t rxUs = get64(&buf[TS_RX_OFF]);
+            uint64_t txUs = get64(&buf[TS_TX_OFF]);
+            uint64_t onBoard = (txUs - rxUs) * 1000;
+
+            if ((rxUs == 0 && txUs == 0) || txUs < rxUs ||
+                    onBoard > now - sentAt) {
+                unstamped++;
+                continue;
+            }
+            histRecord(&board, onBoard);
+            histRecord(&network, now - sentAt - onBoard);
+        }
+    }
+}
+
+/*
+ *  ======== printSummary ========
+ */
+static void printSummary(const char *name, const Histogram *h)
+{
+    printf("%-10s min %.1f  p50 %.1f  p90 %.1f  p99 %.1f  "
+        "p99.9 %.1f  p99.99 %.1f  max %.1f\n", name,
+        h->min / 1000.0, histPercentile(h, 50) / 1000.0,
+        histPercentile(h, 90) / 1000.0,
+        histPercentile(h, 99) / 1000.0,
+        histPercentile(h, 99.9) / 1000.0,
+        histPercentile(h, 99.99) / 1000.0, h->max / 1000.0);
+}
+
+/*
+ *  ======== usage ========
+ */
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+        "usage: %s HOST [PORT] [-r pps] [-s bytes] [-d seconds] [-t] [-H]\n"
+        "  -r  send rate, packets per second (default %u)\n"
+        "  -s  payload size, %d..%d bytes (default %u)\n"
+        "  -d  test duration in seconds (default %u)\n"
+        "  -t  request reflector timestamps (-echo reflect), at least %d"
+        " bytes;\n      splits RTT into board and network time\n"
+        "  -H  print the full percentile distribution\n",
+        prog, opt.rate, HDR_LEN, UDPPACKETSIZE, opt.size, opt.seconds,
+        TS_LEN);
+    exit(2);
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    struct addrinfo  hints, *res;
+    struct timeval   tv = { 0, 100000 };
+    pthread_t        tx;
+    double           secs;
+    int              c, status;
+
+    while ((c = getopt(argc, argv, "r:s:d:tH")) != -1) {
+        switch (c) {
+            case 'r': opt.rate = strtoul(optarg, NULL, 0); break;
+            case 's': opt.size = strtoul(optarg, NULL, 0); break;
+            case 'd': opt.seconds = strtoul(optarg, NULL, 0); break;
+            case 't': opt.stamps = true; break;
+            case 'H': opt.fullHistogram = true; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+    opt.host = argv[optind++];
+    if (optind < argc) {
+        opt.port = argv[optind++];
+    }
+    if (opt.rate < 1 || opt.rate > 1000000 || opt.seconds < 1 ||
+            opt.size < (opt.stamps ? TS_LEN : HDR_LEN) ||
+            opt.size > UDPPACKETSIZE) {
+        usage(argv[0]);
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    status = getaddrinfo(opt.host, opt.port, &hints, &res);
+    if (status != 0) {
+        fprintf(stderr, "%s: %s\n", opt.host, gai_strerror(status));
+        return (1);
+    }
+    sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (sock < 0 || connect(sock, res->ai_addr, res->ai_addrlen) < 0) {
+        perror("socket");
+        return (1);
+    }
+    freeaddrinfo(res);
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    numPackets = (uint64_t)opt.rate * opt.seconds;
+    seen = calloc(numPackets, 1);
+    if (seen == NULL) {
+        perror("calloc");
+        return (1);
+    }
+
+    printf("udpload: %s:%s, %u pkt/s, %u bytes, %u s%s\n", opt.host,
+        opt.port, opt.rate, opt.size, opt.seconds,
+        opt.stamps ? ", timestamped" : "");
+
+    startNs = nowNs() + 10000000ull;
+    pthread_create(&tx, NULL, sender, NULL);
+    receiver();
+    pthread_join(tx, NULL);
+
+    secs = (double)opt.seconds;
+    printf("sent       %" PRIu64 " (%" PRIu64 " send errors)\n", sent,
+        sendErrors);
+    printf("received   %" PRIu64 "  lost %" PRIu64 " (%.3f%%)  reordered %"
+        PRIu64 "  duplicates %" PRIu64 "  after-last-send %" PRIu64 "\n",
+        received, sent - received,
+        sent ? 100.0 * (sent - received) / sent : 0.0,
+        reordered, duplicates, late);
+    printf("throughput %.0f pkt/s  %.3f Mbit/s (payload, each way)\n",
+        received / secs, bytesRcvd * 8 / secs / 1e6);
+    if (rtt.total) {
+        printSummary("rtt us", &rtt);
+        if (opt.fullHistogram) {
+            histPrint(&rtt);
+        }
+    }
+    if (opt.stamps) {
+        printf("stamped    %" PRIu64 "  unstamped %" PRIu64 "\n",
+            board.total, unstamped);
+    }
+    if (board.total) {
+        printSummary("board us", &board);
+        printSummary("network us", &network);
+        if (opt.fullHistogram) {
+            printf("\nboard\n");
+            histPrint(&board);
+            printf("\nnetwork\n");
+            histPrint(&network);
+        }
+    }
+
+    /* exit status doubles as the acceptance check: every packet came back */
+    return (received == sent && sendErrors == 0 ? 0 : 1);
+}
@@ -0,0 +1,168 @@
+/*
+ *    ======== udpsink.c ========
+ *    Host-side receiver for the board's packet generator (-udpgen, see
+ *    udpecho_MSP_EXP432E401Y_tirtos_ccs/udpGen.h). Counts what arrived of
+ *    a run: datagrams and bytes, loss from the sequence numbers,
+ *    reordering and duplicates, the receive rate, and the interarrival
+ *    jitter against the board's transmit stamps (RFC 3550, section 6.4.1)
+ *    which shows how evenly the board really sent.
+ *
+ *    The run ends once nothing arrives for -i seconds after the first
+ *    datagram.
+ *
+ *    Build and run on a Linux host:
+ *        make udpsink
+ *        ./udpsink 5010
+ *    then on the board's control port or console:
+ *        -udpgen <this host> 5010 1472 5000 50000
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define GEN_MAGIC       0x55474E31u /* "UGN1" */
+#define GEN_HDR_LEN     16          /* magic, seq, board tx time (us) */
+#define MAX_DATAGRAM    65536
+#define MAX_SEQ         (1u << 26)  /* bitmap of 8 MB */
+#define DEF_IDLE_S      2
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+        (uint32_t)p[2] << 8 | p[3]);
+}
+
+static uint64_t nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "usage: %s port [-i idle-seconds]\n", prog);
+    exit(2);
+}
+
+/*
+ *  ======== main ========
+ */
+int main(int argc, char *argv[])
+{
+    static uint8_t     buf[MAX_DATAGRAM];
+    struct sockaddr_in addr;
+    struct timeval     tv = { 0, 100000 };
+    uint8_t           *seen;
+    uint64_t           received = 0, bytes = 0, reordered = 0;
+    uint64_t           duplicates = 0, other = 0;
+    uint64_t           firstUs = 0, lastUs = 0;
+    uint32_t           maxSeq = 0;
+    unsigned           idleS = DEF_IDLE_S;
+    double             jitter = 0.0, lastTransit = 0.0;
+    int                sock, c;
+
+    while ((c = getopt(argc, argv, "i:")) != -1) {
+        if (c != 'i') {
+            usage(argv[0]);
+        }
+        idleS = strtoul(optarg, NULL, 0);
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(strtoul(argv[optind], NULL, 0));
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0 || bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("socket");
+        return (1);
+    }
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    seen = calloc(MAX_SEQ / 8, 1);
+    if (seen == NULL) {
+        perror("calloc");
+        return (1);
+    }
+    printf("udpsink: port %s, waiting for -udpgen\n", argv[optind]);
+
+    for (;;) {
+        ssize_t  n = recv(sock, buf, sizeof(buf), 0);
+        uint64_t now = nowUs();
+        uint32_t seq;
+        double   transit;
+
+        if (n < 0) {
+            if (received && now - lastUs >= idleS * 1000000ull) {
+                break;
+            }
+            continue;
+        }
+        if (n < GEN_HDR_LEN || get32(buf) != GEN_MAGIC ||
+                (seq = get32(buf + 4)) >= MAX_SEQ) {
+            other++;
+            continue;
+        }
+        if (seen[seq / 8] & (1u << (seq % 8))) {
+            duplicates++;
+            continue;
+        }
+        seen[seq / 8] |= 1u << (seq % 8);
+
+        /* the board's clock is its own; only differences in transit count */
+        transit = (double)now - (double)((uint64_t)get32(buf + 8) << 32 |
+            get32(buf + 12));
+        if (received == 0) {
+            firstUs = now;
+        }
+        else {
+            jitter += (fabs(transit - lastTransit) - jitter) / 16;
+        }
+        lastTransit = transit;
+
+        if (received > 0 && seq < maxSeq) {
+            reordered++;
+        }
+        if (seq > maxSeq) {
+            maxSeq = seq;
+        }
+        received++;
+        bytes += n;
+        lastUs = now;
+    }
+
+    {
+        double   secs = (lastUs - firstUs) / 1e6;
+        uint64_t expected = (uint64_t)maxSeq + 1;
+
+        printf("received   %" PRIu64 " of %" PRIu64 " (lost %" PRIu64
+            ", %.3f%%)  reordered %" PRIu64 "  duplicates %" PRIu64
+            "  not udpgen %" PRIu64 "\n", received, expected,
+            expected - received, 100.0 * (expected - received) / expected,
+            reordered, duplicates, other);
+        printf("rate       %.0f pkt/s  %.3f Mbit/s (payload) over %.3f s\n",
+            secs > 0 ? (received - 1) / secs : 0.0,
+            secs > 0 ? bytes * 8 / secs / 1e6 : 0.0, secs);
+        printf("jitter     %.1f us (interarrival vs board send times)\n",
+            jitter);
+    }
+
+    return (0);
+}
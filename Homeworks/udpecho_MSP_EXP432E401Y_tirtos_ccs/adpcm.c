@@ -0,0 +1,139 @@
+/*
+ *    ======== adpcm.c ========
+ *    IMA ADPCM coder; see adpcm.h.
+ */
+
+#include <stdint.h>
+
+#include "adpcm.h"
+
+static const int16_t stepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37,
+    41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173,
+    190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894,
+    6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289,
+    16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t indexTable[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+/*
+ *  ======== update ========
+ *  Applies one code to the state; shared by both directions so the
+ *  encoder tracks exactly what the decoder will rebuild.
+ */
+static int16_t update(AdpcmState *st, unsigned code)
+{
+    int32_t step = stepTable[st->index];
+    int32_t diff = step >> 3;
+    int32_t pred = st->predicted;
+    int     index = st->index + indexTable[code & 7];
+
+    if (code & 4) {
+        diff += step;
+    }
+    if (code & 2) {
+        diff += step >> 1;
+    }
+    if (code & 1) {
+        diff += step >> 2;
+    }
+    pred += (code & 8) ? -diff : diff;
+    if (pred > INT16_MAX) {
+        pred = INT16_MAX;
+    }
+    else if (pred < INT16_MIN) {
+        pred = INT16_MIN;
+    }
+
+    st->predicted = (int16_t)pred;
+    st->index = (uint8_t)(index < 0 ? 0 : index > 88 ? 88 : index);
+
+    return (st->predicted);
+}
+
+/*
+ *  ======== encodeOne ========
+ */
+static unsigned encodeOne(AdpcmState *st, int16_t s)
+{
+    int32_t  diff = (int32_t)s - st->predicted;
+    int32_t  step = stepTable[st->index];
+    unsigned code = 0;
+
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+    }
+    update(st, code);
+
+    return (code);
+}
+
+/*
+ *  ======== adpcmInit ========
+ */
+void adpcmInit(AdpcmState *st)
+{
+    st->predicted = 0;
+    st->index = 0;
+}
+
+/*
+ *  ======== adpcmSeed ========
+ */
+void adpcmSeed(AdpcmState *st, int16_t predicted, unsigned meanDiff)
+{
+    unsigned i = 0;
+
+    while (i < 88 && (unsigned)stepTable[i] < meanDiff) {
+        i++;
+    }
+    st->predicted = predicted;
+    st->index = (uint8_t)i;
+}
+
+/*
+ *  ======== adpcmEncode ========
+ */
+unsigned adpcmEncode(AdpcmState *st, uint8_t *out, const int16_t *s,
+                     unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i + 1 < n; i += 2) {
+        unsigned hi = encodeOne(st, s[i]);
+
+        out[i / 2] = (uint8_t)((hi << 4) | encodeOne(st, s[i + 1]));
+    }
+
+    return (n / 2);
+}
+
+/*
+ *  ======== adpcmDecode ========
+ */
+void adpcmDecode(AdpcmState *st, int16_t *s, const uint8_t *in, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i + 1 < n; i += 2) {
+        s[i]     = update(st, in[i / 2] >> 4);
+        s[i + 1] = update(st, in[i / 2] & 0x0F);
+    }
+}
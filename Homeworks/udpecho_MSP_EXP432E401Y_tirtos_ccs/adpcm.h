@@ -0,0 +1,37 @@
+/*
+ *    ======== adpcm.h ========
+ *    IMA/DVI ADPCM, 4 bits per sample: a quarter of L16's bandwidth, half
+ *    of G.711's. The coder state is a predicted sample and a step-size
+ *    index; RTP's DVI4 format (RFC 3551) sends it at the start of every
+ *    packet, so each packet decodes on its own. No TI dependencies.
+ */
+
+#ifndef ADPCM_H_
+#define ADPCM_H_
+
+#include <stdint.h>
+
+typedef struct {
+    int16_t predicted;
+    uint8_t index;              /* into the 89-entry step table */
+} AdpcmState;
+
+void adpcmInit(AdpcmState *st);
+
+/*
+ *  Starts the coder mid-signal: predicted is the last sample and the step
+ *  the first at least meanDiff, the mean sample-to-sample change, so the
+ *  first packet does not spend its samples ramping up from step 7.
+ */
+void adpcmSeed(AdpcmState *st, int16_t predicted, unsigned meanDiff);
+
+/*
+ *  Codes n samples (n even) two to a byte, the first sample in the high
+ *  nibble as DVI4 wants; returns n / 2.
+ */
+unsigned adpcmEncode(AdpcmState *st, uint8_t *out, const int16_t *s,
+                     unsigned n);
+
+void adpcmDecode(AdpcmState *st, int16_t *s, const uint8_t *in, unsigned n);
+
+#endif /* ADPCM_H_ */
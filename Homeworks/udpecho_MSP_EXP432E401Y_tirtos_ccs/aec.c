@@ -0,0 +1,93 @@
+/*
+ *  aec.c
+ *  Block NLMS acoustic echo canceller, fixed point.
+ *  Author: Salim Sadman Bishal
+ *
+ *  Per sample j of a block:
+ *      y   = sum w[i] * x[j-i]              (Q30 * Q15, 64-bit accumulate)
+ *      e   = d - y
+ *      w  += mu * e * x[j-i] / (eps + |x|^2)
+ *  The history is kept linear (taps + block) so the inner loops never wrap;
+ *  it is shifted down once per block instead of once per sample.
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include "aec.h"
+
+/* keeps the step bounded while the reference is silent */
+#define AEC_EPS(taps)  ((int64_t)(taps) << 16)
+
+static int16_t sat16(int32_t v)
+{
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+void aecReset(Aec *a)
+{
+    memset(a->w, 0, sizeof(a->w));
+    memset(a->x, 0, sizeof(a->x));
+    a->power = 0;
+    a->micEnergy = a->errEnergy = 0;
+}
+
+void aecInit(Aec *a, unsigned taps, int16_t mu)
+{
+    if (taps < 1) taps = 1;
+    if (taps > AEC_MAX_TAPS) taps = AEC_MAX_TAPS;
+    a->taps = (uint16_t)taps;
+    a->mu = mu;
+    a->adapt = true;
+    aecReset(a);
+}
+
+void aecProcess(Aec *a, const int16_t *ref, const int16_t *mic,
+                int16_t *out, unsigned n)
+{
+    const unsigned taps = a->taps;
+    const int64_t eps = AEC_EPS(taps);
+    unsigned i, j;
+
+    if (n > AEC_MAX_BLOCK) n = AEC_MAX_BLOCK;
+    memcpy(&a->x[taps], ref, n * sizeof(int16_t));
+
+    for (j = 0; j < n; ++j) {
+        /* window is x[j+1 .. j+taps], newest at the end */
+        const int16_t *xn = &a->x[j + taps];
+        int32_t xin = xn[0], xout = a->x[j];
+        int64_t acc = 0;
+        int32_t d = mic[j], e;
+
+        a->power += (int64_t)xin * xin - (int64_t)xout * xout;
+
+        for (i = 0; i < taps; ++i)
+            acc += (int64_t)a->w[i] * xn[-(int)i];
+        e = sat16(d - (int32_t)(acc >> 30));
+        out[j] = (int16_t)e;
+
+        a->micEnergy += (uint64_t)((int64_t)d * d);
+        a->errEnergy += (uint64_t)((int64_t)e * e);
+
+        if (a->adapt && e != 0) {
+            /* g is mu*e/(eps+P) with 16 fraction bits on top of Q30 */
+            int64_t g = (((int64_t)a->mu * e) << 31) / (eps + a->power);
+            for (i = 0; i < taps; ++i) {
+                int64_t w = a->w[i] + ((g * xn[-(int)i]) >> 16);
+                if (w > INT32_MAX) w = INT32_MAX;
+                if (w < INT32_MIN) w = INT32_MIN;
+                a->w[i] = (int32_t)w;
+            }
+        }
+    }
+
+    memmove(a->x, &a->x[n], taps * sizeof(int16_t));
+}
+
+int aecErleTenthsDb(const Aec *a)
+{
+    if (a->errEnergy == 0 || a->micEnergy == 0) return 0;
+    return (int)(100.0 * log10((double)a->micEnergy / (double)a->errEnergy));
+}
@@ -0,0 +1,43 @@
+/*
+ *  aec.h
+ *  Block NLMS acoustic echo canceller, fixed point.
+ *  Author: Salim Sadman Bishal
+ *
+ *  Samples are Q15. The reference is what the DAC played during the same
+ *  sample clock ticks that captured the mic block, so no extra delay line
+ *  is needed beyond the filter itself. No TI headers: builds on a host too.
+ */
+
+#ifndef AEC_H_
+#define AEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AEC_MAX_TAPS   256
+#define AEC_MAX_BLOCK  64
+#define AEC_DEF_TAPS   128
+#define AEC_DEF_MU     3277   // 0.1 in Q15
+
+typedef struct {
+    int32_t  w[AEC_MAX_TAPS];                  // coefficients, Q30
+    int16_t  x[AEC_MAX_TAPS + AEC_MAX_BLOCK];  // reference history, oldest first
+    int64_t  power;                            // sum x^2 over the last taps samples
+    uint16_t taps;
+    int16_t  mu;                               // step size, Q15
+    bool     adapt;                            // false freezes the coefficients
+    uint64_t micEnergy;                        // running sums for ERLE
+    uint64_t errEnergy;
+} Aec;
+
+void aecInit(Aec *a, unsigned taps, int16_t mu);
+void aecReset(Aec *a);
+
+/* out[i] = mic[i] - echo estimate; n <= AEC_MAX_BLOCK; out may alias mic */
+void aecProcess(Aec *a, const int16_t *ref, const int16_t *mic,
+                int16_t *out, unsigned n);
+
+/* echo return loss enhancement since the last reset, in 0.1 dB */
+int aecErleTenthsDb(const Aec *a);
+
+#endif /* AEC_H_ */
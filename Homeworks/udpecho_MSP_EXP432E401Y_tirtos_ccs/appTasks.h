@@ -0,0 +1,30 @@
+/*
+ *    ======== appTasks.h ========
+ *    The firmware's pthreads, for telemetry. Priorities and stack sizes
+ *    are fixed in one table in udpEchoHooks.c.
+ */
+
+#ifndef APPTASKS_H_
+#define APPTASKS_H_
+
+#include <stddef.h>
+
+typedef struct {
+    const char *name;
+    int         priority;
+    size_t      stackSize;
+    size_t      stackPeak;          /* most ever used, from the paint */
+} TaskInfo;
+
+/*
+ *  From main() before BIOS_start(): initializes the drivers and shared
+ *  state and starts the tasks that need no network (DAC playout, the
+ *  serial console, board events), so the board has audio and a shell with
+ *  no cable or DHCP lease. netIPAddrHook() starts the rest.
+ */
+void appTasksBoot(void);
+
+/* fills info with the tasks that were started; returns how many */
+unsigned appTasksInfo(TaskInfo *info, unsigned max);
+
+#endif /* APPTASKS_H_ */
@@ -0,0 +1,225 @@
+/*
+ *    ======== audioAdapt.c ========
+ *    Feedback packets and the adaptation policy; see audioAdapt.h.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audioAdapt.h"
+#include "rtp.h"
+
+/* best quality and latency first, least bandwidth and packets last */
+static const AdaptMode ladder[] = {
+    { RTP_PT_L16,  1 },         /* 8 ms, 128 kbit/s + headers */
+    { RTP_PT_L16,  2 },
+    { RTP_PT_PCMU, 2 },         /* 64 kbit/s */
+    { RTP_PT_PCMU, 4 },
+    { RTP_PT_DVI4, 4 },         /* 32 kbit/s */
+    { RTP_PT_DVI4, 8 },         /* 64 ms: 16 packets/s, ~37 kbit/s on the wire */
+};
+
+#define NUM_LEVELS (sizeof(ladder) / sizeof(ladder[0]))
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    put16(p, (uint16_t)(v >> 16));
+    put16(p + 2, (uint16_t)v);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return ((uint16_t)((p[0] << 8) | p[1]));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (((uint32_t)get16(p) << 16) | get16(p + 2));
+}
+
+/*
+ *  ======== audioAdaptProbe ========
+ */
+unsigned audioAdaptProbe(uint8_t *p, uint32_t ssrc, uint64_t nowUs)
+{
+    put32(p, AUDIOADAPT_PROBE_MAGIC);
+    put32(p + 4, ssrc);
+    put32(p + 8, (uint32_t)(nowUs >> 32));
+    put32(p + 12, (uint32_t)nowUs);
+
+    return (AUDIOADAPT_PROBE_LEN);
+}
+
+/*
+ *  ======== audioAdaptIsProbe ========
+ */
+bool audioAdaptIsProbe(const uint8_t *p, unsigned len, uint32_t *ssrc,
+                       uint64_t *probeUs)
+{
+    if (len < AUDIOADAPT_PROBE_LEN || get32(p) != AUDIOADAPT_PROBE_MAGIC) {
+        return (false);
+    }
+    *ssrc = get32(p + 4);
+    *probeUs = ((uint64_t)get32(p + 8) << 32) | get32(p + 12);
+
+    return (true);
+}
+
+/*
+ *  ======== audioAdaptWriteReport ========
+ */
+unsigned audioAdaptWriteReport(uint8_t *p, const AdaptReport *r)
+{
+    put32(p, AUDIOADAPT_REPORT_MAGIC);
+    put32(p + 4, r->ssrc);
+    put32(p + 8, (uint32_t)(r->probeUs >> 32));
+    put32(p + 12, (uint32_t)r->probeUs);
+    put32(p + 16, r->holdUs);
+    put16(p + 20, r->lossPermille);
+    put16(p + 22, 0);
+    put32(p + 24, r->jitterUs);
+    put32(p + 28, r->highestSeq);
+
+    return (AUDIOADAPT_REPORT_LEN);
+}
+
+/*
+ *  ======== audioAdaptReadReport ========
+ */
+bool audioAdaptReadReport(const uint8_t *p, unsigned len, AdaptReport *r)
+{
+    if (len < AUDIOADAPT_REPORT_LEN ||
+            get32(p) != AUDIOADAPT_REPORT_MAGIC) {
+        return (false);
+    }
+    r->ssrc = get32(p + 4);
+    r->probeUs = ((uint64_t)get32(p + 8) << 32) | get32(p + 12);
+    r->holdUs = get32(p + 16);
+    r->lossPermille = get16(p + 20);
+    r->jitterUs = get32(p + 24);
+    r->highestSeq = (uint16_t)get32(p + 28);
+
+    return (true);
+}
+
+/*
+ *  ======== closest ========
+ *  The first step with mode's codec and at least its packet size, else
+ *  the last step with that codec, else where we are.
+ */
+static unsigned closest(unsigned level, const AdaptMode *mode)
+{
+    unsigned i;
+
+    for (i = 0; i < NUM_LEVELS; i++) {
+        if (ladder[i].pt != mode->pt) {
+            continue;
+        }
+        level = i;
+        if (ladder[i].framesPerPacket >= mode->framesPerPacket) {
+            break;
+        }
+    }
+
+    return (level);
+}
+
+/*
+ *  ======== audioAdaptInit ========
+ */
+void audioAdaptInit(AudioAdapt *a, const AdaptMode *mode)
+{
+    memset(a, 0, sizeof(*a));
+    a->minRttUs = UINT32_MAX;
+    a->level = closest(a->level, mode);
+}
+
+/*
+ *  ======== audioAdaptSetMode ========
+ */
+void audioAdaptSetMode(AudioAdapt *a, const AdaptMode *mode)
+{
+    unsigned level = closest(a->level, mode);
+
+    if (level != a->level) {
+        a->level = level;
+        a->good = 0;
+        a->hold = ADAPT_HOLD_REPORTS;
+    }
+}
+
+/*
+ *  ======== audioAdaptReport ========
+ */
+bool audioAdaptReport(AudioAdapt *a, const AdaptReport *r, uint64_t nowUs)
+{
+    uint64_t rtt = nowUs - r->probeUs;
+    bool     congested;
+
+    rtt = rtt > r->holdUs ? rtt - r->holdUs : 0;
+    if (rtt > UINT32_MAX) {
+        return (false);         /* not one of our probes */
+    }
+
+    a->stats.reports++;
+    a->stats.lastRttUs = (uint32_t)rtt;
+    a->stats.lastLoss = r->lossPermille;
+    a->stats.lastJitterUs = r->jitterUs;
+
+    /* the baseline creeps up so a longer route is eventually accepted */
+    if (a->minRttUs != UINT32_MAX) {
+        a->minRttUs += a->minRttUs / 64 + 1;
+    }
+    if (rtt < a->minRttUs) {
+        a->minRttUs = (uint32_t)rtt;
+    }
+
+    if (a->hold > 0) {
+        a->hold--;
+        return (false);
+    }
+
+    congested = r->lossPermille >= ADAPT_LOSS_BAD ||
+                r->jitterUs >= ADAPT_JITTER_BAD_US ||
+                rtt >= (uint64_t)a->minRttUs + ADAPT_RTT_BAD_US;
+
+    if (congested) {
+        a->good = 0;
+        if (a->level + 1 < NUM_LEVELS) {
+            a->level++;
+            a->hold = ADAPT_HOLD_REPORTS;
+            a->stats.down++;
+            return (true);
+        }
+        return (false);
+    }
+
+    if (r->lossPermille > ADAPT_LOSS_GOOD) {
+        a->good = 0;            /* neither bad enough to act nor clean */
+        return (false);
+    }
+    if (++a->good >= ADAPT_GOOD_REPORTS && a->level > 0) {
+        a->level--;
+        a->good = 0;
+        a->hold = ADAPT_HOLD_REPORTS;
+        a->stats.up++;
+        return (true);
+    }
+
+    return (false);
+}
+
+/*
+ *  ======== audioAdaptMode ========
+ */
+const AdaptMode *audioAdaptMode(const AudioAdapt *a)
+{
+    return (&ladder[a->level]);
+}
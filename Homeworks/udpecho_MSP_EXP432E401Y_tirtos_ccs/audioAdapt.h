@@ -0,0 +1,99 @@
+/*
+ *    ======== audioAdapt.h ========
+ *    Receiver feedback for the RTP audio stream and the sender's policy
+ *    for acting on it.
+ *
+ *    Once every AUDIOADAPT_PERIOD_MS the sender sends a probe to the
+ *    stream's destination; each receiver answers it straight away with a
+ *    report on that stream since the previous probe. The probe's own send
+ *    time comes back in the report, so the sender also gets the RTT. Both
+ *    are big-endian:
+ *        probe   0 "AFP1"  4 ssrc  8 sender time, us, 64-bit
+ *        report  0 "AFR1"  4 ssrc  8 probe's sender time, 64-bit
+ *                16 receiver hold time, us  20 loss, per mille
+ *                22 reserved  24 jitter, us  28 highest sequence number
+ *
+ *    The policy walks a ladder of (codec, frames per packet) modes: down
+ *    towards fewer, smaller packets (ADPCM, 64 ms) as soon as a report
+ *    shows congestion, back up towards lower latency and better quality
+ *    (L16, 8 ms) after a run of clean reports. Changes take effect at a
+ *    packet boundary and every packet says its own payload type, so the
+ *    receiver follows without a glitch. Plain C with no NDK or driver
+ *    dependencies.
+ */
+
+#ifndef AUDIOADAPT_H_
+#define AUDIOADAPT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AUDIOADAPT_PERIOD_MS        1000
+
+#define AUDIOADAPT_PROBE_MAGIC      0x41465031u     /* "AFP1" */
+#define AUDIOADAPT_REPORT_MAGIC     0x41465231u     /* "AFR1" */
+#define AUDIOADAPT_PROBE_LEN        16
+#define AUDIOADAPT_REPORT_LEN       32
+
+#define ADAPT_LOSS_BAD      20      /* per mille: step down at once */
+#define ADAPT_LOSS_GOOD     5       /* per mille: counts as clean */
+#define ADAPT_JITTER_BAD_US 20000
+#define ADAPT_RTT_BAD_US    20000   /* above the smallest RTT seen */
+#define ADAPT_GOOD_REPORTS  5       /* clean reports before stepping up */
+#define ADAPT_HOLD_REPORTS  2       /* reports ignored after a change */
+
+typedef struct {
+    uint8_t  pt;
+    uint8_t  framesPerPacket;
+} AdaptMode;
+
+typedef struct {
+    uint32_t ssrc;
+    uint64_t probeUs;           /* the sender's time, echoed */
+    uint32_t holdUs;            /* probe arrival to report send */
+    uint16_t lossPermille;
+    uint32_t jitterUs;
+    uint16_t highestSeq;
+} AdaptReport;
+
+typedef struct {
+    uint32_t reports;
+    uint32_t up;
+    uint32_t down;
+    uint32_t lastRttUs;
+    uint16_t lastLoss;
+    uint32_t lastJitterUs;
+} AdaptStats;
+
+typedef struct {
+    unsigned   level;           /* index into the mode ladder */
+    unsigned   good;            /* consecutive clean reports */
+    unsigned   hold;
+    uint32_t   minRttUs;
+    AdaptStats stats;
+} AudioAdapt;
+
+unsigned audioAdaptProbe(uint8_t *p, uint32_t ssrc, uint64_t nowUs);
+bool     audioAdaptIsProbe(const uint8_t *p, unsigned len, uint32_t *ssrc,
+                           uint64_t *probeUs);
+unsigned audioAdaptWriteReport(uint8_t *p, const AdaptReport *r);
+bool     audioAdaptReadReport(const uint8_t *p, unsigned len, AdaptReport *r);
+
+/* starts at the ladder step closest to mode */
+void audioAdaptInit(AudioAdapt *a, const AdaptMode *mode);
+
+/*
+ *  Moves to the step closest to a mode set from outside (the shell), and
+ *  waits a little for reports to reflect it. No-op if already there.
+ */
+void audioAdaptSetMode(AudioAdapt *a, const AdaptMode *mode);
+
+/*
+ *  Feeds one report, received at nowUs. Returns true if the mode changed;
+ *  the new one is audioAdaptMode().
+ */
+bool audioAdaptReport(AudioAdapt *a, const AdaptReport *r, uint64_t nowUs);
+
+const AdaptMode *audioAdaptMode(const AudioAdapt *a);
+
+#endif /* AUDIOADAPT_H_ */
@@ -0,0 +1,213 @@
+/*
+ *    ======== audioCapture.c ========
+ *    ADCBuf continuous capture into a ring of channel-major Q15 blocks.
+ *    The sequencer writes one frame (mic, aux0, aux1) per trigger and the
+ *    DMA ping-pong completes once per frame, so the callback runs at the
+ *    sample rate: it plays that tick's DAC sample, files the frame, and
+ *    posts a semaphore at the end of each block.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <ti/drivers/ADCBuf.h>
+#include <ti/drivers/GPIO.h>
+
+#include "ti_drivers_config.h"
+
+#include "audioCapture.h"
+#include "audioPlayback.h"
+
+#define ADC_DMA_FRAMES  1           /* frames per DMA completion */
+#define ADC_TO_Q15(x)   ((int16_t)(((int32_t)(x) - 2048) << 4))
+
+static ADCBuf_Handle     adcBuf = NULL;
+static ADCBuf_Conversion conversion[AUDIO_CHANNELS];
+static uint16_t          dmaBuf[2][ADC_DMA_FRAMES * AUDIO_CHANNELS];
+static AudioBlock        ring[AUDIO_RING_BLOCKS];
+static AudioBlock        spare;     /* filled and dropped while the ring is full */
+static AudioBlock       *fill = &ring[0];
+static uint32_t          ringTs[AUDIO_RING_BLOCKS];
+static uint16_t          last[AUDIO_CHANNELS];
+static unsigned          pos = 0;   /* frame within the block being filled */
+static volatile uint32_t blocks = 0;
+static volatile uint32_t wrIdx = 0;
+static volatile uint32_t rdIdx = 0;
+static bool              holding = false;   /* reader owns ring[rdIdx] */
+static uint32_t          sampleClock = 0;   /* clock of fill's sample 0 */
+static sem_t             blockSem;
+static pthread_mutex_t   startLock;
+
+volatile uint32_t audioCaptureOverruns = 0;
+
+/*
+ *  ======== captureCallback ========
+ */
+static void captureCallback(ADCBuf_Handle handle, ADCBuf_Conversion *conv,
+    void *completedADCBuffer, uint32_t completedChannel, int_fast16_t status)
+{
+    const uint16_t *src = (const uint16_t *)completedADCBuffer;
+    int             ch;
+
+    if (status != ADCBuf_STATUS_SUCCESS) {
+        return;
+    }
+
+    /* the DAC first, so its timing does not move with the work below */
+    audioPlaybackTick(sampleClock + pos);
+
+    for (ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        last[ch] = src[ch];
+        fill->ch[ch][pos] = ADC_TO_Q15(src[ch]);
+    }
+    if (++pos < AUDIO_BLOCKSIZE) {
+        return;
+    }
+    pos = 0;
+    blocks++;
+
+    /* keep the timeline even when a block has to be dropped */
+    if (fill == &spare) {
+        audioCaptureOverruns++;
+    }
+    else {
+        ringTs[wrIdx % AUDIO_RING_BLOCKS] = sampleClock;
+        wrIdx++;
+        sem_post(&blockSem);
+    }
+    sampleClock += AUDIO_BLOCKSIZE;
+    fill = (wrIdx - rdIdx >= AUDIO_RING_BLOCKS) ?
+        &spare : &ring[wrIdx % AUDIO_RING_BLOCKS];
+}
+
+/*
+ *  ======== audioCaptureInit ========
+ */
+void audioCaptureInit(void)
+{
+    sem_init(&blockSem, 0, 0);
+    pthread_mutex_init(&startLock, NULL);
+}
+
+/*
+ *  ======== audioCaptureStart ========
+ *  Playout and the shells both start the clock; the lock keeps them from
+ *  opening the ADCBuf twice.
+ */
+bool audioCaptureStart(void)
+{
+    ADCBuf_Params params;
+    bool          ok = true;
+    int           ch;
+
+    pthread_mutex_lock(&startLock);
+    if (adcBuf) {
+        pthread_mutex_unlock(&startLock);
+        return (true);
+    }
+
+    /* mic bias on */
+    GPIO_write(CONFIG_GPIO_PD4, 1);
+
+    ADCBuf_Params_init(&params);
+    params.returnMode        = ADCBuf_RETURN_MODE_CALLBACK;
+    params.recurrenceMode    = ADCBuf_RECURRENCE_MODE_CONTINUOUS;
+    params.callbackFxn       = captureCallback;
+    params.samplingFrequency = AUDIO_SAMPLE_RATE;
+    adcBuf = ADCBuf_open(CONFIG_ADCBUF_0, &params);
+    if (adcBuf == NULL) {
+        pthread_mutex_unlock(&startLock);
+        return (false);
+    }
+
+    /* every channel shares one DMA stream, so one buffer pair and count */
+    for (ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        conversion[ch].arg                   = NULL;
+        conversion[ch].adcChannel            = ADCBUF_CHANNEL_0 + ch;
+        conversion[ch].sampleBuffer          = dmaBuf[0];
+        conversion[ch].sampleBufferTwo       = dmaBuf[1];
+        conversion[ch].samplesRequestedCount = ADC_DMA_FRAMES * AUDIO_CHANNELS;
+    }
+
+    /*
+     *  Whatever was not sampled while stopped, and the part block that
+     *  was cut off, is a gap, not a splice.
+     */
+    if (blocks != 0 || pos != 0) {
+        sampleClock += AUDIO_BLOCKSIZE;
+    }
+    pos = 0;
+    if (ADCBuf_convert(adcBuf, conversion, AUDIO_CHANNELS) !=
+            ADCBuf_STATUS_SUCCESS) {
+        ADCBuf_close(adcBuf);
+        adcBuf = NULL;
+        ok = false;
+    }
+    pthread_mutex_unlock(&startLock);
+
+    return (ok);
+}
+
+/*
+ *  ======== audioCaptureStop ========
+ */
+void audioCaptureStop(void)
+{
+    pthread_mutex_lock(&startLock);
+    if (adcBuf) {
+        ADCBuf_convertCancel(adcBuf);
+        ADCBuf_close(adcBuf);
+        adcBuf = NULL;
+    }
+    pthread_mutex_unlock(&startLock);
+}
+
+/*
+ *  ======== audioCaptureRunning ========
+ */
+bool audioCaptureRunning(void)
+{
+    return (adcBuf != NULL);
+}
+
+/*
+ *  ======== audioCaptureRead ========
+ */
+const AudioBlock *audioCaptureRead(uint32_t *timestamp)
+{
+    /* release the block handed out by the previous call */
+    if (holding) {
+        rdIdx++;
+        holding = false;
+    }
+
+    sem_wait(&blockSem);
+
+    *timestamp = ringTs[rdIdx % AUDIO_RING_BLOCKS];
+    holding = true;
+
+    return (&ring[rdIdx % AUDIO_RING_BLOCKS]);
+}
+
+/*
+ *  ======== audioCaptureLast ========
+ */
+void audioCaptureLast(uint16_t codes[AUDIO_CHANNELS])
+{
+    int ch;
+
+    for (ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        codes[ch] = last[ch];
+    }
+}
+
+/*
+ *  ======== audioCaptureBlocks ========
+ */
+uint32_t audioCaptureBlocks(void)
+{
+    return (blocks);
+}
@@ -0,0 +1,57 @@
+/*
+ *    ======== audioCapture.h ========
+ *    The board's one audio clock. The ADCBuf trigger samples the mic and
+ *    the two aux pins together, and every trigger also plays one DAC
+ *    sample (audioPlayback.h), so input and output cannot drift apart:
+ *    one output block goes out per input block, and sample n of a
+ *    captured block was taken as the DAC played sample n of the same
+ *    clock. Captured blocks are channel-major, every channel in Q15.
+ */
+
+#ifndef AUDIOCAPTURE_H_
+#define AUDIOCAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AUDIO_SAMPLE_RATE   8000
+#define AUDIO_BLOCKSIZE     64      /* samples per block (8 ms) */
+#define AUDIO_RING_BLOCKS   8       /* blocks buffered between ISR and task */
+
+/* ADCBuf sequencer 0 channels, in the order each frame holds them */
+#define AUDIO_CH_MIC        0       /* ADCBUF_CHANNEL_0, BOOSTXL-AUDIO mic */
+#define AUDIO_CH_AUX0       1       /* ADCBUF_CHANNEL_1, boosterpack.26 */
+#define AUDIO_CH_AUX1       2       /* ADCBUF_CHANNEL_2, boosterpack.7 */
+#define AUDIO_CHANNELS      3
+
+typedef struct {
+    int16_t ch[AUDIO_CHANNELS][AUDIO_BLOCKSIZE];
+} AudioBlock;
+
+/* creates the reader's semaphore; call once before any task reads */
+void audioCaptureInit(void);
+
+/*
+ *  Starts and stops the sample clock, and the DAC with it. Stopping
+ *  pauses the reader; a restart leaves a gap in the timestamps, so the
+ *  sender marks the new talkspurt.
+ */
+bool audioCaptureStart(void);
+void audioCaptureStop(void);
+bool audioCaptureRunning(void);
+
+/*
+ *  Blocks until a captured block is available. It stays valid until the
+ *  next call; *timestamp is the sample clock of sample 0, the clock
+ *  audioPlaybackClock() counts. Single reader only.
+ */
+const AudioBlock *audioCaptureRead(uint32_t *timestamp);
+
+/* the last raw 12-bit frame, one code per channel, and blocks captured */
+void     audioCaptureLast(uint16_t codes[AUDIO_CHANNELS]);
+uint32_t audioCaptureBlocks(void);
+
+/* blocks dropped because the reader fell AUDIO_RING_BLOCKS behind */
+extern volatile uint32_t audioCaptureOverruns;
+
+#endif /* AUDIOCAPTURE_H_ */
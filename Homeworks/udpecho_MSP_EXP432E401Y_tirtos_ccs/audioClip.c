@@ -0,0 +1,238 @@
+/*
+ *    ======== audioClip.c ========
+ *    Board side of the clip upload: the arena, the transfer state and
+ *    playback. audioClipPacket runs in the UDP server task,
+ *    audioClipMix in the playout task and the rest from shell commands;
+ *    clipLock is priority-inheriting so playout never waits behind a
+ *    lower task for long.
+ *
+ *    The arena comes from the heap at boot rather than .bss: the linker
+ *    file's HeapMem heap is already reserved SRAM, so the arena does not
+ *    change the link. Without it every START is refused as too large.
+ *
+ *    The arena is only written during a transfer and only read while
+ *    playing, and a START stops playback. Playout looks at the playing
+ *    flag before it takes the lock, so it never waits out the CRC check of
+ *    a whole clip at the end of a transfer.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <pthread.h>
+
+#include "adpcm.h"
+#include "audioCapture.h"
+#include "audioClip.h"
+#include "clipXfer.h"
+#include "g711.h"
+#include "mixer.h"
+#include "rtp.h"
+#include "usClock.h"
+
+static pthread_mutex_t clipLock;
+static ClipRx          rx;
+
+static struct {
+    uint32_t   starts;          /* rx.stats.starts at the last packet */
+    ClipStatus status;
+    uint64_t   startUs;
+    uint64_t   endUs;
+} xfer;
+
+static struct {
+    volatile bool playing;
+    bool          loop;
+    uint32_t      position;
+    uint32_t      plays;
+    AdpcmState    adpcm;
+} play;
+
+/*
+ *  ======== audioClipInit ========
+ */
+void audioClipInit(void)
+{
+    pthread_mutexattr_t attrs;
+    uint8_t            *arena;
+
+    pthread_mutexattr_init(&attrs);
+    pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&clipLock, &attrs);
+    pthread_mutexattr_destroy(&attrs);
+
+    arena = malloc(AUDIOCLIP_ARENA_SIZE);
+    clipRxInit(&rx, arena, arena ? AUDIOCLIP_ARENA_SIZE : 0);
+}
+
+/*
+ *  ======== audioClipPacket ========
+ */
+unsigned audioClipPacket(const uint8_t *packet, unsigned len, uint8_t *ack)
+{
+    unsigned n;
+    uint64_t now = usClockNow();
+
+    pthread_mutex_lock(&clipLock);
+
+    /* stop before the arena changes under the player */
+    if (len > 4 && packet[4] == CLIPXFER_START) {
+        play.playing = false;
+    }
+    n = clipRxPacket(&rx, packet, len, ack);
+
+    if (rx.stats.starts != xfer.starts) {
+        xfer.starts = rx.stats.starts;
+        xfer.startUs = now;
+        xfer.endUs = 0;
+    }
+    if (rx.status != xfer.status) {
+        xfer.status = rx.status;
+        if (rx.status != CLIP_OK) {
+            xfer.endUs = now;
+        }
+    }
+
+    pthread_mutex_unlock(&clipLock);
+
+    return (n);
+}
+
+/*
+ *  ======== restart ========
+ *  Back to the first sample; a DVI4 clip starts with the coder state.
+ */
+static bool restart(void)
+{
+    const uint8_t *p = rx.arena;
+
+    play.position = 0;
+    if (rx.format == RTP_PT_DVI4) {
+        if (rx.length <= RTP_DVI4_HDR_LEN || p[2] > 88) {
+            return (false);
+        }
+        play.adpcm.predicted = (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+        play.adpcm.index = p[2];
+        play.position = RTP_DVI4_HDR_LEN;
+    }
+
+    return (true);
+}
+
+/*
+ *  ======== audioClipPlay ========
+ */
+bool audioClipPlay(bool loop)
+{
+    bool ok;
+
+    pthread_mutex_lock(&clipLock);
+    ok = rx.active && rx.status == CLIP_DONE && restart();
+    if (ok) {
+        play.loop = loop;
+        play.playing = true;
+        play.plays++;
+    }
+    pthread_mutex_unlock(&clipLock);
+
+    return (ok);
+}
+
+/*
+ *  ======== audioClipStop ========
+ */
+void audioClipStop(void)
+{
+    pthread_mutex_lock(&clipLock);
+    play.playing = false;
+    pthread_mutex_unlock(&clipLock);
+}
+
+/*
+ *  ======== audioClipStatus ========
+ */
+void audioClipStatus(AudioClipStatus *st)
+{
+    pthread_mutex_lock(&clipLock);
+    st->arenaSize = rx.arenaSize;
+    st->active = rx.active;
+    st->status = rx.status;
+    st->session = rx.session;
+    st->format = rx.format;
+    st->length = rx.length;
+    st->chunks = rx.chunks;
+    st->received = rx.received;
+    st->startUs = xfer.startUs;
+    st->endUs = xfer.endUs;
+    st->playing = play.playing;
+    st->loop = play.loop;
+    st->position = play.position;
+    st->plays = play.plays;
+    st->stats = rx.stats;
+    pthread_mutex_unlock(&clipLock);
+}
+
+/*
+ *  ======== decode ========
+ *  Up to n samples from the clip at play.position; returns how many.
+ */
+static unsigned decode(int16_t *s, unsigned n)
+{
+    const uint8_t *p = rx.arena + play.position;
+    uint32_t       left = rx.length - play.position;
+
+    switch (rx.format) {
+        case RTP_PT_PCMU:
+            n = left < n ? left : n;
+            g711DecodeUlaw(s, p, n);
+            play.position += n;
+            break;
+        case RTP_PT_PCMA:
+            n = left < n ? left : n;
+            g711DecodeAlaw(s, p, n);
+            play.position += n;
+            break;
+        case RTP_PT_DVI4:
+            n = left * 2 < n ? left * 2 : n;
+            adpcmDecode(&play.adpcm, s, p, n);
+            play.position += n / 2;
+            break;
+        default:
+            n = left / 2 < n ? left / 2 : n;
+            rtpUnpackL16(s, p, n);
+            play.position += n * 2;
+            break;
+    }
+
+    return (n);
+}
+
+/*
+ *  ======== audioClipMix ========
+ */
+void audioClipMix(int16_t *frame)
+{
+    static int16_t samples[AUDIO_BLOCKSIZE];
+    unsigned       n;
+
+    /* no lock to find out there is nothing to play */
+    if (!play.playing) {
+        return;
+    }
+
+    pthread_mutex_lock(&clipLock);
+    if (!play.playing) {
+        pthread_mutex_unlock(&clipLock);
+        return;
+    }
+    n = decode(samples, AUDIO_BLOCKSIZE);
+    if (n < AUDIO_BLOCKSIZE) {
+        memset(&samples[n], 0, (AUDIO_BLOCKSIZE - n) * sizeof(samples[0]));
+        play.playing = play.loop && restart();
+    }
+    pthread_mutex_unlock(&clipLock);
+
+    mixAdd(frame, samples, AUDIO_BLOCKSIZE);
+}
@@ -0,0 +1,58 @@
+/*
+ *    ======== audioClip.h ========
+ *    Audio clips uploaded over UDP into a RAM arena (clipXfer.h) and
+ *    played into the mix on demand. The arena is allocated from the heap
+ *    once, by audioClipInit().
+ */
+
+#ifndef AUDIOCLIP_H_
+#define AUDIOCLIP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "clipXfer.h"
+
+#define AUDIOCLIP_PORT          1003
+#define AUDIOCLIP_ARENA_SIZE    (64 * 1024) /* 4 s of L16, 16 s of DVI4 */
+
+typedef struct {
+    uint32_t    arenaSize;      /* 0 if the heap could not spare it */
+    bool        active;         /* a transfer was started */
+    ClipStatus  status;
+    uint16_t    session;
+    uint8_t     format;
+    uint32_t    length;
+    uint32_t    chunks;
+    uint32_t    received;
+    uint64_t    startUs;        /* usClock at START and at the last chunk */
+    uint64_t    endUs;
+    bool        playing;
+    bool        loop;
+    uint32_t    position;       /* bytes played */
+    uint32_t    plays;
+    ClipRxStats stats;
+} AudioClipStatus;
+
+void audioClipInit(void);
+
+/*
+ *  Takes one datagram from the clip port; returns the length of the ACK
+ *  written to ack[CLIPXFER_ACK_LEN], or 0. A START stops playback.
+ */
+unsigned audioClipPacket(const uint8_t *packet, unsigned len, uint8_t *ack);
+
+/* only a complete clip whose CRC checked will play */
+bool audioClipPlay(bool loop);
+void audioClipStop(void);
+
+void audioClipStatus(AudioClipStatus *st);
+
+/*
+ *  Adds the next AUDIO_BLOCKSIZE samples of a playing clip into frame,
+ *  with saturation; does nothing if none is playing. Called by
+ *  audioPlayoutFxn once per block.
+ */
+void audioClipMix(int16_t *frame);
+
+#endif /* AUDIOCLIP_H_ */
@@ -0,0 +1,190 @@
+/*
+ *    ======== audioPlayback.c ========
+ *    DAC8311 output on the capture's sample clock. audioPlaybackTick(),
+ *    called from the ADC callback, sends one 16-bit SPI word per sample
+ *    (SPI is in callback mode so this is legal from the ISR) and posts a
+ *    semaphore each time it finishes a block. What it played is kept a
+ *    while for the echo canceller.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <semaphore.h>
+
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/SPI.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "ti_drivers_config.h"
+
+#include "audioPlayback.h"
+
+#define PLAY_BLOCKS     2
+#define REF_SAMPLES     (2 * AUDIO_RING_BLOCKS * AUDIO_BLOCKSIZE) /* > capture ring */
+#define DAC_MIDSCALE    8192
+#define Q15_TO_DAC(x)   ((uint16_t)((((int32_t)(x) >> 2) + DAC_MIDSCALE) & 0x3FFF))
+
+static SPI_Handle        dacSpi = NULL;
+static SPI_Transaction   trans;
+static uint16_t          txWord;
+static int16_t           block[PLAY_BLOCKS][AUDIO_BLOCKSIZE];
+static volatile uint32_t wrIdx = 0;     /* blocks queued */
+static volatile uint32_t rdIdx = 0;     /* blocks played */
+static volatile bool     playing = false;   /* block[rdIdx] is going out */
+static volatile uint32_t blockStart = 0 - AUDIO_BLOCKSIZE;
+static volatile uint32_t sampleClock = 0;
+static int16_t           played[REF_SAMPLES];
+static sem_t             freeSem;
+
+volatile uint32_t audioPlaybackUnderruns = 0;
+volatile uint32_t audioPlaybackDacBusy = 0;
+
+/*
+ *  ======== spiDone ========
+ */
+static void spiDone(SPI_Handle handle, SPI_Transaction *transaction)
+{
+}
+
+/*
+ *  ======== audioPlaybackTick ========
+ */
+void audioPlaybackTick(uint32_t clock)
+{
+    int16_t x = 0;
+
+    if (clock % AUDIO_BLOCKSIZE == 0) {
+        if (playing) {
+            rdIdx++;
+            sem_post(&freeSem);
+        }
+        playing = rdIdx != wrIdx;
+        if (!playing) {
+            audioPlaybackUnderruns++;
+        }
+        blockStart = clock;
+    }
+    if (playing) {
+        x = block[rdIdx % PLAY_BLOCKS][clock % AUDIO_BLOCKSIZE];
+    }
+    played[clock % REF_SAMPLES] = x;
+    sampleClock = clock + 1;
+
+    if (dacSpi == NULL) {
+        return;
+    }
+    txWord = Q15_TO_DAC(x);
+    trans.count = 1;
+    trans.txBuf = &txWord;
+    trans.rxBuf = NULL;
+    if (!SPI_transfer(dacSpi, &trans)) {
+        audioPlaybackDacBusy++;
+    }
+}
+
+/*
+ *  ======== audioPlaybackInit ========
+ */
+void audioPlaybackInit(void)
+{
+    sem_init(&freeSem, 0, PLAY_BLOCKS);
+}
+
+/*
+ *  ======== audioPlaybackStart ========
+ */
+bool audioPlaybackStart(void)
+{
+    SPI_Params spiParams;
+
+    if (dacSpi) {
+        return (true);
+    }
+
+    /* amplifier on (PK5 is active low) */
+    GPIO_write(CONFIG_GPIO_PK5, 0);
+
+    SPI_Params_init(&spiParams);
+    spiParams.dataSize            = 16;
+    spiParams.frameFormat         = SPI_POL0_PHA1;
+    spiParams.transferMode        = SPI_MODE_CALLBACK;
+    spiParams.transferCallbackFxn = spiDone;
+    dacSpi = SPI_open(CONFIG_SPI_0, &spiParams);
+    if (dacSpi == NULL) {
+        return (false);
+    }
+
+    return (audioCaptureStart());
+}
+
+/*
+ *  ======== audioPlaybackStop ========
+ *  Leaves the sample clock to the capture.
+ */
+void audioPlaybackStop(void)
+{
+    SPI_Handle spi = dacSpi;
+
+    dacSpi = NULL;
+    if (spi) {
+        SPI_close(spi);
+    }
+    GPIO_write(CONFIG_GPIO_PK5, 1);
+}
+
+/*
+ *  ======== audioPlaybackWait ========
+ */
+uint32_t audioPlaybackWait(void)
+{
+    uintptr_t key;
+    uint32_t  start;
+
+    sem_wait(&freeSem);
+
+    /* after the block going out now (or its silence) and any queued */
+    key = HwiP_disable();
+    start = blockStart + AUDIO_BLOCKSIZE * (wrIdx - rdIdx + (playing ? 0 : 1));
+    HwiP_restore(key);
+
+    return (start);
+}
+
+/*
+ *  ======== audioPlaybackWrite ========
+ */
+void audioPlaybackWrite(const int16_t *samples)
+{
+    memcpy(block[wrIdx % PLAY_BLOCKS], samples,
+        AUDIO_BLOCKSIZE * sizeof(int16_t));
+    wrIdx++;
+}
+
+/*
+ *  ======== audioPlaybackClock ========
+ */
+uint32_t audioPlaybackClock(void)
+{
+    return (sampleClock);
+}
+
+/*
+ *  ======== audioPlaybackReference ========
+ */
+bool audioPlaybackReference(uint32_t clock, int16_t *ref)
+{
+    uint32_t i;
+
+    if (sampleClock - clock < AUDIO_BLOCKSIZE ||
+            sampleClock - clock > REF_SAMPLES) {
+        return (false);
+    }
+    for (i = 0; i < AUDIO_BLOCKSIZE; i++) {
+        ref[i] = played[(clock + i) % REF_SAMPLES];
+    }
+
+    /* the tick may have come round to them while they were copied */
+    return (sampleClock - clock <= REF_SAMPLES);
+}
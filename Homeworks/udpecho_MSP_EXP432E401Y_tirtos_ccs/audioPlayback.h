@@ -0,0 +1,52 @@
+/*
+ *    ======== audioPlayback.h ========
+ *    Block sink for the BOOSTXL-AUDIO DAC, clocked by the capture
+ *    (audioCapture.h): each ADC trigger plays one sample. Blocks are
+ *    double buffered and change only on block boundaries of that clock.
+ */
+
+#ifndef AUDIOPLAYBACK_H_
+#define AUDIOPLAYBACK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audioCapture.h"
+
+/* creates the writer's semaphore; call once before playout starts */
+void audioPlaybackInit(void);
+
+/* SPI and the amplifier; starting also starts the sample clock */
+bool audioPlaybackStart(void);
+void audioPlaybackStop(void);
+
+/*
+ *  Blocks until a buffer is free and returns the sample clock at which
+ *  the next block written will start to play. Single writer only.
+ */
+uint32_t audioPlaybackWait(void);
+
+/* queues AUDIO_BLOCKSIZE Q15 samples into the buffer audioPlaybackWait() freed */
+void audioPlaybackWrite(const int16_t *samples);
+
+/* the sample clock: the next sample to play; the receive side's arrival clock */
+uint32_t audioPlaybackClock(void);
+
+/*
+ *  Copies the AUDIO_BLOCKSIZE Q15 samples the DAC played from sample
+ *  clock clock on, the echo canceller's reference for the captured block
+ *  with that timestamp. False if they are not all played yet or too old
+ *  to still be kept.
+ */
+bool audioPlaybackReference(uint32_t clock, int16_t *ref);
+
+/* plays the sample for clock; the capture callback only */
+void audioPlaybackTick(uint32_t clock);
+
+/* blocks the DAC played as silence because none was queued */
+extern volatile uint32_t audioPlaybackUnderruns;
+
+/* ticks whose DAC word could not start, the last one still being sent */
+extern volatile uint32_t audioPlaybackDacBusy;
+
+#endif /* AUDIOPLAYBACK_H_ */
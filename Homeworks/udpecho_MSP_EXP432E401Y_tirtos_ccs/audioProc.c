@@ -0,0 +1,362 @@
+/*
+ *    ======== audioProc.c ========
+ *    Echo cancellation, voice activity and the noise gate on each mic
+ *    block before it is sent, plus the -audio loop, the -sine tone and
+ *    the -fresp sweep; see audioProc.h.
+ *
+ *    Capture and playback share the ADC's sample clock, so the reference
+ *    for a mic block is the block the DAC played over the same ticks, and
+ *    the -audio loop plays input block n as output block n plus a fixed
+ *    AUDIOPROC_LOOP_LATENCY; both are looked up by timestamp.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "audioPlayback.h"
+#include "audioProc.h"
+#include "usClock.h"
+
+#define SINE_TABLE_SIZE 256
+#define DAC_MIDSCALE    8192
+#define DAC_TO_Q15(x)   ((int16_t)(((int32_t)(x) - DAC_MIDSCALE) << 2))
+#define GATE_OPEN       32767
+
+/* one cycle in DAC8311 codes, the last entry repeating the first */
+static const uint16_t sineTable[SINE_TABLE_SIZE + 1] = {
+    8192, 8393, 8594, 8795, 8995, 9195, 9394, 9593,
+    9790, 9987, 10182, 10377, 10570, 10762, 10952, 11140,
+    11327, 11512, 11695, 11875, 12054, 12230, 12404, 12575,
+    12743, 12909, 13072, 13232, 13389, 13543, 13693, 13841,
+    13985, 14125, 14262, 14395, 14525, 14650, 14772, 14890,
+    15003, 15113, 15219, 15320, 15417, 15509, 15597, 15681,
+    15760, 15835, 15905, 15971, 16031, 16087, 16138, 16185,
+    16227, 16263, 16295, 16322, 16345, 16362, 16374, 16382,
+    16383, 16382, 16374, 16362, 16345, 16322, 16295, 16263,
+    16227, 16185, 16138, 16087, 16031, 15971, 15905, 15835,
+    15760, 15681, 15597, 15509, 15417, 15320, 15219, 15113,
+    15003, 14890, 14772, 14650, 14525, 14395, 14262, 14125,
+    13985, 13841, 13693, 13543, 13389, 13232, 13072, 12909,
+    12743, 12575, 12404, 12230, 12054, 11875, 11695, 11512,
+    11327, 11140, 10952, 10762, 10570, 10377, 10182, 9987,
+    9790, 9593, 9394, 9195, 8995, 8795, 8594, 8393,
+    8192, 7991, 7790, 7589, 7389, 7189, 6990, 6791,
+    6594, 6397, 6202, 6007, 5814, 5622, 5432, 5244,
+    5057, 4872, 4689, 4509, 4330, 4154, 3980, 3809,
+    3641, 3475, 3312, 3152, 2995, 2841, 2691, 2543,
+    2399, 2259, 2122, 1989, 1859, 1734, 1612, 1494,
+    1381, 1271, 1165, 1064, 967, 875, 787, 703,
+    624, 549, 479, 413, 353, 297, 246, 199,
+    157, 121, 89, 62, 39, 22, 10, 2,
+    0, 2, 10, 22, 39, 62, 89, 121,
+    157, 199, 246, 297, 353, 413, 479, 549,
+    624, 703, 787, 875, 967, 1064, 1165, 1271,
+    1381, 1494, 1612, 1734, 1859, 1989, 2122, 2259,
+    2399, 2543, 2691, 2841, 2995, 3152, 3312, 3475,
+    3641, 3809, 3980, 4154, 4330, 4509, 4689, 4872,
+    5057, 5244, 5432, 5622, 5814, 6007, 6202, 6397,
+    6594, 6791, 6990, 7189, 7389, 7589, 7790, 7991,
+    8192
+};
+
+pthread_mutex_t audioProcLock;
+AudioProcState  audioProc;
+AudioProcSweep  audioProcSweep;
+Aec             audioProcAec;
+Vad             audioProcVad;
+
+/* the tone; the sweep or a command sets it, only playout advances it */
+static struct {
+    volatile uint32_t phaseInc;     /* 8.24 table index per sample */
+    volatile uint32_t hz;
+    uint32_t          phase;
+} tone;
+
+/* the sweep's Goertzel state, mic and reference */
+static struct {
+    unsigned settle;
+    unsigned measured;
+    float    coeff;
+    float    m1, m2, r1, r2;
+    bool     aec, vad, passthrough; /* put back when it ends */
+} sweep;
+
+/* processed mic blocks for -audio, filed by timestamp */
+static int16_t           loop[AUDIOPROC_LOOP_BLOCKS][AUDIO_BLOCKSIZE];
+static volatile uint32_t loopTs[AUDIOPROC_LOOP_BLOCKS];
+static volatile bool     loopValid[AUDIOPROC_LOOP_BLOCKS];
+static int32_t           gateGain = GATE_OPEN;     /* Q15 */
+
+/*
+ *  ======== setTone ========
+ */
+static void setTone(uint32_t hz)
+{
+    tone.phaseInc = (uint32_t)(((uint64_t)hz << 32) / AUDIO_SAMPLE_RATE);
+    tone.hz = hz;
+}
+
+/*
+ *  ======== startBand ========
+ */
+static void startBand(void)
+{
+    uint32_t hz = audioProcSweep.hz[audioProcSweep.band];
+
+    setTone(hz);
+    sweep.coeff = 2.0f * cosf(6.2831853f * hz / AUDIO_SAMPLE_RATE);
+    sweep.m1 = sweep.m2 = sweep.r1 = sweep.r2 = 0.0f;
+    sweep.settle = AUDIOPROC_FRESP_SETTLE;
+    sweep.measured = 0;
+}
+
+/*
+ *  ======== endSweep ========
+ */
+static void endSweep(void)
+{
+    setTone(0);
+    audioProc.aec = sweep.aec;
+    audioProc.vad = sweep.vad;
+    audioProc.passthrough = sweep.passthrough;
+    audioProcSweep.active = false;
+}
+
+/*
+ *  ======== sweepBlock ========
+ *  One block of the sweep, mic against what the DAC played meanwhile.
+ */
+static void sweepBlock(const int16_t *mic, const int16_t *ref)
+{
+    float    pm, pr;
+    unsigned n;
+
+    if (sweep.settle > 0) {
+        sweep.settle--;
+        return;
+    }
+    for (n = 0; n < AUDIO_BLOCKSIZE; n++) {
+        float m = sweep.coeff * sweep.m1 - sweep.m2 + mic[n];
+        float r = sweep.coeff * sweep.r1 - sweep.r2 + ref[n];
+
+        sweep.m2 = sweep.m1;
+        sweep.m1 = m;
+        sweep.r2 = sweep.r1;
+        sweep.r1 = r;
+    }
+    if (++sweep.measured < AUDIOPROC_FRESP_MEASURE) {
+        return;
+    }
+
+    pm = sweep.m1 * sweep.m1 + sweep.m2 * sweep.m2 -
+        sweep.coeff * sweep.m1 * sweep.m2;
+    pr = sweep.r1 * sweep.r1 + sweep.r2 * sweep.r2 -
+        sweep.coeff * sweep.r1 * sweep.r2;
+    audioProcSweep.gainDb[audioProcSweep.band] =
+        (pm > 0.0f && pr > 0.0f) ? 10.0f * log10f(pm / pr) : -99.9f;
+    if (++audioProcSweep.band < AUDIOPROC_FRESP_BANDS) {
+        startBand();
+    }
+    else {
+        endSweep();
+    }
+}
+
+/*
+ *  ======== gate ========
+ *  Ramps the gain to the decision across the block. False once it is shut.
+ */
+static bool gate(int16_t *block, bool voiced)
+{
+    int32_t  target = voiced ? GATE_OPEN : 0;
+    int32_t  step = (target - gateGain) / AUDIO_BLOCKSIZE;
+    unsigned n;
+
+    if (gateGain == GATE_OPEN && voiced) {
+        return (true);
+    }
+    if (gateGain == 0 && !voiced) {
+        return (false);
+    }
+    for (n = 0; n < AUDIO_BLOCKSIZE; n++) {
+        gateGain += step;
+        block[n] = (int16_t)((block[n] * gateGain) >> 15);
+    }
+    gateGain = target;
+
+    return (true);
+}
+
+/*
+ *  ======== audioProcInit ========
+ */
+void audioProcInit(void)
+{
+    pthread_mutexattr_t attrs;
+
+    pthread_mutexattr_init(&attrs);
+    pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&audioProcLock, &attrs);
+    pthread_mutexattr_destroy(&attrs);
+
+    aecInit(&audioProcAec, AEC_DEF_TAPS, AEC_DEF_MU);
+    vadInit(&audioProcVad);
+    audioProc.voiced = true;
+}
+
+/*
+ *  ======== audioProcBlock ========
+ */
+bool audioProcBlock(int16_t *block, uint32_t timestamp)
+{
+    static int16_t ref[AUDIO_BLOCKSIZE];
+    bool           haveRef, send;
+    uint64_t       t0;
+    unsigned       slot = (timestamp / AUDIO_BLOCKSIZE) % AUDIOPROC_LOOP_BLOCKS;
+
+    pthread_mutex_lock(&audioProcLock);
+    audioProc.blocks++;
+    haveRef = (audioProc.aec || audioProcSweep.active) &&
+        audioPlaybackReference(timestamp, ref);
+    if ((audioProc.aec || audioProcSweep.active) && !haveRef) {
+        audioProc.noReference++;
+    }
+
+    if (audioProcSweep.active && haveRef) {
+        sweepBlock(block, ref);
+    }
+    if (audioProc.aec && haveRef) {
+        t0 = usClockNow();
+        aecProcess(&audioProcAec, ref, block, block, AUDIO_BLOCKSIZE);
+        audioProc.aecUs = (uint32_t)(usClockNow() - t0);
+        if (audioProc.aecUs > audioProc.aecUsMax) {
+            audioProc.aecUsMax = audioProc.aecUs;
+        }
+    }
+    audioProc.voiced = audioProc.vad ?
+        vadProcess(&audioProcVad, block, AUDIO_BLOCKSIZE) : true;
+    send = gate(block, audioProc.voiced);
+    if (!send) {
+        audioProc.silent++;
+    }
+
+    /* playout takes it AUDIOPROC_LOOP_LATENCY later, or never if late */
+    loopValid[slot] = false;
+    if (audioProc.passthrough && send) {
+        memcpy(loop[slot], block, AUDIO_BLOCKSIZE * sizeof(int16_t));
+        loopTs[slot] = timestamp;
+        loopValid[slot] = true;
+    }
+    pthread_mutex_unlock(&audioProcLock);
+
+    return (send);
+}
+
+/*
+ *  ======== audioProcPlay ========
+ */
+void audioProcPlay(int16_t *frame, uint32_t clock)
+{
+    uint32_t inc = tone.phaseInc;
+    uint32_t want = clock - AUDIOPROC_LOOP_LATENCY;
+    unsigned slot = (want / AUDIO_BLOCKSIZE) % AUDIOPROC_LOOP_BLOCKS;
+    int32_t  acc;
+    unsigned n;
+
+    /* the sweep measures the speaker and mic alone */
+    if (audioProcSweep.active) {
+        memset(frame, 0, AUDIO_BLOCKSIZE * sizeof(int16_t));
+    }
+    if (loopValid[slot] && loopTs[slot] == want) {
+        const int16_t *mic = loop[slot];
+
+        for (n = 0; n < AUDIO_BLOCKSIZE; n++) {
+            acc = frame[n] + mic[n];
+            frame[n] = acc > 32767 ? 32767 : (acc < -32768 ? -32768 : acc);
+        }
+    }
+    if (inc == 0) {
+        return;
+    }
+    for (n = 0; n < AUDIO_BLOCKSIZE; n++) {
+        uint32_t i = tone.phase >> 24;
+        int32_t  frac = (tone.phase >> 8) & 0xFFFF;
+        int32_t  a = sineTable[i], b = sineTable[i + 1];
+
+        acc = frame[n] + DAC_TO_Q15(a + (((b - a) * frac) >> 16));
+        frame[n] = acc > 32767 ? 32767 : (acc < -32768 ? -32768 : acc);
+        tone.phase += inc;
+    }
+}
+
+/*
+ *  ======== audioProcSine ========
+ */
+bool audioProcSine(uint32_t hz)
+{
+    bool ok;
+
+    pthread_mutex_lock(&audioProcLock);
+    ok = !audioProcSweep.active;
+    if (ok) {
+        setTone(hz);
+    }
+    pthread_mutex_unlock(&audioProcLock);
+
+    return (ok);
+}
+
+/*
+ *  ======== audioProcSineHz ========
+ */
+uint32_t audioProcSineHz(void)
+{
+    return (audioProcSweep.active ? 0 : tone.hz);
+}
+
+/*
+ *  ======== audioProcSweepStart ========
+ */
+bool audioProcSweepStart(uint32_t f0, uint32_t f1)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&audioProcLock);
+    if (audioProcSweep.active || tone.phaseInc != 0) {
+        pthread_mutex_unlock(&audioProcLock);
+        return (false);
+    }
+    for (i = 0; i < AUDIOPROC_FRESP_BANDS; i++) {
+        audioProcSweep.hz[i] = (uint16_t)(f0 * powf((float)f1 / f0,
+            (float)i / (AUDIOPROC_FRESP_BANDS - 1)) + 0.5f);
+    }
+
+    /* measure the analog chain alone */
+    sweep.aec = audioProc.aec;
+    sweep.vad = audioProc.vad;
+    sweep.passthrough = audioProc.passthrough;
+    audioProc.aec = audioProc.vad = audioProc.passthrough = false;
+
+    audioProcSweep.band = 0;
+    startBand();
+    audioProcSweep.active = true;
+    pthread_mutex_unlock(&audioProcLock);
+
+    return (true);
+}
+
+/*
+ *  ======== audioProcSweepStop ========
+ */
+void audioProcSweepStop(void)
+{
+    pthread_mutex_lock(&audioProcLock);
+    if (audioProcSweep.active) {
+        endSweep();
+    }
+    pthread_mutex_unlock(&audioProcLock);
+}
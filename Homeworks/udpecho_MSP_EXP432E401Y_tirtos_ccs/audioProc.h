@@ -0,0 +1,97 @@
+/*
+ *    ======== audioProc.h ========
+ *    The mic stage in front of the RTP sender: acoustic echo cancellation
+ *    against what the DAC played (aec.h), voice activity detection (vad.h)
+ *    and a noise gate that ramps over a block so it does not click. A
+ *    block the gate has shut is not sent at all, which ends the talkspurt;
+ *    the next voiced block goes out with the marker bit.
+ *
+ *    The same stage loops the processed mic back to the DAC (-audio),
+ *    plays a test tone (-sine) and measures the speaker-to-mic response
+ *    (-fresp) by Goertzel on the mic and on the played reference.
+ */
+
+#ifndef AUDIOPROC_H_
+#define AUDIOPROC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "aec.h"
+#include "audioCapture.h"
+#include "vad.h"
+
+#define AUDIOPROC_LOOP_BLOCKS   4       /* mic blocks kept for -audio */
+#define AUDIOPROC_FRESP_BANDS   24
+#define AUDIOPROC_FRESP_SETTLE  6       /* blocks: 2 queued at the DAC, 4 to settle */
+#define AUDIOPROC_FRESP_MEASURE 16      /* blocks per band */
+#define AUDIOPROC_FRESP_MIN     20      /* Hz */
+#define AUDIOPROC_FRESP_MAX     (AUDIO_SAMPLE_RATE / 2 - 100)
+
+/*
+ *  Mic in to DAC out for -audio, fixed since both run on one clock: the
+ *  block being captured, the block the sender processes while playout
+ *  mixes the next one, and that one playing.
+ */
+#define AUDIOPROC_LOOP_LATENCY  (3 * AUDIO_BLOCKSIZE)
+
+typedef struct {
+    bool     aec;                   /* cancel the echo */
+    bool     vad;                   /* gate, and drop silent blocks */
+    bool     passthrough;           /* mic back out of the DAC */
+    bool     voiced;                /* the last block's decision */
+    uint32_t blocks;
+    uint32_t silent;                /* blocks the gate kept from the sender */
+    uint32_t noReference;           /* blocks the canceller had to skip */
+    uint32_t aecUs;                 /* cost of the last block, and the worst */
+    uint32_t aecUsMax;
+} AudioProcState;
+
+typedef struct {
+    bool     active;
+    unsigned band;                  /* bands measured so far */
+    uint16_t hz[AUDIOPROC_FRESP_BANDS];
+    float    gainDb[AUDIOPROC_FRESP_BANDS];
+} AudioProcSweep;
+
+/* guards everything below; audioProcBlock() holds it for a whole block */
+extern pthread_mutex_t audioProcLock;
+extern AudioProcState  audioProc;
+extern AudioProcSweep  audioProcSweep;
+extern Aec             audioProcAec;
+extern Vad             audioProcVad;
+
+/* creates the lock; call once before audioTxFxn starts */
+void audioProcInit(void);
+
+/*
+ *  Runs one captured mic block through the stage in place; timestamp is
+ *  its audioCaptureRead() timestamp. Returns false if the gate is shut and
+ *  the block should not be sent. audioTxFxn only.
+ */
+bool audioProcBlock(int16_t *block, uint32_t timestamp);
+
+/*
+ *  Adds the tone and the looped-back mic into frame, which starts to play
+ *  at sample clock clock (audioPlaybackWait()). audioPlayoutFxn only.
+ */
+void audioProcPlay(int16_t *frame, uint32_t clock);
+
+/* 0 stops the tone; false while a sweep has the tone */
+bool     audioProcSine(uint32_t hz);
+uint32_t audioProcSineHz(void);
+
+/*
+ *  Starts a sweep of AUDIOPROC_FRESP_BANDS log-spaced tones from f0 to f1
+ *  with echo cancellation, the gate and passthrough off and the rest of
+ *  the DAC's output muted; false if a tone or sweep is already playing.
+ *  It is done when audioProcSweep.active goes false, and complete if
+ *  every band was measured. audioProcSweepStop() abandons it. Both take
+ *  audioProcLock.
+ */
+bool audioProcSweepStart(uint32_t f0, uint32_t f1);
+void audioProcSweepStop(void);
+
+#endif /* AUDIOPROC_H_ */
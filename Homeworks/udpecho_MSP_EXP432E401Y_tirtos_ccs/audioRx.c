@@ -0,0 +1,260 @@
+/*
+ *    ======== audioRx.c ========
+ *    Receives the RTP stream sent by audioTxFxn (or any 8 kHz mono sender
+ *    using L16, PCMU, PCMA or DVI4) and plays it on the DAC.
+ *
+ *    audioRxPacket, called from the UDP server loop (udpEcho.c), files
+ *    each packet into its stream's jitter buffer in the mixer, stamped
+ *    with the playback sample clock so the buffer can measure
+ *    interarrival jitter. audioPlayoutFxn is paced by the DAC: it sleeps
+ *    in audioPlaybackWait() and mixes one frame of every stream per 8 ms
+ *    block, plus any uploaded clip that is playing (audioClip.h) and the
+ *    shell's tone and mic loop (audioProc.h).
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include <pthread.h>
+
+#include <ti/display/Display.h>
+
+#include "audioPlayback.h"
+#include "audioAdapt.h"
+#include "audioClip.h"
+#include "audioProc.h"
+#include "audioRx.h"
+#include "fec.h"
+#include "mixer.h"
+#include "rtp.h"
+#include "usClock.h"
+
+#define UDPPACKETSIZE 1472
+
+extern Display_Handle display;
+
+AudioRxStats    audioRxStats;
+Mixer           audioRxMixer;
+pthread_mutex_t audioRxLock;
+
+static int16_t samples[2 * UDPPACKETSIZE]; /* worst case: 4 bits/sample */
+
+/*
+ *  Each mixer slot's stream has its own parity groups, so each gets its
+ *  own decoder, started afresh when a new SSRC takes the slot. Only the
+ *  UDP server loop touches these.
+ */
+static struct {
+    bool       valid;
+    uint32_t   ssrc;
+    FecDecoder dec;
+} fecSlot[MIX_MAX_STREAMS];
+
+/* where each mixer slot's stream stood at the previous probe */
+static struct {
+    bool     valid;
+    uint32_t ssrc;
+    uint16_t highestSeq;
+    uint32_t received;
+} probeBase[MIX_MAX_STREAMS];
+
+/*
+ *  ======== audioRxInit ========
+ */
+void audioRxInit(void)
+{
+    pthread_mutex_init(&audioRxLock, NULL);
+    mixInit(&audioRxMixer, 0);
+}
+
+/*
+ *  ======== audioRxSetLocalSsrc ========
+ */
+void audioRxSetLocalSsrc(uint32_t ssrc)
+{
+    pthread_mutex_lock(&audioRxLock);
+    audioRxMixer.localSsrc = ssrc;
+    pthread_mutex_unlock(&audioRxLock);
+}
+
+/*
+ *  ======== fecFor ========
+ *  The decoder of the stream ssrc, or NULL if it has no mixer slot.
+ */
+static FecDecoder *fecFor(uint32_t ssrc)
+{
+    MixStream *s;
+    unsigned   slot;
+
+    pthread_mutex_lock(&audioRxLock);
+    s = mixFind(&audioRxMixer, ssrc);
+    pthread_mutex_unlock(&audioRxLock);
+    if (s == NULL) {
+        return (NULL);
+    }
+    slot = s - audioRxMixer.stream;
+
+    if (!fecSlot[slot].valid || fecSlot[slot].ssrc != ssrc) {
+        fecSlot[slot].valid = true;
+        fecSlot[slot].ssrc = ssrc;
+        fecDecInit(&fecSlot[slot].dec);
+    }
+
+    return (&fecSlot[slot].dec);
+}
+
+/*
+ *  ======== mediaPacket ========
+ */
+static void mediaPacket(const RtpHeader *hdr, const uint8_t *payload,
+    unsigned payloadLen, uint32_t arrival)
+{
+    unsigned n = rtpPayloadSamples(hdr->pt, payloadLen);
+    unsigned nFrames = n / AUDIO_BLOCKSIZE;
+
+    /* whole frames only, and no trailing bytes */
+    if (nFrames == 0 || n % AUDIO_BLOCKSIZE != 0 ||
+            rtpPayloadBytes(hdr->pt, n) != payloadLen ||
+            rtpUnpackPayload(hdr->pt, samples, payload, payloadLen) != n) {
+        audioRxStats.badPackets++;
+        return;
+    }
+
+    pthread_mutex_lock(&audioRxLock);
+    mixPut(&audioRxMixer, hdr->ssrc, hdr->seq, hdr->ts, samples, nFrames,
+        arrival);
+    pthread_mutex_unlock(&audioRxLock);
+}
+
+/*
+ *  ======== audioRxPacket ========
+ */
+void audioRxPacket(uint8_t *packet, int len)
+{
+    RtpHeader   hdr;
+    FecDecoder *fec;
+    FecStats    before;
+    uint32_t    ssrc;
+    unsigned    payloadOff;
+    unsigned    payloadLen;
+    unsigned    recLen;
+    uint32_t    arrival = audioPlaybackClock();
+
+    audioRxStats.packets++;
+    audioRxStats.bytes += len;
+
+    if (!rtpReadHeader(packet, len, &hdr, &payloadOff, &payloadLen)) {
+        audioRxStats.badPackets++;
+        return;
+    }
+
+    /* filed first, so a new stream has its slot (and decoder) by now */
+    if (hdr.pt != RTP_PT_FEC) {
+        mediaPacket(&hdr, &packet[payloadOff], payloadLen, arrival);
+        fec = fecFor(hdr.ssrc);
+        if (fec != NULL) {
+            fecDecMedia(fec, packet, len);
+        }
+        return;
+    }
+
+    /* parity: rebuilds the group's one lost packet, if that is all it lost */
+    audioRxStats.fecPackets++;
+    fec = fecFor(hdr.ssrc);
+    if (fec == NULL) {
+        return;
+    }
+    ssrc = hdr.ssrc;
+    before = fec->stats;
+    recLen = fecDecParity(fec, packet, len);
+    audioRxStats.fecRecovered += fec->stats.recovered - before.recovered;
+    audioRxStats.fecUnrecoverable +=
+        fec->stats.unrecoverable - before.unrecoverable;
+    if (recLen == 0) {
+        return;
+    }
+    packet += FEC_PARITY_OFF;
+    if (!rtpReadHeader(packet, recLen, &hdr, &payloadOff, &payloadLen) ||
+            hdr.pt == RTP_PT_FEC || hdr.ssrc != ssrc) {
+        audioRxStats.badPackets++;
+        return;
+    }
+    mediaPacket(&hdr, &packet[payloadOff], payloadLen, arrival);
+}
+
+/*
+ *  ======== audioRxProbe ========
+ *  Loss is counted on the network (sequence numbers that never came),
+ *  over the packets expected since the previous probe.
+ */
+unsigned audioRxProbe(uint8_t *packet, unsigned len)
+{
+    AdaptReport r;
+    MixStream  *s;
+    unsigned    slot;
+    uint16_t    expected;
+    uint32_t    received;
+    uint64_t    probeArrival = usClockNow();
+
+    if (!audioAdaptIsProbe(packet, len, &r.ssrc, &r.probeUs)) {
+        return (0);
+    }
+
+    pthread_mutex_lock(&audioRxLock);
+    s = mixFind(&audioRxMixer, r.ssrc);
+    if (s == NULL) {
+        pthread_mutex_unlock(&audioRxLock);
+        return (0);
+    }
+    slot = s - audioRxMixer.stream;
+
+    r.highestSeq = s->jb.highestSeq;
+    r.jitterUs = (s->jb.jitter >> 4) * (1000000 / AUDIO_SAMPLE_RATE);
+    if (!probeBase[slot].valid || probeBase[slot].ssrc != r.ssrc) {
+        expected = 0;           /* first probe for this stream: baseline */
+        received = 0;
+    }
+    else {
+        expected = r.highestSeq - probeBase[slot].highestSeq;
+        received = s->jb.stats.received - probeBase[slot].received;
+    }
+    probeBase[slot].valid = true;
+    probeBase[slot].ssrc = r.ssrc;
+    probeBase[slot].highestSeq = r.highestSeq;
+    probeBase[slot].received = s->jb.stats.received;
+    pthread_mutex_unlock(&audioRxLock);
+
+    /* duplicates and late retransmissions can make received > expected */
+    r.lossPermille = expected > received ?
+            (uint16_t)((expected - received) * 1000 / expected) : 0;
+    r.holdUs = (uint32_t)(usClockNow() - probeArrival);
+
+    return (audioAdaptWriteReport(packet, &r));
+}
+
+/*
+ *  ======== audioPlayoutFxn ========
+ */
+void *audioPlayoutFxn(void *arg0)
+{
+    static int16_t frame[AUDIO_BLOCKSIZE];
+    uint32_t       clock;
+
+    if (!audioPlaybackStart()) {
+        Display_printf(display, 0, 0, "audioRx: playback start failed.\n");
+        return (NULL);
+    }
+
+    for (;;) {
+        clock = audioPlaybackWait();
+
+        pthread_mutex_lock(&audioRxLock);
+        mixGet(&audioRxMixer, frame);
+        pthread_mutex_unlock(&audioRxLock);
+
+        audioClipMix(frame);
+        audioProcPlay(frame, clock);
+
+        audioPlaybackWrite(frame);
+    }
+}
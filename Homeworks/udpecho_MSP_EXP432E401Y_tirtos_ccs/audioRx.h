@@ -0,0 +1,60 @@
+/*
+ *    ======== audioRx.h ========
+ *    RTP/UDP audio receiver: jitter buffer in front of the DAC.
+ */
+
+#ifndef AUDIORX_H_
+#define AUDIORX_H_
+
+#include <stdint.h>
+
+#include <pthread.h>
+
+#include "mixer.h"
+
+#define AUDIORX_PORT        5004
+#define AUDIORX_GROUP       ""      /* multicast group joined at start */
+
+typedef struct {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t badPackets;            /* not RTP, wrong payload type or size */
+    uint32_t fecPackets;            /* parity packets received */
+    uint32_t fecRecovered;          /* media packets rebuilt from parity */
+    uint32_t fecUnrecoverable;      /* groups that lost more than parity covers */
+} AudioRxStats;
+
+extern AudioRxStats audioRxStats;
+
+/* shared by audioRxPacket and audioPlayoutFxn; take audioRxLock to read */
+extern Mixer           audioRxMixer;
+extern pthread_mutex_t audioRxLock;
+
+/* call once, before playout starts or any packet arrives */
+void audioRxInit(void);
+
+/*
+ *  This board's own stream (audioTxFxn), which is never played back; set
+ *  once the address it is named after is known.
+ */
+void audioRxSetLocalSsrc(uint32_t ssrc);
+
+/*
+ *  Files one received datagram into the jitter buffer. Parity packets
+ *  (fec.h) are decoded in place, so the buffer must be writable and
+ *  32-bit aligned for the wide XOR.
+ */
+void audioRxPacket(uint8_t *packet, int len);
+
+/*
+ *  Answers a feedback probe (audioAdapt.h) in place: if packet is a probe
+ *  for a stream we are playing, it is overwritten with the report and the
+ *  report's length is returned, to go back to the probe's source. Returns
+ *  0 for anything else.
+ */
+unsigned audioRxProbe(uint8_t *packet, unsigned len);
+
+/* pthread entry; drains the jitter buffer into the DAC at the sample rate */
+void *audioPlayoutFxn(void *arg0);
+
+#endif /* AUDIORX_H_ */
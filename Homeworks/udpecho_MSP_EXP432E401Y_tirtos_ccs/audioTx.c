@@ -0,0 +1,411 @@
+/*
+ *    ======== audioTx.c ========
+ *    Sends the microphone as an RTP stream over UDP, as L16, G.711 or
+ *    DVI4.
+ *
+ *    Each packet carries framesPerPacket capture blocks, packed by the
+ *    portable packetiser (rtpPacker.h) that tools/rtpSim.c tests on a
+ *    host. The task is paced by the capture clock (it sleeps in
+ *    audioCaptureRead()), so packets leave at exactly one per
+ *    framesPerPacket * 8 ms, and the RTP timestamp is the capture sample index of the first sample in the
+ *    packet. Each block goes through the echo canceller and gate first
+ *    (audioProc.h); one the gate shuts is not sent and ends the talkspurt.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <pthread.h>
+/* BSD support */
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netdb.h>
+
+#include <ti/display/Display.h>
+
+#include "audioCapture.h"
+#include "audioAdapt.h"
+#include "audioProc.h"
+#include "audioTx.h"
+#include "clientTable.h"
+#include "fec.h"
+#include "netStats.h"
+#include "rtp.h"
+#include "rtpPacker.h"
+#include "udpPace.h"
+#include "usClock.h"
+
+#define MAXPORTLEN    6
+
+extern Display_Handle display;
+
+extern void fdOpenSession();
+extern void fdCloseSession();
+extern void *TaskSelf();
+
+AudioTxStats audioTxStats;
+
+static struct {
+    char     host[AUDIOTX_HOSTLEN];
+    uint16_t port;
+    unsigned framesPerPacket;
+    uint8_t  pt;
+    unsigned fecK;
+    bool     adapt;
+    volatile uint32_t generation;   /* bumped on every change */
+} txConfig = { AUDIOTX_HOST, AUDIOTX_PORT, AUDIOTX_DEF_FPP, AUDIOTX_DEF_PT,
+               AUDIOTX_DEF_FEC_K, AUDIOTX_DEF_ADAPT, 0 };
+
+AudioAdapt audioTxAdapt;
+
+/* words so the FEC can XOR it 32 bits at a time */
+static uint32_t packetWords[(RTP_HDR_LEN + AUDIOTX_MAX_FPP * AUDIO_BLOCKSIZE *
+                             2 + 3) / 4];
+static uint8_t *const packet = (uint8_t *)packetWords;
+
+static FecEncoder fec;
+
+/* what the packer's callbacks need */
+typedef struct {
+    int                sock;
+    struct sockaddr_in dest;
+    uint32_t           generation;  /* of txConfig, last applied */
+    RtpPacker          packer;
+} TxStream;
+
+/*
+ *  ======== audioTxConfigure ========
+ */
+bool audioTxConfigure(const char *host, uint16_t port, unsigned framesPerPacket)
+{
+    if ((host && strlen(host) >= AUDIOTX_HOSTLEN) ||
+            framesPerPacket < 1 || framesPerPacket > AUDIOTX_MAX_FPP) {
+        return (false);
+    }
+    if (host) {
+        strcpy(txConfig.host, host);
+    }
+    if (port) {
+        txConfig.port = port;
+    }
+    txConfig.framesPerPacket = framesPerPacket;
+    txConfig.generation++;
+
+    return (true);
+}
+
+/*
+ *  ======== audioTxConfig ========
+ */
+void audioTxConfig(char host[AUDIOTX_HOSTLEN], uint16_t *port,
+    unsigned *framesPerPacket, uint8_t *pt)
+{
+    strcpy(host, txConfig.host);
+    *port = txConfig.port;
+    *framesPerPacket = txConfig.framesPerPacket;
+    *pt = txConfig.pt;
+}
+
+/*
+ *  ======== audioTxSetPayloadType ========
+ */
+bool audioTxSetPayloadType(uint8_t pt)
+{
+    if (pt == RTP_PT_FEC || rtpPayloadBytes(pt, AUDIO_BLOCKSIZE) == 0) {
+        return (false);
+    }
+    txConfig.pt = pt;
+    txConfig.generation++;
+
+    return (true);
+}
+
+/*
+ *  ======== audioTxSetFec ========
+ */
+bool audioTxSetFec(unsigned k)
+{
+    if (k == 1 || k > FEC_MAX_K || (k & (k - 1)) != 0) {
+        return (false);
+    }
+    txConfig.fecK = k;
+    txConfig.generation++;
+
+    return (true);
+}
+
+/*
+ *  ======== audioTxSetAdapt ========
+ */
+void audioTxSetAdapt(bool on)
+{
+    txConfig.adapt = on;
+    txConfig.generation++;
+}
+
+/*
+ *  ======== audioTxAdaptEnabled ========
+ */
+bool audioTxAdaptEnabled(void)
+{
+    return (txConfig.adapt);
+}
+
+/*
+ *  ======== audioTxFecK ========
+ */
+unsigned audioTxFecK(void)
+{
+    return (txConfig.fecK);
+}
+
+/*
+ *  ======== resolveDest ========
+ */
+static int resolveDest(struct sockaddr_in *dest)
+{
+    struct addrinfo  hints;
+    struct addrinfo *res;
+    char             portNumber[MAXPORTLEN];
+    int              status;
+
+    sprintf(portNumber, "%d", txConfig.port);
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    status = getaddrinfo(txConfig.host, portNumber, &hints, &res);
+    if (status != 0) {
+        Display_printf(display, 0, 0, "audioTx: getaddrinfo(%s) failed: %s\n",
+            txConfig.host, gai_strerror(status));
+        return (-1);
+    }
+    memcpy(dest, res->ai_addr, sizeof(*dest));
+    freeaddrinfo(res);
+
+    return (0);
+}
+
+/*
+ *  ======== setMulticastTtl ========
+ *  Keeps a group stream on the local segment unless told otherwise.
+ */
+static void setMulticastTtl(int sock, const struct sockaddr_in *dest)
+{
+    unsigned char ttl = AUDIOTX_MCAST_TTL;
+
+    if (!IN_MULTICAST(ntohl(dest->sin_addr.s_addr))) {
+        return;
+    }
+    if (setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl,
+            sizeof(ttl)) != 0) {
+        Display_printf(display, 0, 0,
+            "audioTx: IP_MULTICAST_TTL not set, using the default\n");
+    }
+}
+
+/*
+ *  ======== sendPaced ========
+ *  The stream may defer for tokens (udpPace.h); one it gives up on counts
+ *  as a send error.
+ */
+static int sendPaced(int sock, const struct sockaddr_in *dest,
+    const void *buf, unsigned len)
+{
+    int bytesSent;
+
+    if (!udpPace(len, PACE_WAIT)) {
+        return (-1);
+    }
+    bytesSent = sendto(sock, buf, len, 0, (struct sockaddr *)dest,
+            sizeof(*dest));
+    netCountTx(NETTASK_AUDIO_TX, NETSOCK_AUDIO_TX, bytesSent, len);
+
+    return (bytesSent);
+}
+
+/*
+ *  ======== sendPacket ========
+ *  The packer's send callback.
+ */
+static void sendPacket(void *arg, uint8_t *pkt, unsigned len)
+{
+    TxStream *tx = arg;
+    int       bytesSent;
+
+    bytesSent = sendPaced(tx->sock, &tx->dest, pkt, len);
+    if (bytesSent != (int)len) {
+        audioTxStats.sendErrors++;
+    } else {
+        audioTxStats.packets++;
+        audioTxStats.bytes += len;
+    }
+    audioTxStats.overruns = audioCaptureOverruns;
+
+    /* a packet that failed to go out is what the parity is for */
+    len = fecEncAdd(&fec, pkt, len);
+    if (len == 0) {
+        return;
+    }
+    bytesSent = sendPaced(tx->sock, &tx->dest, fec.packet, len);
+    if (bytesSent != (int)len) {
+        audioTxStats.sendErrors++;
+    } else {
+        audioTxStats.fecPackets++;
+        audioTxStats.bytes += len;
+    }
+}
+
+/*
+ *  ======== feedback ========
+ *  Runs at every packet boundary: probes the receivers once a period and
+ *  takes in their reports, which arrive on this socket since it is the
+ *  stream's source. In adaptive mode a report that changes the mode is
+ *  turned into a config change, picked up at this same boundary.
+ */
+static void feedback(int sock, const struct sockaddr_in *dest, uint32_t ssrc)
+{
+    static uint64_t    nextProbe;
+    static uint8_t     buf[AUDIOADAPT_REPORT_LEN];
+    uint64_t           now = usClockNow();
+    AdaptReport        r;
+    struct sockaddr_in from;
+    socklen_t          fromLen = sizeof(from);
+    uint32_t           reports;
+    bool               changed;
+    int                n;
+
+    if (now >= nextProbe) {
+        nextProbe = now + AUDIOADAPT_PERIOD_MS * 1000ull;
+        n = audioAdaptProbe(buf, ssrc, now);
+        if (udpPace(n, PACE_DROP)) {
+            netCountTx(NETTASK_AUDIO_TX, NETSOCK_AUDIO_TX,
+                sendto(sock, buf, n, 0, (struct sockaddr *)dest,
+                    sizeof(*dest)), n);
+        }
+    }
+
+    while ((n = recvfrom(sock, buf, sizeof(buf), MSG_DONTWAIT,
+            (struct sockaddr *)&from, &fromLen)) > 0) {
+        fromLen = sizeof(from);
+        netCountRx(NETTASK_AUDIO_TX, NETSOCK_AUDIO_TX, n);
+        if (!audioAdaptReadReport(buf, n, &r) || r.ssrc != ssrc) {
+            continue;
+        }
+        reports = audioTxAdapt.stats.reports;
+        changed = audioAdaptReport(&audioTxAdapt, &r, usClockNow());
+
+        /* a receiver is a client too; -clients shows its report RTTs */
+        if (audioTxAdapt.stats.reports != reports) {
+            clientCountPacket(from.sin_addr.s_addr, from.sin_port, n,
+                clientNowMs());
+            clientAddRtt(from.sin_addr.s_addr, from.sin_port,
+                audioTxAdapt.stats.lastRttUs);
+        }
+        if (changed && txConfig.adapt) {
+            const AdaptMode *m = audioAdaptMode(&audioTxAdapt);
+
+            txConfig.pt = m->pt;
+            txConfig.framesPerPacket = m->framesPerPacket;
+            txConfig.generation++;
+        }
+    }
+}
+
+/*
+ *  ======== packetBoundary ========
+ *  The packer's boundary callback: the receivers' reports come in here,
+ *  and a config change (from the shell or from them) takes effect.
+ */
+static void packetBoundary(void *arg)
+{
+    TxStream *tx = arg;
+    AdaptMode mode;
+
+    feedback(tx->sock, &tx->dest, tx->packer.hdr.ssrc);
+    if (tx->generation == txConfig.generation) {
+        return;
+    }
+    tx->generation = txConfig.generation;
+    rtpPackerSetFormat(&tx->packer, txConfig.pt, txConfig.framesPerPacket);
+
+    /* a manual change moves the policy to the new mode too */
+    mode.pt = txConfig.pt;
+    mode.framesPerPacket = (uint8_t)txConfig.framesPerPacket;
+    audioAdaptSetMode(&audioTxAdapt, &mode);
+    if (fec.k != txConfig.fecK) {
+        fecEncInit(&fec, txConfig.fecK);
+    }
+    if (resolveDest(&tx->dest) == 0) {
+        setMulticastTtl(tx->sock, &tx->dest);
+    }
+}
+
+/*
+ *  ======== audioTxFxn ========
+ */
+void *audioTxFxn(void *arg0)
+{
+    static int16_t  mic[AUDIO_BLOCKSIZE];
+    static TxStream tx;
+
+    fdOpenSession(TaskSelf());
+
+    tx.sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (tx.sock == -1) {
+        Display_printf(display, 0, 0, "audioTx: socket not created.\n");
+        goto shutdown;
+    }
+
+    tx.generation = txConfig.generation;
+    rtpPackerInit(&tx.packer, packet, AUDIO_BLOCKSIZE, *(uint32_t *)arg0, 0,
+        txConfig.pt, txConfig.framesPerPacket, sendPacket, packetBoundary,
+        &tx);
+    fecEncInit(&fec, txConfig.fecK);
+    {
+        AdaptMode mode = { txConfig.pt, (uint8_t)txConfig.framesPerPacket };
+
+        audioAdaptInit(&audioTxAdapt, &mode);
+    }
+    if (resolveDest(&tx.dest) != 0) {
+        goto shutdown;
+    }
+    setMulticastTtl(tx.sock, &tx.dest);
+
+    /* playout has normally started the clock already */
+    if (!audioCaptureStart()) {
+        Display_printf(display, 0, 0, "audioTx: capture start failed.\n");
+        goto shutdown;
+    }
+
+    Display_printf(display, 0, 0,
+        "audioTx: streaming to %s:%d, %d frames/packet, pt %d\n",
+        txConfig.host, txConfig.port, txConfig.framesPerPacket, txConfig.pt);
+
+    for (;;) {
+        uint32_t ts;
+        const AudioBlock *block = audioCaptureRead(&ts);
+
+        memcpy(mic, block->ch[AUDIO_CH_MIC], sizeof(mic));
+        if (!audioProcBlock(mic, ts)) {
+            /* silence: the talkspurt ends now, not at the next one */
+            rtpPackerEnd(&tx.packer);
+            feedback(tx.sock, &tx.dest, tx.packer.hdr.ssrc);
+            continue;
+        }
+        rtpPackerBlock(&tx.packer, mic, ts);
+    }
+
+shutdown:
+    /* the clock runs on for the DAC */
+    if (tx.sock != -1) {
+        close(tx.sock);
+    }
+
+    fdCloseSession(TaskSelf());
+
+    return (NULL);
+}
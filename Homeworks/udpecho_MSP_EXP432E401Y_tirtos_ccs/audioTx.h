@@ -0,0 +1,79 @@
+/*
+ *    ======== audioTx.h ========
+ *    RTP/UDP audio sender: packetises captured mic blocks.
+ */
+
+#ifndef AUDIOTX_H_
+#define AUDIOTX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audioAdapt.h"
+#include "rtp.h"
+
+#define AUDIOTX_HOST        "192.168.1.100"
+#define AUDIOTX_PORT        5004
+#define AUDIOTX_DEF_FPP     2       /* frames (capture blocks) per packet */
+#define AUDIOTX_MAX_FPP     8       /* 12 + 8 * 128 bytes < UDPPACKETSIZE */
+#define AUDIOTX_HOSTLEN     16
+#define AUDIOTX_MCAST_TTL   1       /* hops for a multicast AUDIOTX_HOST */
+#define AUDIOTX_DEF_PT      RTP_PT_L16
+#define AUDIOTX_DEF_FEC_K   0       /* parity every K packets, 0 for none */
+#define AUDIOTX_DEF_ADAPT   false   /* follow receiver feedback */
+
+typedef struct {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t sendErrors;
+    uint32_t overruns;              /* capture blocks lost before sending */
+    uint32_t fecPackets;            /* parity packets, also in bytes */
+} AudioTxStats;
+
+extern AudioTxStats audioTxStats;
+
+/* feedback policy state; only audioTxFxn writes it */
+extern AudioAdapt audioTxAdapt;
+
+/*
+ *  Destination and packetisation can change while streaming; the sender
+ *  picks them up at the next packet boundary. The host may be a multicast
+ *  group (224.0.0.0/4): one send then reaches every board that joined it.
+ *  A NULL host or a zero port keeps the current one; false, and nothing
+ *  changed, if the host is too long or framesPerPacket is not 1 to
+ *  AUDIOTX_MAX_FPP.
+ */
+bool audioTxConfigure(const char *host, uint16_t port, unsigned framesPerPacket);
+
+/* the current destination, frames per packet and payload type */
+void audioTxConfig(char host[AUDIOTX_HOSTLEN], uint16_t *port,
+    unsigned *framesPerPacket, uint8_t *pt);
+
+/*
+ *  Selects the payload format (RTP_PT_L16, RTP_PT_PCMU, RTP_PT_PCMA or
+ *  RTP_PT_DVI4), also at the next packet boundary. G.711 halves the
+ *  bandwidth of L16, and DVI4 (IMA ADPCM) halves it again.
+ */
+bool audioTxSetPayloadType(uint8_t pt);
+
+/*
+ *  Adds one XOR parity packet per k media packets (fec.h), so the
+ *  receiver can rebuild any single loss in each group; k is 2, 4, 8 or
+ *  16, or 0 to turn it off. Costs 1/k more bandwidth. Also takes effect at
+ *  the next packet boundary.
+ */
+bool     audioTxSetFec(unsigned k);
+unsigned audioTxFecK(void);
+
+/*
+ *  Lets the receivers' feedback reports (audioAdapt.h) pick the codec and
+ *  frames per packet. The sender probes and keeps the statistics either
+ *  way; this only decides whether it acts on them.
+ */
+void audioTxSetAdapt(bool on);
+bool audioTxAdaptEnabled(void);
+
+/* pthread entry; arg0 points to the 32-bit SSRC for this board */
+void *audioTxFxn(void *arg0);
+
+#endif /* AUDIOTX_H_ */
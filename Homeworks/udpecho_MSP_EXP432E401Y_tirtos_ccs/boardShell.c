@@ -0,0 +1,1339 @@
+/*
+ *    ======== boardShell.c ========
+ *    The UART shell's board commands, ported from the uartecho image this
+ *    one replaced; see boardShell.h. Syntax and output are kept so scripts
+ *    written for it still run. The audio commands drive the mic stage and tone
+ *    in audioProc.c rather than a sample loop of their own.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/Timer.h>
+
+#include "ti_drivers_config.h"
+
+#include "audioCapture.h"
+#include "audioPlayback.h"
+#include "audioProc.h"
+#include "boardShell.h"
+#include "console.h"
+#include "shell.h"
+#include "usClock.h"
+
+#define ABOUT_NAME          "Salim Sadman Bishal"
+#define ABOUT_ASSIGNMENT    "ECE 5380 HWKs"
+#define APP_VERSION         "v2.0.5"
+
+#define NUM_GPIOS           8
+#define NUM_REGISTERS       32
+#define SCRIPT_LINES        64
+#define SCRIPT_LINE_SIZE    128
+#define MAX_PAYLOAD         64
+#define MAX_TICKER_PAYLOAD  48
+
+/* twice what a sweep takes, so a sample clock that died cannot hang us */
+#define FRESP_TIMEOUT_US    (2ull * AUDIOPROC_FRESP_BANDS * \
+        (AUDIOPROC_FRESP_SETTLE + AUDIOPROC_FRESP_MEASURE) * AUDIO_BLOCKSIZE * \
+        1000000 / AUDIO_SAMPLE_RATE)
+#define FRESP_POLL_US       50000
+#define BLOCK_US            (AUDIO_BLOCKSIZE * 1000000 / AUDIO_SAMPLE_RATE)
+
+/* flash and SRAM; anything else can fault */
+#define FLASH_END           0x00100000u
+#define SRAM_START          0x20000000u
+#define SRAM_END            0x20040000u
+
+typedef struct {
+    bool    active;
+    int32_t remaining;              /* < 0: forever */
+    char    payload[MAX_PAYLOAD];
+} Callback;
+
+typedef struct {
+    bool     active;
+    uint32_t delay;                 /* BOARD_TICK_MS ticks */
+    uint32_t period;
+    int32_t  count;                 /* < 0: forever */
+    uint32_t ticksLeft;
+    char     payload[MAX_TICKER_PAYLOAD];
+} Ticker;
+
+static const uint_least8_t gpioMap[NUM_GPIOS] = {
+    CONFIG_GPIO_LED_0, CONFIG_GPIO_LED_1, CONFIG_GPIO_LED_2, CONFIG_GPIO_LED_3,
+    CONFIG_GPIO_PK5, CONFIG_GPIO_PD4, CONFIG_GPIO_BUTTON_0,
+    CONFIG_GPIO_BUTTON_1
+};
+
+static const char *const cbNames[BOARD_MAX_CB] = { "timer", "SW1", "SW2" };
+
+static int32_t  registers[NUM_REGISTERS];
+static char     scriptLines[SCRIPT_LINES][SCRIPT_LINE_SIZE];
+static uint32_t badGpio;
+static uint32_t parseGpio;
+
+/* what boardEventFxn reads; commands change it under boardLock */
+static pthread_mutex_t boardLock;
+static Callback        cb[BOARD_MAX_CB];
+static Ticker          ticker[BOARD_MAX_TICKERS];
+
+static sem_t             eventSem;
+static volatile bool     cbFired[BOARD_MAX_CB];
+static volatile uint32_t tickerTicks;
+static Timer_Handle      cbTimer;
+static Timer_Handle      tickTimer;
+static uint32_t          cbPeriodUs;
+
+/*
+ *  ======== timerIsr, tickerIsr, sw1Isr, sw2Isr ========
+ *  Only note the event; boardEventFxn runs the payloads.
+ */
+static void timerIsr(Timer_Handle handle, int_fast16_t status)
+{
+    cbFired[0] = true;
+    sem_post(&eventSem);
+}
+
+static void tickerIsr(Timer_Handle handle, int_fast16_t status)
+{
+    tickerTicks++;
+    sem_post(&eventSem);
+}
+
+static void sw1Isr(uint_least8_t index)
+{
+    cbFired[1] = true;
+    sem_post(&eventSem);
+}
+
+static void sw2Isr(uint_least8_t index)
+{
+    cbFired[2] = true;
+    sem_post(&eventSem);
+}
+
+/*
+ *  ======== skipSpace ========
+ */
+static char *skipSpace(char *p)
+{
+    while (*p == ' ' || *p == '\t') {
+        p++;
+    }
+
+    return (p);
+}
+
+/*
+ *  ======== skipWord ========
+ *  Past the next word and the blanks after it.
+ */
+static char *skipWord(char *p)
+{
+    p = skipSpace(p);
+    while (*p != '\0' && !isspace((unsigned char)*p)) {
+        p++;
+    }
+
+    return (skipSpace(p));
+}
+
+/*
+ *  ======== addrOK ========
+ */
+static bool addrOK(uint32_t a)
+{
+    return ((a < FLASH_END || (a >= SRAM_START && a < SRAM_END)) &&
+            (a & 3) == 0);
+}
+
+/*
+ *  ======== parseRegister ========
+ *  rN or RN; the register number or -1.
+ */
+static int parseRegister(const char *tok)
+{
+    int n;
+
+    if (tok == NULL || (tok[0] != 'r' && tok[0] != 'R') ||
+            !isdigit((unsigned char)tok[1])) {
+        return (-1);
+    }
+    n = atoi(&tok[1]);
+
+    return (n < NUM_REGISTERS ? n : -1);
+}
+
+/*
+ *  ======== parseOperand ========
+ *  rN, #decimal, #xHEX, or a word of memory at @addr, @xHEX or @rN.
+ */
+static bool parseOperand(const char *tok, int32_t *out)
+{
+    uint32_t addr;
+    char    *end;
+    int      r;
+
+    if (tok == NULL) {
+        return (false);
+    }
+    if ((r = parseRegister(tok)) >= 0) {
+        *out = registers[r];
+        return (true);
+    }
+    if (tok[0] == '#') {
+        if (tok[1] == 'x' || tok[1] == 'X') {
+            *out = (int32_t)strtoul(&tok[2], &end, 16);
+        }
+        else {
+            *out = strtol(&tok[1], &end, 10);
+        }
+        return (end != &tok[1] && *end == '\0');
+    }
+    if (tok[0] != '@') {
+        return (false);
+    }
+    if ((r = parseRegister(&tok[1])) >= 0) {
+        addr = (uint32_t)registers[r];
+    }
+    else if (tok[1] == 'x' || tok[1] == 'X') {
+        addr = strtoul(&tok[2], NULL, 16);
+    }
+    else {
+        addr = strtoul(&tok[1], NULL, 10);
+    }
+    if (!addrOK(addr)) {
+        return (false);
+    }
+    *out = *(volatile int32_t *)(uintptr_t)addr;
+
+    return (true);
+}
+
+/*
+ *  ======== cmdGpio ========
+ *  -gpio idx r | w 0/1 | t
+ */
+static void cmdGpio(char *args)
+{
+    int  idx;
+    char op;
+
+    if (args == NULL || *skipSpace(args) == '\0') {
+        boardShellHelp("gpio");
+        return;
+    }
+    args = skipSpace(args);
+    idx = atoi(args);
+    if (!isdigit((unsigned char)*args) || idx >= NUM_GPIOS) {
+        badGpio++;
+        shellPut("bad idx\r\n");
+        return;
+    }
+    args = skipWord(args);
+    op = *args++;
+
+    if (op == 'r') {
+        shellPut("%d\r\n", (int)GPIO_read(gpioMap[idx]));
+    }
+    else if (op == 'w') {
+        GPIO_write(gpioMap[idx], *skipSpace(args) == '1');
+    }
+    else if (op == 't') {
+        if (idx >= 6) {
+            shellPut("ro\r\n");     /* the switches are inputs */
+            return;
+        }
+        GPIO_toggle(gpioMap[idx]);
+    }
+    else {
+        parseGpio++;
+        shellPut("?? op is r, w or t\r\n");
+    }
+}
+
+/*
+ *  ======== cmdTimer ========
+ *  -timer [val [u|m|s]]; the callback 0 timer period, 0 to stop it.
+ */
+static void cmdTimer(char *args)
+{
+    unsigned long v;
+    uint32_t      us;
+    char         *unit;
+
+    if (args == NULL || *skipSpace(args) == '\0') {
+        if (cbPeriodUs == 0) {
+            shellPut("stopped\r\n");
+        }
+        else {
+            shellPut("period %u us\r\n", cbPeriodUs);
+        }
+        return;
+    }
+    v = strtoul(args, &unit, 10);
+    unit = skipSpace(unit);
+    if (*unit == 's' || *unit == 'S') {
+        us = v * 1000000u;
+    }
+    else if (*unit == 'm' || *unit == 'M') {
+        us = v * 1000u;
+    }
+    else {
+        us = v;
+    }
+    if (cbTimer == NULL) {
+        shellPut("?? timer not open\r\n");
+        return;
+    }
+
+    Timer_stop(cbTimer);
+    cbPeriodUs = 0;
+    if (us == 0) {
+        return;
+    }
+    if (Timer_setPeriod(cbTimer, Timer_PERIOD_US, us) != Timer_STATUS_SUCCESS ||
+            Timer_start(cbTimer) != Timer_STATUS_SUCCESS) {
+        shellPut("?? bad period\r\n");
+        return;
+    }
+    cbPeriodUs = us;
+}
+
+/*
+ *  ======== cmdCallback ========
+ *  -callback [idx count payload]; a count of 0 clears it.
+ */
+static void cmdCallback(char *args)
+{
+    int idx, cnt, i;
+
+    if (args == NULL || *skipSpace(args) == '\0') {
+        pthread_mutex_lock(&boardLock);
+        for (i = 0; i < BOARD_MAX_CB; i++) {
+            shellPut("callback %d is %s, count is ", i, cbNames[i]);
+            if (cb[i].active) {
+                shellPut("%d", (int)cb[i].remaining);
+            }
+            else {
+                shellPut("off");
+            }
+            shellPut("%s%s\r\n", cb[i].payload[0] ? " " : "", cb[i].payload);
+        }
+        pthread_mutex_unlock(&boardLock);
+        return;
+    }
+    args = skipSpace(args);
+    idx = atoi(args);
+    if (!isdigit((unsigned char)*args) || idx >= BOARD_MAX_CB) {
+        shellPut("idx0-2\r\n");
+        return;
+    }
+    args = skipWord(args);
+    cnt = atoi(args);
+    args = skipWord(args);
+
+    pthread_mutex_lock(&boardLock);
+    if (cnt == 0) {
+        cb[idx].active = false;
+        pthread_mutex_unlock(&boardLock);
+        shellPut("clr\r\n");
+        return;
+    }
+    cb[idx].active = true;
+    cb[idx].remaining = cnt;
+    strncpy(cb[idx].payload, args, MAX_PAYLOAD - 1);
+    cb[idx].payload[MAX_PAYLOAD - 1] = '\0';
+    pthread_mutex_unlock(&boardLock);
+}
+
+/*
+ *  ======== cmdTicker ========
+ *  -ticker [idx delay period count payload]; a count of 0 clears it.
+ */
+static void cmdTicker(char *args)
+{
+    int idx, delay, period, cnt, i;
+
+    if (args == NULL || *skipSpace(args) == '\0') {
+        shellPut("Idx | Active | Delay | Period | Count | Payload\r\n");
+        pthread_mutex_lock(&boardLock);
+        for (i = 0; i < BOARD_MAX_TICKERS; i++) {
+            shellPut("%-3d | %s | %5u | %6u | %5d | %s\r\n", i,
+                ticker[i].active ? " Yes  " : "  No  ", ticker[i].delay,
+                ticker[i].period, (int)ticker[i].count, ticker[i].payload);
+        }
+        pthread_mutex_unlock(&boardLock);
+        return;
+    }
+    args = skipSpace(args);
+    idx = atoi(args);
+    if (!isdigit((unsigned char)*args) || idx >= BOARD_MAX_TICKERS) {
+        shellPut("idx0-15\r\n");
+        return;
+    }
+    args = skipWord(args);
+    delay = atoi(args);
+    args = skipWord(args);
+    period = atoi(args);
+    args = skipWord(args);
+    cnt = atoi(args);
+    args = skipWord(args);
+    if (delay < 0 || period < 0) {
+        shellPut("?? delay and period are ticks, >= 0\r\n");
+        return;
+    }
+
+    pthread_mutex_lock(&boardLock);
+    if (cnt == 0) {
+        ticker[idx].active = false;
+        pthread_mutex_unlock(&boardLock);
+        shellPut("clr\r\n");
+        return;
+    }
+    ticker[idx].delay = delay;
+    ticker[idx].period = period;
+    ticker[idx].count = cnt;
+    ticker[idx].ticksLeft = delay;
+    strncpy(ticker[idx].payload, args, MAX_TICKER_PAYLOAD - 1);
+    ticker[idx].payload[MAX_TICKER_PAYLOAD - 1] = '\0';
+    ticker[idx].active = true;
+    pthread_mutex_unlock(&boardLock);
+}
+
+/*
+ *  ======== cmdReg ========
+ *  -reg [op dst [src]]; no argument lists the registers.
+ */
+static void cmdReg(char *args)
+{
+    static const char *const binary[] = {
+        "mov", "add", "sub", "mul", "div", "rem", "and", "ior", "xor",
+        "max", "min"
+    };
+    char     op[8], tok1[16], tok2[16];
+    int32_t *d, v = 0;
+    int      n, r, i;
+
+    if (args == NULL || *skipSpace(args) == '\0') {
+        shellPut("R  Value\r\n--------\r\n");
+        for (i = 0; i < NUM_REGISTERS; i++) {
+            shellPut("R%d = %ld\r\n", i, (long)registers[i]);
+        }
+        return;
+    }
+    n = sscanf(args, "%7s %15s %15s", op, tok1, tok2);
+    if (n < 2) {
+        shellPut("Usage: -reg OP DST [SRC]\r\n");
+        return;
+    }
+    if ((r = parseRegister(tok1)) < 0) {
+        shellPut("Bad dst\r\n");
+        return;
+    }
+    d = &registers[r];
+
+    for (i = 0; i < (int)(sizeof(binary) / sizeof(binary[0])); i++) {
+        if (!strcasecmp(op, binary[i])) {
+            break;
+        }
+    }
+    if (i < (int)(sizeof(binary) / sizeof(binary[0]))) {
+        if (n < 3 || !parseOperand(tok2, &v)) {
+            shellPut("Bad src\r\n");
+            return;
+        }
+        if ((i == 4 || i == 5) && v == 0) {
+            shellPut("div0\r\n");
+            return;
+        }
+        switch (i) {
+            case 0:  *d = v;  break;
+            case 1:  *d += v; break;
+            case 2:  *d -= v; break;
+            case 3:  *d *= v; break;
+            case 4:  *d /= v; break;
+            case 5:  *d %= v; break;
+            case 6:  *d &= v; break;
+            case 7:  *d |= v; break;
+            case 8:  *d ^= v; break;
+            case 9:  *d = *d < v ? v : *d; break;
+            default: *d = *d > v ? v : *d; break;
+        }
+    }
+    else if (!strcasecmp(op, "xchg")) {
+        if (n < 3 || (r = parseRegister(tok2)) < 0) {
+            shellPut("Bad reg\r\n");
+            return;
+        }
+        v = *d;
+        *d = registers[r];
+        registers[r] = v;
+    }
+    else if (!strcasecmp(op, "inc")) {
+        (*d)++;
+    }
+    else if (!strcasecmp(op, "dec")) {
+        (*d)--;
+    }
+    else if (!strcasecmp(op, "neg")) {
+        *d = -*d;
+    }
+    else if (!strcasecmp(op, "not")) {
+        *d = ~*d;
+    }
+    else {
+        shellPut("Bad op\r\n");
+        return;
+    }
+    shellPut("R%d=%ld\r\n", (int)(d - registers), (long)*d);
+}
+
+/*
+ *  ======== ifOperand ========
+ *  rN or #imm (C syntax, so #0x10 is hex).
+ */
+static bool ifOperand(const char *tok, int32_t *out)
+{
+    char *end;
+    int   r;
+
+    if (tok[0] == '#') {
+        *out = strtol(&tok[1], &end, 0);
+        return (end != &tok[1] && *end == '\0');
+    }
+    if ((r = parseRegister(tok)) >= 0) {
+        *out = registers[r];
+        return (true);
+    }
+
+    return (false);
+}
+
+/*
+ *  ======== trim ========
+ */
+static char *trim(char *s)
+{
+    size_t n;
+
+    s = skipSpace(s);
+    n = strlen(s);
+    while (n > 0 && isspace((unsigned char)s[n - 1])) {
+        s[--n] = '\0';
+    }
+
+    return (s);
+}
+
+/*
+ *  ======== cmdIf ========
+ *  -if A COND B ? DESTT : DESTF
+ */
+static void cmdIf(char *args)
+{
+    char    tokA[16], cond[3], tokB[16];
+    char   *then, *other;
+    int32_t a, b;
+    bool    res;
+
+    if (args == NULL || sscanf(args, "%15s %2s %15s", tokA, cond, tokB) < 3) {
+        shellPut("Usage: -if A COND B ? DESTT : DESTF\r\n");
+        return;
+    }
+    then = strchr(args, '?');
+    if (then == NULL) {
+        shellPut("Bad '?' in -if\r\n");
+        return;
+    }
+    *then++ = '\0';
+    other = strchr(then, ':');
+    if (other != NULL) {
+        *other++ = '\0';
+    }
+
+    if (!ifOperand(tokA, &a)) {
+        shellPut("Bad A\r\n");
+        return;
+    }
+    if (!ifOperand(tokB, &b)) {
+        shellPut("Bad B\r\n");
+        return;
+    }
+    if (cond[0] == '>') {
+        res = a > b;
+    }
+    else if (cond[0] == '<') {
+        res = a < b;
+    }
+    else if (cond[0] == '=') {
+        res = a == b;
+    }
+    else {
+        shellPut("COND?\r\n");
+        return;
+    }
+
+    /* the branches are parts of this line, so they can run in place */
+    if (res) {
+        then = trim(then);
+        if (*then != '\0') {
+            shellRunLine(then);
+        }
+    }
+    else if (other != NULL) {
+        other = trim(other);
+        if (*other != '\0') {
+            shellRunLine(other);
+        }
+    }
+}
+
+/*
+ *  ======== cmdScript ========
+ *  -script [N [w CMD... | x | c]]
+ */
+static void cmdScript(char *args)
+{
+    char line[SCRIPT_LINE_SIZE];
+    int  idx, i;
+
+    if (args == NULL || *skipSpace(args) == '\0') {
+        shellPut("Line | Script Line\r\n------------------------------\r\n");
+        for (i = 0; i < SCRIPT_LINES; i++) {
+            shellPut("%2d   | %s\r\n", i,
+                scriptLines[i][0] ? scriptLines[i] : "<empty>");
+        }
+        return;
+    }
+    args = skipSpace(args);
+    idx = atoi(args);
+    if (!isdigit((unsigned char)*args) || idx >= SCRIPT_LINES) {
+        shellPut("Bad line\r\n");
+        return;
+    }
+    args = skipWord(args);
+
+    if (*args == '\0') {
+        shellPut("%2d | %s\r\n", idx,
+            scriptLines[idx][0] ? scriptLines[idx] : "<empty>");
+    }
+    else if (*args == 'w') {
+        strncpy(scriptLines[idx], skipWord(args), SCRIPT_LINE_SIZE - 1);
+        scriptLines[idx][SCRIPT_LINE_SIZE - 1] = '\0';
+        shellPut("Script %d loaded.\r\n", idx);
+    }
+    else if (*args == 'x') {
+        /* a copy each, since running a line tokenises it */
+        for (i = idx; i < SCRIPT_LINES && scriptLines[i][0]; i++) {
+            strcpy(line, scriptLines[i]);
+            shellRunLine(line);
+        }
+    }
+    else if (*args == 'c') {
+        scriptLines[idx][0] = '\0';
+        shellPut("Script %d cleared.\r\n", idx);
+    }
+    else {
+        shellPut("Usage: -script [line] [w|x|c] [payload]\r\n");
+    }
+}
+
+/*
+ *  ======== cmdUart ========
+ *  Out of the console port; with its TX wired to RX, the console runs it.
+ */
+static void cmdUart(char *payload)
+{
+    if (payload == NULL || *payload == '\0') {
+        shellPut("Usage: -uart <payload>\r\n");
+        return;
+    }
+    consoleWrite(payload, strlen(payload));
+    consoleWrite("\r\n", 2);
+}
+
+/*
+ *  ======== cmdMemr ========
+ */
+static void cmdMemr(char *args)
+{
+    uint32_t addr;
+
+    if (args == NULL || *skipSpace(args) == '\0') {
+        shellPut("need addr...\r\n");
+        return;
+    }
+    addr = strtoul(args, NULL, 16);
+    if (!addrOK(addr)) {
+        shellPut("addr out of range\r\n");
+        return;
+    }
+    shellPut("0x%08X\r\n", *(volatile uint32_t *)(uintptr_t)addr);
+}
+
+/*
+ *  ======== cmdError ========
+ */
+static void cmdError(void)
+{
+    shellPut("Errors:\r\n");
+    shellPut("  unknown_cmd : %u\r\n", shellUnknownCommands);
+    shellPut("  overflow    : %u\r\n", shellLongLines);
+    shellPut("  bad_gpio    : %u\r\n", badGpio);
+    shellPut("  parse_gpio  : %u\r\n", parseGpio);
+    shellPut("  audio_under : %u\r\n", audioPlaybackUnderruns);
+    shellPut("  dac_busy    : %u\r\n", audioPlaybackDacBusy);
+}
+
+/*
+ *  ======== cmdSine ========
+ *  -sine FREQ, 0 to stop; mixed over whatever else the DAC is playing.
+ */
+static void cmdSine(char *args)
+{
+    int hz;
+
+    if (args == NULL || sscanf(args, "%d", &hz) != 1) {
+        shellPut("Usage: -sine FREQ (Hz, e.g. -sine 440, or 0 to stop)\r\n");
+        return;
+    }
+    if (hz > AUDIO_SAMPLE_RATE / 2) {
+        shellPut("FREQ too high for current sample rate.\r\n");
+        return;
+    }
+    if (!audioProcSine(hz > 0 ? hz : 0)) {
+        shellPut("sine/sweep busy\r\n");
+        return;
+    }
+    shellPut(hz > 0 ? "Sine wave started.\r\n" : "Sine wave stopped.\r\n");
+}
+
+/*
+ *  ======== cmdFresp ========
+ *  -fresp F0 F1. The sweep takes seconds, so the shell lock is let go
+ *  while it runs and the table comes back when it is done.
+ */
+static void cmdFresp(char *args)
+{
+    ShellContext ctx;
+    uint64_t     deadline;
+    float        ref;
+    int          f0, f1, g, r, i;
+
+    if (args == NULL || sscanf(args, "%d %d", &f0, &f1) != 2 ||
+            f0 < AUDIOPROC_FRESP_MIN || f1 <= f0 || f1 > AUDIOPROC_FRESP_MAX) {
+        shellPut("Usage: -fresp F0 F1 (Hz, %d <= F0 < F1 <= %d)\r\n",
+            AUDIOPROC_FRESP_MIN, AUDIOPROC_FRESP_MAX);
+        return;
+    }
+    if (!shellMayWait()) {
+        shellPut("!! -fresp takes seconds; run it from the console or "
+            "telnet\r\n");
+        return;
+    }
+    if (!audioProcSweepStart(f0, f1)) {
+        shellPut("sine/sweep busy\r\n");
+        return;
+    }
+    shellPut("Sweeping...\r\n");
+
+    shellSuspend(&ctx);
+    deadline = usClockNow() + FRESP_TIMEOUT_US;
+    while (audioProcSweep.active && usClockNow() < deadline) {
+        usleep(FRESP_POLL_US);
+    }
+    shellResume(&ctx);
+
+    /* does nothing if it finished after all */
+    audioProcSweepStop();
+    if (audioProcSweep.band < AUDIOPROC_FRESP_BANDS) {
+        shellPut("!! sweep timed out in band %u of %d, no samples?\r\n",
+            audioProcSweep.band + 1, AUDIOPROC_FRESP_BANDS);
+        return;
+    }
+
+    ref = audioProcSweep.gainDb[0];
+    for (i = 1; i < AUDIOPROC_FRESP_BANDS; i++) {
+        if (audioProcSweep.gainDb[i] > ref) {
+            ref = audioProcSweep.gainDb[i];
+        }
+    }
+    shellPut("  Hz   | gain dB | rel dB\r\n");
+    for (i = 0; i < AUDIOPROC_FRESP_BANDS; i++) {
+        /* tenths of a dB, so the table does not depend on %f support */
+        g = (int)floorf(audioProcSweep.gainDb[i] * 10.0f + 0.5f);
+        r = (int)floorf((audioProcSweep.gainDb[i] - ref) * 10.0f + 0.5f);
+        shellPut("%6u | %5s%d.%d | %4s%d.%d\r\n", audioProcSweep.hz[i],
+            g < 0 ? "-" : "", abs(g) / 10, abs(g) % 10,
+            r < 0 ? "-" : "", abs(r) / 10, abs(r) % 10);
+    }
+}
+
+/*
+ *  ======== cmdAudio ========
+ *  -audio [off|stat]; alone it loops the processed mic back to the DAC.
+ */
+static void cmdAudio(char *args)
+{
+    args = args ? skipSpace(args) : "";
+
+    if (!strncmp(args, "stat", 4)) {
+        shellPut("fs %d Hz, block %d, latency %d samples (%d us), "
+            "blocks %u\r\n", AUDIO_SAMPLE_RATE, AUDIO_BLOCKSIZE,
+            AUDIOPROC_LOOP_LATENCY,
+            AUDIOPROC_LOOP_LATENCY * (1000000 / AUDIO_SAMPLE_RATE),
+            audioProc.blocks);
+        return;
+    }
+
+    pthread_mutex_lock(&audioProcLock);
+    audioProc.passthrough = strncmp(args, "off", 3) != 0;
+    pthread_mutex_unlock(&audioProcLock);
+    shellPut("Audio passthrough %s\r\n",
+        audioProc.passthrough ? "ON" : "OFF");
+    if (audioProc.passthrough && !audioCaptureRunning()) {
+        shellPut("ADC capture is off, -adc on\r\n");
+    }
+}
+
+/*
+ *  ======== cmdAdc ========
+ *  -adc [on|off]; the ADC trigger is the only audio clock, so off also
+ *  pauses the DAC and the RTP stream.
+ */
+static void cmdAdc(char *args)
+{
+    uint16_t codes[AUDIO_CHANNELS];
+    int      ch;
+
+    args = args ? skipSpace(args) : "";
+
+    if (!strncmp(args, "off", 3)) {
+        audioCaptureStop();
+        shellPut("ADC capture OFF\r\n");
+        return;
+    }
+    if (!strncmp(args, "on", 2)) {
+        if (!audioCaptureStart()) {
+            shellPut("ADCBuf_convert() failed\r\n");
+            return;
+        }
+        shellPut("ADC capture ON\r\n");
+        return;
+    }
+    audioCaptureLast(codes);
+    shellPut("capture %s, blocks %u\r\n",
+        audioCaptureRunning() ? "on" : "off", audioCaptureBlocks());
+    for (ch = 0; ch < AUDIO_CHANNELS; ch++) {
+        shellPut("  ch%d = %u\r\n", ch, codes[ch]);
+    }
+}
+
+/*
+ *  ======== cmdAec ========
+ *  -aec [on|off|hold|reset|taps N|mu M]
+ */
+static void cmdAec(char *args)
+{
+    Aec        *a = &audioProcAec;
+    const char *reply = "ok\r\n";
+    int         v, erle;
+
+    args = args ? skipSpace(args) : "";
+
+    pthread_mutex_lock(&audioProcLock);
+    if (*args == '\0') {
+        erle = aecErleTenthsDb(a);
+        shellPut("AEC %s, taps %u, mu %d/1000, adapt %s\r\n",
+            audioProc.aec ? "on" : "off", (unsigned)a->taps,
+            (int)((a->mu * 1000L + 16384) >> 15), a->adapt ? "on" : "hold");
+        shellPut("  ERLE %s%d.%d dB, us/block %u (max %u, budget %u), "
+            "no reference %u\r\n", erle < 0 ? "-" : "", abs(erle) / 10,
+            abs(erle) % 10, audioProc.aecUs, audioProc.aecUsMax, BLOCK_US,
+            audioProc.noReference);
+        reply = "";
+    }
+    else if (!strncmp(args, "on", 2)) {
+        audioProc.aec = true;
+    }
+    else if (!strncmp(args, "off", 3)) {
+        audioProc.aec = false;
+    }
+    else if (!strncmp(args, "hold", 4)) {
+        a->adapt = !a->adapt;
+    }
+    else if (!strncmp(args, "reset", 5)) {
+        aecReset(a);
+        audioProc.aecUsMax = 0;
+    }
+    else if (sscanf(args, "taps %d", &v) == 1) {
+        if (v < 1 || v > AEC_MAX_TAPS) {
+            reply = "taps 1-256\r\n";
+        }
+        else {
+            /* audioProcBlock() holds the lock, so no block sees it resize */
+            aecInit(a, v, a->mu);
+            audioProc.aecUsMax = 0;
+        }
+    }
+    else if (sscanf(args, "mu %d", &v) == 1) {
+        if (v < 1 || v > 1000) {
+            reply = "mu 1-1000\r\n";
+        }
+        else {
+            a->mu = (int16_t)((v * 32767L) / 1000);
+        }
+    }
+    else {
+        reply = "Usage: -aec [on|off|hold|reset|taps N|mu M]\r\n";
+    }
+    pthread_mutex_unlock(&audioProcLock);
+    shellPut("%s", reply);
+}
+
+/*
+ *  ======== cmdVad ========
+ *  -vad [on|off|ratio N|hang N|zcr N]
+ */
+static void cmdVad(char *args)
+{
+    Vad        *d = &audioProcVad;
+    const char *reply = "ok\r\n";
+    uint32_t    total;
+    int         v;
+
+    args = args ? skipSpace(args) : "";
+
+    pthread_mutex_lock(&audioProcLock);
+    if (*args == '\0') {
+        total = d->voicedBlocks + d->silentBlocks;
+        shellPut("VAD %s, %s, ratio %u, hang %u blocks, zcr>=%u\r\n",
+            audioProc.vad ? "on" : "off", audioProc.voiced ? "open" : "closed",
+            d->ratio, d->hangover, d->zcrMin);
+        shellPut("  energy %u, floor %u, zcr %u, voiced %u%%, not sent %u\r\n",
+            d->energy, d->floor, d->zcr,
+            total ? (uint32_t)(100ull * d->voicedBlocks / total) : 0,
+            audioProc.silent);
+        reply = "";
+    }
+    else if (!strncmp(args, "on", 2)) {
+        vadInit(d);
+        audioProc.vad = true;
+    }
+    else if (!strncmp(args, "off", 3)) {
+        audioProc.vad = false;
+    }
+    else if (sscanf(args, "ratio %d", &v) == 1 && v >= 1 && v <= 1000) {
+        d->ratio = v;
+    }
+    else if (sscanf(args, "hang %d", &v) == 1 && v >= 0 && v <= 1000) {
+        d->hangover = v;
+    }
+    else if (sscanf(args, "zcr %d", &v) == 1 && v >= 0 &&
+            v <= AUDIO_BLOCKSIZE) {
+        d->zcrMin = v;
+    }
+    else {
+        reply = "Usage: -vad [on|off|ratio N|hang N|zcr N]\r\n";
+    }
+    pthread_mutex_unlock(&audioProcLock);
+    shellPut("%s", reply);
+}
+
+/*
+ *  ======== boardShellCommand ========
+ */
+bool boardShellCommand(const char *cmd, char *args)
+{
+    if (!strcmp(cmd, "-about")) {
+        shellPut("%s | %s | %s | built %s %s\r\n", ABOUT_NAME,
+            ABOUT_ASSIGNMENT, APP_VERSION, __DATE__, __TIME__);
+    }
+    else if (!strcmp(cmd, "-print")) {
+        shellPut("%s\r\n", args ? args : "");
+    }
+    else if (!strcmp(cmd, "-rem")) {
+        /* a comment */
+    }
+    else if (!strcmp(cmd, "-error")) {
+        cmdError();
+    }
+    else if (!strcmp(cmd, "-memr")) {
+        cmdMemr(args);
+    }
+    else if (!strcmp(cmd, "-gpio")) {
+        cmdGpio(args);
+    }
+    else if (!strcmp(cmd, "-timer")) {
+        cmdTimer(args);
+    }
+    else if (!strcmp(cmd, "-callback")) {
+        cmdCallback(args);
+    }
+    else if (!strcmp(cmd, "-ticker")) {
+        cmdTicker(args);
+    }
+    else if (!strcmp(cmd, "-reg")) {
+        cmdReg(args);
+    }
+    else if (!strcmp(cmd, "-script")) {
+        cmdScript(args);
+    }
+    else if (!strcmp(cmd, "-if")) {
+        cmdIf(args);
+    }
+    else if (!strcmp(cmd, "-uart")) {
+        cmdUart(args);
+    }
+    else if (!strcmp(cmd, "-sine")) {
+        cmdSine(args);
+    }
+    else if (!strcmp(cmd, "-fresp")) {
+        cmdFresp(args);
+    }
+    else if (!strcmp(cmd, "-audio")) {
+        cmdAudio(args);
+    }
+    else if (!strcmp(cmd, "-adc")) {
+        cmdAdc(args);
+    }
+    else if (!strcmp(cmd, "-aec")) {
+        cmdAec(args);
+    }
+    else if (!strcmp(cmd, "-vad")) {
+        cmdVad(args);
+    }
+    else {
+        return (false);
+    }
+
+    return (true);
+}
+
+/*
+ *  ======== boardShellHelpList ========
+ */
+void boardShellHelpList(void)
+{
+    shellPut("-about   : author, assignment, version, build date/time\r\n"
+        "-adc     : [on|off] capture state, latest sample per channel\r\n"
+        "-aec     : [on|off|hold|reset|taps N|mu M] echo canceller\r\n"
+        "-audio   : [off|stat] mic passthrough to the DAC\r\n"
+        "-callback: [idx count payload] run payload on timer/SW1/SW2\r\n"
+        "-error   : error counters since power-up\r\n"
+        "-fresp   : F0 F1, speaker-to-mic response sweep\r\n"
+        "-gpio    : idx r | w 0/1 | t, LEDs, PK5, PD4, switches\r\n"
+        "-if      : A COND B ? DESTT : DESTF\r\n"
+        "-memr    : addrhex, read a word of flash or SRAM\r\n"
+        "-print   : text, echo it\r\n"
+        "-reg     : [op dst [src]] 32 registers\r\n"
+        "-rem     : comment\r\n"
+        "-script  : [N [w cmd | x | c]] 64 stored lines\r\n"
+        "-sine    : FREQ, test tone, 0 stops it\r\n"
+        "-ticker  : [idx delay period count payload] 10 ms tickers\r\n"
+        "-timer   : [val [m|s]] callback timer period, 0 stops it\r\n"
+        "-uart    : payload, out of the console port\r\n"
+        "-vad     : [on|off|ratio N|hang N|zcr N] voice activity gate\r\n"
+        "Use -help <cmd> for details.\r\n");
+}
+
+/*
+ *  ======== boardShellHelp ========
+ */
+bool boardShellHelp(const char *t)
+{
+    if (!strcmp(t, "about")) {
+        shellPut("-about        : show author, assignment, version, "
+            "build date/time\r\n");
+    }
+    else if (!strcmp(t, "print")) {
+        shellPut("-print text   : echo text exactly as entered\r\n");
+    }
+    else if (!strcmp(t, "memr")) {
+        shellPut("-memr addrhex : read 32-bit word (flash 0x0-0xFFFFF | "
+            "SRAM 0x20000000-0x2003FFFF)\r\n");
+    }
+    else if (!strcmp(t, "gpio")) {
+        shellPut("-gpio idx op [val]\r\n"
+            "  idx 0-3 : LEDs, 4:PK5, 5:PD4, 6-7: switches \r\n"
+            "  op  r      : read pin\r\n"
+            "      w 0/1  : write pin\r\n"
+            "      t      : toggle (outputs only)\r\n");
+    }
+    else if (!strcmp(t, "error")) {
+        shellPut("-error       : show error counters since power-up\r\n");
+    }
+    else if (!strcmp(t, "timer")) {
+        shellPut("-timer         : print current timer period (us)\r\n"
+            "-timer 0       : turn the timer off\r\n"
+            "-timer val     : set timer period (us)\r\n"
+            "-timer val m   : set timer period (ms)\r\n"
+            "-timer val s   : set timer period (s)\r\n"
+            "Example: -timer 1000 m  (sets 1s period)\r\n");
+    }
+    else if (!strcmp(t, "callback")) {
+        shellPut("-callback           : show all callback info\r\n"
+            "-callback idx count payload : set callback idx (0-2), count "
+            "(<0=forever), and payload\r\n"
+            "  idx 0: timer, 1: SW1, 2: SW2\r\n"
+            "  count: number of triggers, <0 infinite, 0 clears it\r\n"
+            "  payload: e.g. -print hello, -gpio 2 t, etc\r\n"
+            "Example: -callback 1 2 -gpio 3 t\r\n");
+    }
+    else if (!strcmp(t, "ticker")) {
+        shellPut("-ticker idx delay period count payload\r\n"
+            "  idx:     0-15 (selects ticker slot)\r\n"
+            "  delay:   initial delay, in 10ms ticks before first run\r\n"
+            "  period:  repeat interval, in 10ms ticks\r\n"
+            "  count:   # of repeats (<0 means infinite, 0 clears it)\r\n"
+            "  payload: shell command (ex: -gpio 2 t)\r\n"
+            "Example:\r\n  -ticker 3 100 100 5 -gpio 2 t\r\n"
+            "   (runs ticker #3: after 1s (100x10ms), does 'gpio 2 t' "
+            "every 1s, 5 times)\r\n"
+            "Type -ticker (no args) to see all tickers and their state.\r\n");
+    }
+    else if (!strcmp(t, "reg")) {
+        shellPut("-reg                        : Show all 32 registers\r\n"
+            "-reg mov dst src            : Move src value to dst register\r\n"
+            "-reg xchg rX rY             : Exchange two registers\r\n"
+            "-reg inc/dec rX             : Increment/decrement rX\r\n"
+            "-reg add/sub/mul/div/rem dst src : dst = dst op src\r\n"
+            "-reg not/neg rX             : Bitwise NOT/arith NEG\r\n"
+            "-reg and/ior/xor dst src    : Bitwise ops\r\n"
+            "-reg max/min dst src        : Maximum/minimum\r\n"
+            "Operands: rX, #imm, #xHEX, @addr, @xHEX, @rX (memory)\r\n"
+            "Examples:\r\n"
+            "  -reg mov r1 #123      (set r1=123)\r\n"
+            "  -reg add r2 r1        (r2 += r1)\r\n"
+            "  -reg sub r0 #x10      (r0 -= 0x10)\r\n"
+            "  -reg xchg r1 r2       (swap r1, r2)\r\n");
+    }
+    else if (!strcmp(t, "script")) {
+        shellPut("-script                  : Display all script lines\r\n"
+            "-script N                : Show script line N\r\n"
+            "-script N w CMD...       : Write CMD... to script line N\r\n"
+            "-script N x              : Execute script from line N\r\n"
+            "-script N c              : Clear line N\r\n"
+            "Example: -script 10 w -gpio 0 t\r\n");
+    }
+    else if (!strcmp(t, "if")) {
+        shellPut("-if A COND B ? DESTT : DESTF\r\n"
+            "  A/B: rN (register) or #IMM\r\n"
+            "  COND: >  =  <\r\n"
+            "  DESTT: Command if TRUE, DESTF: Command if FALSE\r\n"
+            "Example:\r\n"
+            "  -if r1 > #0 ? -print OK : -print BAD\r\n"
+            "  -if r3 < #10 ? : -print hi\r\n");
+    }
+    else if (!strcmp(t, "uart")) {
+        shellPut("-uart payload     : Send <payload> out of the console "
+            "UART (UART7). If you wire TX and RX, the console runs it.\r\n"
+            "Example: -uart -print hello\r\n");
+    }
+    else if (!strcmp(t, "rem")) {
+        shellPut("-rem [remark text] : comment line (does nothing)\r\n");
+    }
+    else if (!strcmp(t, "sine")) {
+        shellPut("-sine FREQ   : Play sine wave at FREQ Hz (e.g. -sine 440)\r\n"
+            "              Use -sine 0 to stop playback.\r\n");
+    }
+    else if (!strcmp(t, "fresp")) {
+        shellPut("-fresp F0 F1 : log sweep F0..F1 Hz through the DAC, Goertzel "
+            "on the mic\r\n"
+            "               prints chain gain per band (24 bands, ~4 s)\r\n"
+            "               the rest of the DAC's output is muted meanwhile\r\n"
+            "Example: -fresp 100 3500\r\n");
+    }
+    else if (!strcmp(t, "audio")) {
+        shellPut("-audio         : Microphone live passthrough ON\r\n"
+            "-audio off     : Passthrough OFF\r\n"
+            "-audio stat    : sample rate, block size, in->out latency\r\n");
+    }
+    else if (!strcmp(t, "aec")) {
+        shellPut("-aec           : echo canceller state, ERLE and us per block\r\n"
+            "-aec on|off    : cancel DAC echo from the mic before "
+            "passthrough/network\r\n"
+            "-aec taps N    : filter length 1-256 (resets the filter)\r\n"
+            "-aec mu M      : step size in 1/1000 (default 100)\r\n"
+            "-aec hold      : toggle freezing the coefficients\r\n"
+            "-aec reset     : clear coefficients and statistics\r\n");
+    }
+    else if (!strcmp(t, "vad")) {
+        shellPut("-vad           : detector state, noise floor, %% of voiced "
+            "blocks\r\n"
+            "-vad on|off    : gate passthrough/outgoing audio on voice "
+            "activity;\r\n"
+            "                 silent blocks are not sent\r\n"
+            "-vad ratio N   : open when block energy > N x noise floor "
+            "(default 4)\r\n"
+            "-vad hang N    : blocks to stay open after speech (default 12)\r\n"
+            "-vad zcr N     : zero crossings/block counted as unvoiced "
+            "speech\r\n");
+    }
+    else if (!strcmp(t, "adc")) {
+        shellPut("-adc           : show capture state and latest sample per "
+            "channel\r\n"
+            "-adc on|off    : start/stop the sample clock (off also pauses "
+            "the DAC and RTP)\r\n"
+            "  ch0: mic, ch1: boosterpack.26, ch2: boosterpack.7\r\n");
+    }
+    else {
+        return (false);
+    }
+
+    return (true);
+}
+
+/*
+ *  ======== runPayload ========
+ *  Only boardEventFxn calls this, so the buffers can be static.
+ */
+static void runPayload(const char *payload)
+{
+    static char request[MAX_PAYLOAD];
+    static char response[BOARD_RESPONSE];
+    size_t      n;
+
+    strcpy(request, payload);
+    n = shellExecute(request, response, sizeof(response));
+    consoleWrite(response, n);
+}
+
+/*
+ *  ======== fireCallback ========
+ */
+static void fireCallback(unsigned i)
+{
+    char payload[MAX_PAYLOAD];
+
+    pthread_mutex_lock(&boardLock);
+    if (!cb[i].active) {
+        pthread_mutex_unlock(&boardLock);
+        return;
+    }
+    strcpy(payload, cb[i].payload);
+    if (cb[i].remaining > 0 && --cb[i].remaining == 0) {
+        cb[i].active = false;
+    }
+    pthread_mutex_unlock(&boardLock);
+
+    if (payload[0] != '\0') {
+        runPayload(payload);
+    }
+}
+
+/*
+ *  ======== tick ========
+ *  One BOARD_TICK_MS step of every ticker.
+ */
+static void tick(void)
+{
+    char     payload[MAX_TICKER_PAYLOAD];
+    unsigned i;
+    bool     due;
+
+    for (i = 0; i < BOARD_MAX_TICKERS; i++) {
+        pthread_mutex_lock(&boardLock);
+        due = false;
+        if (ticker[i].active) {
+            if (ticker[i].ticksLeft > 0) {
+                ticker[i].ticksLeft--;
+            }
+            if (ticker[i].ticksLeft == 0) {
+                due = true;
+                strcpy(payload, ticker[i].payload);
+                if (ticker[i].count > 0 && --ticker[i].count == 0) {
+                    ticker[i].active = false;
+                }
+                else {
+                    ticker[i].ticksLeft = ticker[i].period;
+                }
+            }
+        }
+        pthread_mutex_unlock(&boardLock);
+
+        if (due && payload[0] != '\0') {
+            runPayload(payload);
+        }
+    }
+}
+
+/*
+ *  ======== boardShellInit ========
+ */
+void boardShellInit(void)
+{
+    pthread_mutexattr_t attrs;
+
+    pthread_mutexattr_init(&attrs);
+    pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&boardLock, &attrs);
+    pthread_mutexattr_destroy(&attrs);
+
+    sem_init(&eventSem, 0, 0);
+}
+
+/*
+ *  ======== boardEventFxn ========
+ */
+void *boardEventFxn(void *arg0)
+{
+    Timer_Params params;
+    uint32_t     seen = 0;
+    uint32_t     ticks;
+    unsigned     i;
+
+    GPIO_setConfig(CONFIG_GPIO_BUTTON_0, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_RISING);
+    GPIO_setConfig(CONFIG_GPIO_BUTTON_1, GPIO_CFG_IN_PU | GPIO_CFG_IN_INT_RISING);
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_0, sw1Isr);
+    GPIO_setCallback(CONFIG_GPIO_BUTTON_1, sw2Isr);
+    GPIO_enableInt(CONFIG_GPIO_BUTTON_0);
+    GPIO_enableInt(CONFIG_GPIO_BUTTON_1);
+
+    Timer_Params_init(&params);
+    params.periodUnits   = Timer_PERIOD_US;
+    params.period        = BOARD_CB_PERIOD_US;
+    params.timerMode     = Timer_CONTINUOUS_CALLBACK;
+    params.timerCallback = timerIsr;
+    cbTimer = Timer_open(CONFIG_TIMER_2, &params);
+    if (cbTimer != NULL && Timer_start(cbTimer) == Timer_STATUS_SUCCESS) {
+        cbPeriodUs = BOARD_CB_PERIOD_US;
+    }
+
+    params.period        = BOARD_TICK_MS * 1000;
+    params.timerCallback = tickerIsr;
+    tickTimer = Timer_open(CONFIG_TIMER_3, &params);
+    if (tickTimer != NULL) {
+        Timer_start(tickTimer);
+    }
+
+    for (;;) {
+        sem_wait(&eventSem);
+
+        for (i = 0; i < BOARD_MAX_CB; i++) {
+            if (cbFired[i]) {
+                cbFired[i] = false;
+                fireCallback(i);
+            }
+        }
+
+        /* ticks that came while payloads ran are caught up, not lost */
+        ticks = tickerTicks;
+        while (seen != ticks) {
+            seen++;
+            tick();
+        }
+    }
+}
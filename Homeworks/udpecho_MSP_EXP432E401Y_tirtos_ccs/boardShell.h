@@ -0,0 +1,47 @@
+/*
+ *    ======== boardShell.h ========
+ *    The UART shell's board commands, run by the same interpreter as the
+ *    network commands (controlShell.c): GPIO, the callback timer and
+ *    buttons, tickers, the register file, scripts, memory reads and the
+ *    audio stage (audioProc.h).
+ *
+ *    Callbacks and tickers do not run in their interrupts. The timers and
+ *    buttons only wake boardEventFxn, which runs the stored payloads
+ *    through shellExecute() and writes what they print to the console.
+ */
+
+#ifndef BOARDSHELL_H_
+#define BOARDSHELL_H_
+
+#include <stdbool.h>
+
+#define BOARD_MAX_CB        3       /* timer, SW1, SW2 */
+#define BOARD_MAX_TICKERS   16
+#define BOARD_TICK_MS       10      /* ticker delay and period unit */
+#define BOARD_CB_PERIOD_US  1000000 /* callback timer period at boot */
+#define BOARD_RESPONSE      512     /* output of one payload */
+
+/*
+ *  Runs cmd (with its leading '-') on the rest of the line, if it is a
+ *  board command; false if it is not one. Called with the shell lock
+ *  held, output through shellPut(); -fresp lets go of it while it waits
+ *  for the sweep (shellSuspend()).
+ */
+bool boardShellCommand(const char *cmd, char *args);
+
+/* prints the details for -help topic; false if there are none */
+bool boardShellHelp(const char *topic);
+
+/* one line per command, for the -help list */
+void boardShellHelpList(void);
+
+/*
+ *  Creates the table lock and event semaphore; before any shell runs and
+ *  after GPIO_init() and Timer_init().
+ */
+void boardShellInit(void);
+
+/* pthread entry; arg0 is unused */
+void *boardEventFxn(void *arg0);
+
+#endif /* BOARDSHELL_H_ */
@@ -0,0 +1,177 @@
+/*
+ *    ======== clientTable.c ========
+ *    Linear probing over at most CLIENT_MAX_PROBE slots. Entries are never
+ *    deleted, only overwritten, so probe chains never need tombstones.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include <pthread.h>
+
+#include "clientTable.h"
+
+static ClientStats     table[CLIENT_TABLE_SIZE];
+static pthread_mutex_t lock;
+
+uint32_t clientEvictions = 0;
+
+/*
+ *  ======== hashOf ========
+ */
+static unsigned hashOf(uint32_t addr, uint16_t port)
+{
+    uint32_t h = (addr ^ ((uint32_t)port << 16 | port)) * 2654435761u;
+
+    return ((h >> 16) & (CLIENT_TABLE_SIZE - 1));
+}
+
+/*
+ *  ======== find ========
+ *  Returns the slot holding addr:port, or NULL.
+ */
+static ClientStats *find(uint32_t addr, uint16_t port)
+{
+    unsigned h = hashOf(addr, port);
+    unsigned i;
+
+    for (i = 0; i < CLIENT_MAX_PROBE; i++) {
+        ClientStats *c = &table[(h + i) & (CLIENT_TABLE_SIZE - 1)];
+
+        if (!c->used) {
+            return (NULL);
+        }
+        if (c->addr == addr && c->port == port) {
+            return (c);
+        }
+    }
+
+    return (NULL);
+}
+
+/*
+ *  ======== clientTableInit ========
+ */
+void clientTableInit(void)
+{
+    pthread_mutex_init(&lock, NULL);
+    memset(table, 0, sizeof(table));
+}
+
+/*
+ *  ======== clientNowMs ========
+ */
+uint32_t clientNowMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint32_t)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+/*
+ *  ======== clientCountPacket ========
+ */
+void clientCountPacket(uint32_t addr, uint16_t port, unsigned bytes,
+                       uint32_t nowMs)
+{
+    unsigned     h = hashOf(addr, port);
+    ClientStats *victim = NULL;
+    ClientStats *c = NULL;
+    unsigned     i;
+
+    pthread_mutex_lock(&lock);
+
+    for (i = 0; i < CLIENT_MAX_PROBE; i++) {
+        ClientStats *s = &table[(h + i) & (CLIENT_TABLE_SIZE - 1)];
+
+        if (!s->used || (s->addr == addr && s->port == port)) {
+            c = s;
+            break;
+        }
+        if (victim == NULL ||
+                (int32_t)(s->lastSeen - victim->lastSeen) < 0) {
+            victim = s;
+        }
+    }
+
+    if (c == NULL) {
+        c = victim;
+        clientEvictions++;
+        c->used = false;
+    }
+    if (!c->used) {
+        memset(c, 0, sizeof(*c));
+        c->used      = true;
+        c->addr      = addr;
+        c->port      = port;
+        c->firstSeen = nowMs;
+        c->rttMin    = UINT32_MAX;
+    }
+
+    c->packets++;
+    c->bytes   += bytes;
+    c->lastSeen = nowMs;
+
+    pthread_mutex_unlock(&lock);
+}
+
+/*
+ *  ======== clientAddRtt ========
+ */
+void clientAddRtt(uint32_t addr, uint16_t port, uint32_t rttUs)
+{
+    ClientStats *c;
+
+    pthread_mutex_lock(&lock);
+
+    c = find(addr, port);
+    if (c) {
+        c->rttCount++;
+        c->rttLast = rttUs;
+        c->rttSum += rttUs;
+        if (rttUs < c->rttMin) {
+            c->rttMin = rttUs;
+        }
+        if (rttUs > c->rttMax) {
+            c->rttMax = rttUs;
+        }
+    }
+
+    pthread_mutex_unlock(&lock);
+}
+
+/*
+ *  ======== clientSnapshot ========
+ */
+unsigned clientSnapshot(ClientStats *out, unsigned max)
+{
+    unsigned n = 0;
+    unsigned i, j;
+
+    pthread_mutex_lock(&lock);
+
+    /* insertion sort on lastSeen; the table is small */
+    for (i = 0; i < CLIENT_TABLE_SIZE; i++) {
+        if (!table[i].used) {
+            continue;
+        }
+        for (j = n; j > 0 &&
+                (int32_t)(table[i].lastSeen - out[j - 1].lastSeen) > 0; j--) {
+            if (j < max) {
+                out[j] = out[j - 1];
+            }
+        }
+        if (j < max) {
+            out[j] = table[i];
+            if (n < max) {
+                n++;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&lock);
+
+    return (n);
+}
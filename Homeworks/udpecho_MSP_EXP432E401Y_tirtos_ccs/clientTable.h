@@ -0,0 +1,51 @@
+/*
+ *    ======== clientTable.h ========
+ *    Per-client UDP counters in a fixed open-addressing hash table keyed by
+ *    IPv4 address and port. No allocation: when the table is full the
+ *    least recently seen client in the probe window is replaced in place.
+ *    Calls are serialised internally, so any task may use them.
+ */
+
+#ifndef CLIENTTABLE_H_
+#define CLIENTTABLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CLIENT_TABLE_SIZE   64      /* power of two */
+#define CLIENT_MAX_PROBE    8
+
+typedef struct {
+    bool     used;
+    uint32_t addr;                  /* network byte order */
+    uint16_t port;                  /* network byte order */
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t firstSeen;             /* ms */
+    uint32_t lastSeen;              /* ms */
+    uint32_t rttCount;              /* RTT samples, us */
+    uint32_t rttLast;
+    uint32_t rttMin;
+    uint32_t rttMax;
+    uint64_t rttSum;
+} ClientStats;
+
+void clientTableInit(void);
+
+/* counts one received datagram from addr:port */
+void clientCountPacket(uint32_t addr, uint16_t port, unsigned bytes,
+                       uint32_t nowMs);
+
+/* adds an RTT sample for a known client; ignored if it has been evicted */
+void clientAddRtt(uint32_t addr, uint16_t port, uint32_t rttUs);
+
+/* copies up to max live entries, most recently seen first; returns count */
+unsigned clientSnapshot(ClientStats *out, unsigned max);
+
+/* clients replaced because the table was full */
+extern uint32_t clientEvictions;
+
+/* milliseconds on the monotonic clock, for the nowMs arguments */
+uint32_t clientNowMs(void);
+
+#endif /* CLIENTTABLE_H_ */
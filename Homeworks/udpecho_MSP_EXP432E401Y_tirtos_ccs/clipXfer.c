@@ -0,0 +1,298 @@
+/*
+ *    ======== clipXfer.c ========
+ *    Clip transfer receiver and packet helpers; see clipXfer.h.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "clipXfer.h"
+#include "rtp.h"
+
+/* one nibble at a time: 64 bytes of table, two lookups per byte */
+static const uint32_t crcNibble[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint16_t get16(const uint8_t *p)
+{
+    return ((uint16_t)((p[0] << 8) | p[1]));
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 |
+        (uint32_t)p[2] << 8 | p[3]);
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static bool haveChunk(const ClipRx *rx, uint32_t chunk)
+{
+    return ((rx->have[chunk / 32] >> (chunk % 32)) & 1);
+}
+
+/*
+ *  ======== writeHeader ========
+ */
+static void writeHeader(uint8_t *p, uint8_t type, uint8_t status,
+    uint16_t session, uint32_t chunk)
+{
+    put32(p, CLIPXFER_MAGIC);
+    p[4] = type;
+    p[5] = status;
+    put16(p + 6, session);
+    put32(p + 8, chunk);
+}
+
+/*
+ *  ======== clipCrc32 ========
+ */
+uint32_t clipCrc32(uint32_t crc, const void *p, size_t n)
+{
+    const uint8_t *b = p;
+
+    crc = ~crc;
+    while (n--) {
+        crc ^= *b++;
+        crc = (crc >> 4) ^ crcNibble[crc & 15];
+        crc = (crc >> 4) ^ crcNibble[crc & 15];
+    }
+
+    return (~crc);
+}
+
+/*
+ *  ======== clipRxInit ========
+ */
+void clipRxInit(ClipRx *rx, uint8_t *arena, uint32_t arenaSize)
+{
+    memset(rx, 0, sizeof(*rx));
+    rx->arena = arena;
+    rx->arenaSize = arenaSize;
+}
+
+/*
+ *  ======== ackPacket ========
+ */
+static unsigned ackPacket(ClipRx *rx, uint16_t session, ClipStatus status,
+    uint8_t *ack)
+{
+    uint32_t sack = 0;
+    unsigned i;
+
+    for (i = 0; i < 32 && rx->next + 1 + i < rx->chunks; i++) {
+        if (haveChunk(rx, rx->next + 1 + i)) {
+            sack |= 1u << i;
+        }
+    }
+    writeHeader(ack, CLIPXFER_ACK, status, session, rx->next);
+    put32(ack + 12, sack);
+    rx->sinceAck = 0;
+    rx->stats.acks++;
+
+    return (CLIPXFER_ACK_LEN);
+}
+
+/*
+ *  ======== startPacket ========
+ */
+static unsigned startPacket(ClipRx *rx, uint16_t session, const uint8_t *p,
+    unsigned len, uint8_t *ack)
+{
+    uint32_t length;
+    uint16_t chunkSize;
+    uint8_t  format;
+    uint32_t chunks;
+
+    if (len < CLIPXFER_START_LEN) {
+        return (0);
+    }
+
+    /* our ACK was lost: say it again, without starting over */
+    if (rx->active && session == rx->session) {
+        return (ackPacket(rx, session, rx->status, ack));
+    }
+
+    length = get32(p + 12);
+    format = p[16];
+    chunkSize = get16(p + 18);
+    chunks = chunkSize ? (length + chunkSize - 1) / chunkSize : 0;
+
+    if (format != RTP_PT_L16 && format != RTP_PT_PCMU &&
+            format != RTP_PT_PCMA && format != RTP_PT_DVI4) {
+        return (ackPacket(rx, session, CLIP_BAD_FORMAT, ack));
+    }
+    if (length == 0 || length > rx->arenaSize ||
+            chunkSize < CLIPXFER_MIN_CHUNK || chunkSize > CLIPXFER_MAX_CHUNK ||
+            chunks > CLIPXFER_MAX_CHUNKS) {
+        return (ackPacket(rx, session, CLIP_BAD_SIZE, ack));
+    }
+
+    rx->active = true;
+    rx->status = CLIP_OK;
+    rx->session = session;
+    rx->format = format;
+    rx->chunkSize = chunkSize;
+    rx->length = length;
+    rx->crc = get32(p + 20);
+    rx->chunks = chunks;
+    rx->next = 0;
+    rx->received = 0;
+    memset(rx->have, 0, sizeof(rx->have));
+    rx->stats.starts++;
+
+    return (ackPacket(rx, session, CLIP_OK, ack));
+}
+
+/*
+ *  ======== dataPacket ========
+ */
+static unsigned dataPacket(ClipRx *rx, uint16_t session, uint32_t chunk,
+    const uint8_t *p, unsigned len, uint8_t *ack)
+{
+    const uint8_t *data = p + CLIPXFER_DATA_HDR_LEN;
+    unsigned       dataLen;
+    uint32_t       next;
+
+    if (!rx->active || session != rx->session) {
+        return (ackPacket(rx, session, CLIP_BAD_SESSION, ack));
+    }
+
+    /* the caller only checked the common header */
+    if (len < CLIPXFER_DATA_HDR_LEN) {
+        rx->stats.badChunks++;
+        return (0);
+    }
+
+    /* every chunk is full length but the last */
+    dataLen = get16(p + 16);
+    if (chunk >= rx->chunks || dataLen != len - CLIPXFER_DATA_HDR_LEN ||
+            dataLen != (chunk + 1 < rx->chunks ? rx->chunkSize :
+                rx->length - chunk * rx->chunkSize) ||
+            clipCrc32(0, data, dataLen) != get32(p + 12)) {
+        rx->stats.badChunks++;
+        return (0);
+    }
+
+    /* a resend whose first copy made it: our ACK was lost or late */
+    if (haveChunk(rx, chunk)) {
+        rx->stats.duplicates++;
+        return (ackPacket(rx, session, rx->status, ack));
+    }
+    if (chunk >= rx->next + CLIPXFER_WINDOW) {
+        rx->stats.outOfWindow++;
+        return (ackPacket(rx, session, rx->status, ack));
+    }
+
+    memcpy(rx->arena + chunk * rx->chunkSize, data, dataLen);
+    rx->have[chunk / 32] |= 1u << (chunk % 32);
+    rx->received++;
+    rx->stats.chunks++;
+
+    next = rx->next;
+    while (rx->next < rx->chunks && haveChunk(rx, rx->next)) {
+        rx->next++;
+    }
+
+    if (rx->received == rx->chunks) {
+        rx->status = clipCrc32(0, rx->arena, rx->length) == rx->crc ?
+            CLIP_DONE : CLIP_BAD_CRC;
+        return (ackPacket(rx, session, rx->status, ack));
+    }
+
+    /* out of order, or it filled a hole: the sender should know now */
+    if (chunk != next || rx->next != chunk + 1 ||
+            ++rx->sinceAck >= CLIPXFER_ACK_EVERY) {
+        return (ackPacket(rx, session, rx->status, ack));
+    }
+
+    return (0);
+}
+
+/*
+ *  ======== clipRxPacket ========
+ */
+unsigned clipRxPacket(ClipRx *rx, const uint8_t *p, unsigned len,
+    uint8_t *ack)
+{
+    uint16_t session;
+
+    if (len < CLIPXFER_HDR_LEN || get32(p) != CLIPXFER_MAGIC) {
+        return (0);
+    }
+    session = get16(p + 6);
+
+    switch (p[4]) {
+        case CLIPXFER_START:
+            return (startPacket(rx, session, p, len, ack));
+        case CLIPXFER_DATA:
+            return (dataPacket(rx, session, get32(p + 8), p, len, ack));
+        default:
+            return (0);
+    }
+}
+
+/*
+ *  ======== clipWriteStart ========
+ */
+unsigned clipWriteStart(uint8_t *p, uint16_t session, uint32_t length,
+    uint8_t format, uint16_t chunkSize, uint32_t crc)
+{
+    writeHeader(p, CLIPXFER_START, 0, session, 0);
+    put32(p + 12, length);
+    p[16] = format;
+    p[17] = 0;
+    put16(p + 18, chunkSize);
+    put32(p + 20, crc);
+
+    return (CLIPXFER_START_LEN);
+}
+
+/*
+ *  ======== clipWriteData ========
+ */
+unsigned clipWriteData(uint8_t *p, uint16_t session, uint32_t chunk,
+    const uint8_t *data, unsigned len)
+{
+    writeHeader(p, CLIPXFER_DATA, 0, session, chunk);
+    put32(p + 12, clipCrc32(0, data, len));
+    put16(p + 16, (uint16_t)len);
+    put16(p + 18, 0);
+    memcpy(p + CLIPXFER_DATA_HDR_LEN, data, len);
+
+    return (CLIPXFER_DATA_HDR_LEN + len);
+}
+
+/*
+ *  ======== clipReadAck ========
+ */
+bool clipReadAck(const uint8_t *p, unsigned len, ClipAck *ack)
+{
+    if (len < CLIPXFER_ACK_LEN || get32(p) != CLIPXFER_MAGIC ||
+            p[4] != CLIPXFER_ACK) {
+        return (false);
+    }
+    ack->status = (ClipStatus)p[5];
+    ack->session = get16(p + 6);
+    ack->next = get32(p + 8);
+    ack->sack = get32(p + 12);
+
+    return (true);
+}
@@ -0,0 +1,115 @@
+/*
+ *    ======== clipXfer.h ========
+ *    Windowed bulk transfer of an audio clip into a RAM arena over UDP.
+ *
+ *    The host sends START (length, format, chunk size, CRC-32 of the
+ *    whole clip), then the clip in numbered DATA chunks, each with its own
+ *    CRC-32. The receiver keeps every chunk inside a window of
+ *    CLIPXFER_WINDOW past the first one it is missing and answers with an
+ *    ACK: that first missing chunk (cumulative) plus a bitmap of the 32
+ *    chunks after it that did arrive (selective), so the sender resends
+ *    only the holes. It ACKs every CLIPXFER_ACK_EVERY chunks in order and
+ *    at once on a gap, a duplicate or the last chunk. A finished clip is
+ *    checked against the START CRC and ACKed DONE or BAD_CRC.
+ *
+ *    All fields are big-endian; every packet starts with the same 12-byte
+ *    header:
+ *        0  magic "CLP1"      4  type        5  status    6  session
+ *        8  chunk (DATA), first missing chunk (ACK), 0 (START)
+ *    START: 12 length (4), 16 format, 17 0, 18 chunk size (2), 20 CRC (4)
+ *    DATA:  12 CRC of the data (4), 16 data length (2), 18 0, 20 data
+ *    ACK:   12 selective bitmap (4), bit i is chunk + 1 + i
+ *
+ *    The format is an RTP payload type (rtp.h); a DVI4 clip is one RTP
+ *    DVI4 payload, the coder state then the samples. Plain C with no NDK
+ *    or driver dependencies; the caller provides the arena and any locking.
+ */
+
+#ifndef CLIPXFER_H_
+#define CLIPXFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CLIPXFER_MAGIC          0x434C5031  /* "CLP1" */
+#define CLIPXFER_HDR_LEN        12
+#define CLIPXFER_START_LEN      24
+#define CLIPXFER_DATA_HDR_LEN   20
+#define CLIPXFER_ACK_LEN        16
+#define CLIPXFER_MIN_CHUNK      256
+#define CLIPXFER_MAX_CHUNK      1440    /* 20 + 1440 fits one Ethernet frame */
+#define CLIPXFER_MAX_CHUNKS     512
+#define CLIPXFER_WINDOW         32      /* chunks kept past the first hole */
+#define CLIPXFER_ACK_EVERY      4
+
+/* packet types */
+#define CLIPXFER_START          1
+#define CLIPXFER_DATA           2
+#define CLIPXFER_ACK            3
+
+/* ACK status */
+typedef enum {
+    CLIP_OK,                    /* transfer going, or START taken */
+    CLIP_DONE,                  /* every chunk in and the clip CRC checks */
+    CLIP_BAD_CRC,               /* every chunk in, but the clip CRC fails */
+    CLIP_BAD_SIZE,              /* START: too long, or bad chunk size */
+    CLIP_BAD_FORMAT,            /* START: not a payload type we play */
+    CLIP_BAD_SESSION            /* DATA for a transfer we are not doing */
+} ClipStatus;
+
+typedef struct {
+    uint32_t starts;
+    uint32_t chunks;            /* stored */
+    uint32_t duplicates;
+    uint32_t outOfWindow;
+    uint32_t badChunks;         /* CRC or length wrong, dropped */
+    uint32_t acks;
+} ClipRxStats;
+
+typedef struct {
+    uint8_t    *arena;
+    uint32_t    arenaSize;
+    bool        active;         /* a START has been taken */
+    ClipStatus  status;
+    uint16_t    session;
+    uint8_t     format;
+    uint16_t    chunkSize;
+    uint32_t    length;
+    uint32_t    crc;            /* of the whole clip, from START */
+    uint32_t    chunks;
+    uint32_t    next;           /* first missing chunk */
+    uint32_t    received;       /* chunks stored */
+    unsigned    sinceAck;
+    uint32_t    have[CLIPXFER_MAX_CHUNKS / 32];
+    ClipRxStats stats;
+} ClipRx;
+
+typedef struct {
+    uint16_t   session;
+    ClipStatus status;
+    uint32_t   next;
+    uint32_t   sack;
+} ClipAck;
+
+/* CRC-32 as in zlib and Ethernet; start with crc 0 */
+uint32_t clipCrc32(uint32_t crc, const void *p, size_t n);
+
+void clipRxInit(ClipRx *rx, uint8_t *arena, uint32_t arenaSize);
+
+/*
+ *  Takes one received datagram. Returns the length of the ACK written to
+ *  ack[CLIPXFER_ACK_LEN] that should go back to the sender, or 0 for none.
+ *  A new START drops whatever the arena held.
+ */
+unsigned clipRxPacket(ClipRx *rx, const uint8_t *p, unsigned len,
+                      uint8_t *ack);
+
+/* the sender's side */
+unsigned clipWriteStart(uint8_t *p, uint16_t session, uint32_t length,
+                        uint8_t format, uint16_t chunkSize, uint32_t crc);
+unsigned clipWriteData(uint8_t *p, uint16_t session, uint32_t chunk,
+                       const uint8_t *data, unsigned len);
+bool     clipReadAck(const uint8_t *p, unsigned len, ClipAck *ack);
+
+#endif /* CLIPXFER_H_ */
@@ -0,0 +1,257 @@
+/*
+ *    ======== clockSync.c ========
+ *    Two-way time transfer servo and packet helpers; see clockSync.h.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "clockSync.h"
+
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+            ((uint32_t)p[2] << 8) | p[3]);
+}
+
+static void put64(uint8_t *p, uint64_t v)
+{
+    put32(p, (uint32_t)(v >> 32));
+    put32(p + 4, (uint32_t)v);
+}
+
+static uint64_t get64(const uint8_t *p)
+{
+    return (((uint64_t)get32(p) << 32) | get32(p + 4));
+}
+
+/*
+ *  ======== offsetAt ========
+ *  Predicted remote - local, in ns, at local time localUs.
+ */
+static int64_t offsetAt(const ClockSync *cs, uint64_t localUs)
+{
+    int64_t dt = (int64_t)(localUs - cs->refUs);
+
+    return (cs->offsetNs + dt * cs->driftPpb / 1000000);
+}
+
+/*
+ *  ======== clampDrift ========
+ */
+static int32_t clampDrift(int64_t ppb)
+{
+    if (ppb > CS_MAX_DRIFT_PPB) {
+        return (CS_MAX_DRIFT_PPB);
+    }
+    if (ppb < -CS_MAX_DRIFT_PPB) {
+        return (-CS_MAX_DRIFT_PPB);
+    }
+
+    return ((int32_t)ppb);
+}
+
+/*
+ *  ======== clockSyncInit ========
+ */
+void clockSyncInit(ClockSync *cs)
+{
+    memset(cs, 0, sizeof(*cs));
+    cs->state = CS_UNSYNC;
+    cs->minDelayUs = UINT32_MAX;
+}
+
+/*
+ *  ======== clockSyncSample ========
+ */
+bool clockSyncSample(ClockSync *cs, uint64_t t1, uint64_t t2, uint64_t t3,
+                     uint64_t t4)
+{
+    int64_t  delay = (int64_t)(t4 - t1) - (int64_t)(t3 - t2);
+    int64_t  measNs;
+    int64_t  err;
+    int64_t  dt;
+    uint64_t local;
+
+    cs->stats.exchanges++;
+
+    /*
+     *  Minimum-delay filter: an exchange that took much longer than the
+     *  best one queued somewhere, most likely on one leg only, and its
+     *  offset is off by half the extra. The minimum ages upwards so a
+     *  route that gets slower for good is taken up eventually.
+     */
+    if (delay < 0 || t4 < t1) {
+        cs->stats.rejected++;
+        return (false);
+    }
+    if (cs->minDelayUs != UINT32_MAX) {
+        cs->minDelayUs += CS_DELAY_AGE_US;
+    }
+    if ((uint64_t)delay < cs->minDelayUs) {
+        cs->minDelayUs = (uint32_t)delay;
+    }
+    cs->stats.lastDelayUs = (uint32_t)delay;
+    if ((uint64_t)delay > (uint64_t)cs->minDelayUs + CS_DELAY_SLACK_US) {
+        cs->stats.rejected++;
+        return (false);
+    }
+
+    /* the offset holds at the midpoint of the exchange */
+    measNs = ((int64_t)(t2 - t1) + (int64_t)(t3 - t4)) * 1000 / 2;
+    local = t1 + (t4 - t1) / 2;
+
+    switch (cs->state) {
+        case CS_UNSYNC:
+            cs->offsetNs = measNs;
+            cs->refUs = local;
+            cs->freqOffsetNs = measNs;
+            cs->freqRefUs = local;
+            cs->freqCount = 1;
+            cs->state = CS_FREQ;
+            cs->stats.steps++;
+            return (true);
+
+        case CS_FREQ:
+            /* track the offset directly until the drift is measurable */
+            cs->offsetNs = measNs;
+            cs->refUs = local;
+            if (++cs->freqCount < CS_FREQ_SAMPLES ||
+                    local == cs->freqRefUs) {
+                return (true);
+            }
+            cs->driftPpb = clampDrift((measNs - cs->freqOffsetNs) * 1000000 /
+                    (int64_t)(local - cs->freqRefUs));
+            cs->state = CS_LOCKED;
+            return (true);
+
+        case CS_LOCKED:
+            break;
+    }
+
+    err = measNs - offsetAt(cs, local);
+    cs->stats.lastErrorNs = (int32_t)(err > INT32_MAX ? INT32_MAX :
+            err < INT32_MIN ? INT32_MIN : err);
+
+    if (err > CS_STEP_US * 1000 || err < -CS_STEP_US * 1000) {
+        /* one wild sample is ignored; a run of them means we lost it */
+        if (++cs->bigErrors < CS_STEP_COUNT) {
+            cs->stats.rejected++;
+            return (false);
+        }
+        cs->offsetNs = measNs;
+        cs->refUs = local;
+        cs->bigErrors = 0;
+        cs->stats.steps++;
+        return (true);
+    }
+    cs->bigErrors = 0;
+
+    /* PI servo: slew the offset by a fraction of the error, trim drift */
+    dt = (int64_t)(local - cs->refUs);
+    cs->offsetNs = offsetAt(cs, local) + err / (1 << CS_KP_SHIFT);
+    if (dt > 0) {
+        cs->driftPpb = clampDrift(cs->driftPpb +
+                err * 1000000 / dt / (1 << CS_KI_SHIFT));
+    }
+    cs->refUs = local;
+
+    return (true);
+}
+
+/*
+ *  ======== clockSyncLocked ========
+ */
+bool clockSyncLocked(const ClockSync *cs)
+{
+    return (cs->state == CS_LOCKED);
+}
+
+/*
+ *  ======== clockSyncToRemote ========
+ */
+uint64_t clockSyncToRemote(const ClockSync *cs, uint64_t localUs)
+{
+    if (cs->state == CS_UNSYNC) {
+        return (localUs);
+    }
+
+    return (localUs + offsetAt(cs, localUs) / 1000);
+}
+
+/*
+ *  ======== clockSyncToLocal ========
+ *  The offset barely moves over its own size, so one refinement is exact
+ *  to well below a microsecond.
+ */
+uint64_t clockSyncToLocal(const ClockSync *cs, uint64_t remoteUs)
+{
+    uint64_t localUs;
+
+    if (cs->state == CS_UNSYNC) {
+        return (remoteUs);
+    }
+    localUs = remoteUs - offsetAt(cs, remoteUs) / 1000;
+
+    return (remoteUs - offsetAt(cs, localUs) / 1000);
+}
+
+/*
+ *  ======== clockSyncRequest ========
+ */
+unsigned clockSyncRequest(uint8_t *p, uint32_t seq, uint64_t t1)
+{
+    memset(p, 0, CLOCKSYNC_PKT_LEN);
+    put32(p, CLOCKSYNC_MAGIC);
+    put32(p + 4, seq);
+    put64(p + 8, t1);
+
+    return (CLOCKSYNC_PKT_LEN);
+}
+
+/*
+ *  ======== clockSyncReflect ========
+ */
+unsigned clockSyncReflect(uint8_t *p, unsigned len, uint64_t t2)
+{
+    if (len < CLOCKSYNC_PKT_LEN || get32(p) != CLOCKSYNC_MAGIC) {
+        return (0);
+    }
+    put64(p + 16, t2);
+
+    return (CLOCKSYNC_PKT_LEN);
+}
+
+/*
+ *  ======== clockSyncStampTx ========
+ */
+void clockSyncStampTx(uint8_t *p, uint64_t t3)
+{
+    put64(p + 24, t3);
+}
+
+/*
+ *  ======== clockSyncParse ========
+ */
+bool clockSyncParse(const uint8_t *p, unsigned len, uint32_t *seq,
+                    uint64_t *t1, uint64_t *t2, uint64_t *t3)
+{
+    if (len < CLOCKSYNC_PKT_LEN || get32(p) != CLOCKSYNC_MAGIC) {
+        return (false);
+    }
+    *seq = get32(p + 4);
+    *t1 = get64(p + 8);
+    *t2 = get64(p + 16);
+    *t3 = get64(p + 24);
+
+    return (true);
+}
@@ -0,0 +1,98 @@
+/*
+ *    ======== clockSync.h ========
+ *    PTP-lite time transfer between boards over UDP.
+ *
+ *    A client stamps a request with its local time t1; the server stamps
+ *    its receive and transmit times t2 and t3 into it and sends it back;
+ *    the client stamps the arrival t4. From each exchange
+ *        offset = ((t2 - t1) + (t3 - t4)) / 2
+ *        delay  = (t4 - t1) - (t3 - t2)
+ *    assuming a symmetric path. A minimum-delay filter throws away
+ *    exchanges that queued on the way, and a PI servo turns the rest into
+ *    an offset and a drift (ppb) estimate, so local time can be mapped to
+ *    the server's timeline between exchanges. All times are microseconds.
+ *    Plain C with no NDK or driver dependencies; the caller provides
+ *    locking.
+ *
+ *    Wire format, big-endian:
+ *        0   magic "CSY1"
+ *        4   sequence number
+ *        8   t1, client transmit, 64-bit
+ *        16  t2, server receive, 64-bit
+ *        24  t3, server transmit, 64-bit
+ */
+
+#ifndef CLOCKSYNC_H_
+#define CLOCKSYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CLOCKSYNC_PORT          1002
+#define CLOCKSYNC_MAGIC         0x43535931u     /* "CSY1" */
+#define CLOCKSYNC_PKT_LEN       32
+
+#define CS_DELAY_SLACK_US       100     /* accept delay <= minimum + this */
+#define CS_DELAY_AGE_US         2       /* minimum creeps up per exchange */
+#define CS_FREQ_SAMPLES         4       /* exchanges before the first drift */
+#define CS_STEP_US              1000    /* bigger errors step the clock */
+#define CS_STEP_COUNT           3       /* ...after this many in a row */
+#define CS_KP_SHIFT             2       /* offset gain 1/4 */
+#define CS_KI_SHIFT             6       /* drift gain 1/64 */
+#define CS_MAX_DRIFT_PPB        500000
+
+typedef enum {
+    CS_UNSYNC,                  /* no exchange yet */
+    CS_FREQ,                    /* offset known, measuring drift */
+    CS_LOCKED                   /* servo running */
+} ClockSyncState;
+
+typedef struct {
+    uint32_t exchanges;
+    uint32_t rejected;          /* failed the delay filter */
+    uint32_t steps;             /* offset stepped instead of slewed */
+    uint32_t lastDelayUs;
+    int32_t  lastErrorNs;       /* measured - predicted offset */
+} ClockSyncStats;
+
+typedef struct {
+    ClockSyncState state;
+    int64_t  offsetNs;          /* remote - local at refUs */
+    int32_t  driftPpb;          /* remote rate - local rate */
+    uint64_t refUs;             /* local time of the last update */
+    uint32_t minDelayUs;
+    unsigned freqCount;
+    unsigned bigErrors;
+    int64_t  freqOffsetNs;      /* first sample of the drift measurement */
+    uint64_t freqRefUs;
+    ClockSyncStats stats;
+} ClockSync;
+
+void clockSyncInit(ClockSync *cs);
+
+/*
+ *  Feeds one completed exchange (t1, t4 local; t2, t3 remote). Returns
+ *  false if the exchange was rejected.
+ */
+bool clockSyncSample(ClockSync *cs, uint64_t t1, uint64_t t2, uint64_t t3,
+                     uint64_t t4);
+
+bool clockSyncLocked(const ClockSync *cs);
+
+/* maps between local and remote time using the current estimate */
+uint64_t clockSyncToRemote(const ClockSync *cs, uint64_t localUs);
+uint64_t clockSyncToLocal(const ClockSync *cs, uint64_t remoteUs);
+
+/*
+ *  Packet helpers. clockSyncRequest() writes a CLOCKSYNC_PKT_LEN request.
+ *  clockSyncReflect() turns a received request into the reply in place
+ *  and returns its length, or 0 if it is not a request; t3 is written by
+ *  clockSyncStampTx() just before sending. clockSyncParse() reads a reply.
+ */
+unsigned clockSyncRequest(uint8_t *p, uint32_t seq, uint64_t t1);
+unsigned clockSyncReflect(uint8_t *p, unsigned len, uint64_t t2);
+void     clockSyncStampTx(uint8_t *p, uint64_t t3);
+bool     clockSyncParse(const uint8_t *p, unsigned len, uint32_t *seq,
+                        uint64_t *t1, uint64_t *t2, uint64_t *t3);
+
+#endif /* CLOCKSYNC_H_ */
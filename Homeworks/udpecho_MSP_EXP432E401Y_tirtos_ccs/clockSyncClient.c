@@ -0,0 +1,213 @@
+/*
+ *    ======== clockSyncClient.c ========
+ *    Runs one exchange with CLOCKSYNC_MASTER every CLOCKSYNC_PERIOD_MS and
+ *    feeds the servo (clockSync.c). Readers on other tasks go through the
+ *    mutex, since the 64-bit state cannot be read atomically.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <pthread.h>
+/* BSD support */
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netdb.h>
+
+#include <ti/display/Display.h>
+
+#include "clockSync.h"
+#include "clockSyncClient.h"
+#include "netStats.h"
+#include "udpPace.h"
+#include "usClock.h"
+
+#define MAXPORTLEN    6
+
+extern Display_Handle display;
+
+extern void fdOpenSession();
+extern void fdCloseSession();
+extern void *TaskSelf();
+
+static ClockSync       servo;
+static pthread_mutex_t servoLock;
+
+/*
+ *  ======== clockSyncClientInit ========
+ */
+void clockSyncClientInit(void)
+{
+    pthread_mutexattr_t attrs;
+
+    pthread_mutexattr_init(&attrs);
+    pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&servoLock, &attrs);
+    pthread_mutexattr_destroy(&attrs);
+
+    clockSyncInit(&servo);
+}
+
+/*
+ *  ======== clockSyncNow ========
+ *  Before the first exchange completes this is just the local clock.
+ */
+uint64_t clockSyncNow(void)
+{
+    uint64_t now;
+
+    pthread_mutex_lock(&servoLock);
+    now = clockSyncToRemote(&servo, usClockNow());
+    pthread_mutex_unlock(&servoLock);
+
+    return (now);
+}
+
+/*
+ *  ======== clockSyncLocalTime ========
+ */
+uint64_t clockSyncLocalTime(uint64_t masterUs)
+{
+    uint64_t local;
+
+    pthread_mutex_lock(&servoLock);
+    local = clockSyncToLocal(&servo, masterUs);
+    pthread_mutex_unlock(&servoLock);
+
+    return (local);
+}
+
+/*
+ *  ======== clockSyncSnapshot ========
+ */
+void clockSyncSnapshot(ClockSync *out)
+{
+    pthread_mutex_lock(&servoLock);
+    *out = servo;
+    pthread_mutex_unlock(&servoLock);
+}
+
+/*
+ *  ======== sleepMs ========
+ *  usleep() only takes less than a second.
+ */
+static void sleepMs(unsigned ms)
+{
+    struct timespec ts;
+
+    ts.tv_sec  = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+/*
+ *  ======== resolveMaster ========
+ */
+static int resolveMaster(struct sockaddr_in *dest)
+{
+    struct addrinfo  hints;
+    struct addrinfo *res;
+    char             portNumber[MAXPORTLEN];
+    int              status;
+
+    sprintf(portNumber, "%d", CLOCKSYNC_PORT);
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    status = getaddrinfo(CLOCKSYNC_MASTER, portNumber, &hints, &res);
+    if (status != 0) {
+        Display_printf(display, 0, 0,
+            "clockSync: getaddrinfo(%s) failed: %s\n", CLOCKSYNC_MASTER,
+            gai_strerror(status));
+        return (-1);
+    }
+    memcpy(dest, res->ai_addr, sizeof(*dest));
+    freeaddrinfo(res);
+
+    return (0);
+}
+
+/*
+ *  ======== clockSyncFxn ========
+ */
+void *clockSyncFxn(void *arg0)
+{
+    int                sock = -1;
+    int                bytesRcvd;
+    int                bytesSent;
+    uint32_t           seq = 0;
+    struct sockaddr_in master;
+    struct timeval     timeout;
+    static uint8_t     packet[CLOCKSYNC_PKT_LEN];
+
+    fdOpenSession(TaskSelf());
+
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == -1) {
+        Display_printf(display, 0, 0, "clockSync: socket not created.\n");
+        goto shutdown;
+    }
+    if (resolveMaster(&master) != 0) {
+        goto shutdown;
+    }
+
+    timeout.tv_sec  = 0;
+    timeout.tv_usec = CLOCKSYNC_TIMEOUT_MS * 1000;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    Display_printf(display, 0, 0, "clockSync: following %s:%d\n",
+        CLOCKSYNC_MASTER, CLOCKSYNC_PORT);
+
+    for (;;) {
+        uint64_t t1, t2, t3, t4, echoT1;
+        uint32_t echoSeq;
+
+        seq++;
+        t1 = usClockNow();
+        clockSyncRequest(packet, seq, t1);
+        if (!udpPace(CLOCKSYNC_PKT_LEN, PACE_DROP)) {
+            sleepMs(CLOCKSYNC_PERIOD_MS);
+            continue;
+        }
+        bytesSent = sendto(sock, packet, CLOCKSYNC_PKT_LEN, 0,
+                (struct sockaddr *)&master, sizeof(master));
+        netCountTx(NETTASK_CLOCKSYNC, NETSOCK_SYNC_CLIENT, bytesSent,
+            CLOCKSYNC_PKT_LEN);
+        if (bytesSent < 0) {
+            sleepMs(CLOCKSYNC_PERIOD_MS);
+            continue;
+        }
+
+        /* skip late replies to earlier requests until ours or a timeout */
+        do {
+            bytesRcvd = recvfrom(sock, packet, sizeof(packet), 0, NULL, NULL);
+            t4 = usClockNow();
+            netCountRx(NETTASK_CLOCKSYNC, NETSOCK_SYNC_CLIENT, bytesRcvd);
+        } while (bytesRcvd > 0 &&
+                (!clockSyncParse(packet, bytesRcvd, &echoSeq, &echoT1, &t2,
+                    &t3) || echoSeq != seq || echoT1 != t1));
+
+        if (bytesRcvd > 0) {
+            pthread_mutex_lock(&servoLock);
+            clockSyncSample(&servo, t1, t2, t3, t4);
+            pthread_mutex_unlock(&servoLock);
+        }
+
+        sleepMs(CLOCKSYNC_PERIOD_MS);
+    }
+
+shutdown:
+    if (sock != -1) {
+        close(sock);
+    }
+
+    fdCloseSession(TaskSelf());
+
+    return (NULL);
+}
@@ -0,0 +1,36 @@
+/*
+ *    ======== clockSyncClient.h ========
+ *    Board side of the clock sync: follows a master board's usClock so
+ *    playout and tickers can be scheduled on a common timeline. Every
+ *    board answers exchanges on CLOCKSYNC_PORT (udpEcho.c); only boards
+ *    with a CLOCKSYNC_MASTER run the client task.
+ */
+
+#ifndef CLOCKSYNCCLIENT_H_
+#define CLOCKSYNCCLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "clockSync.h"
+
+#define CLOCKSYNC_MASTER        ""      /* empty: this board is a master */
+#define CLOCKSYNC_PERIOD_MS     1000
+#define CLOCKSYNC_TIMEOUT_MS    200
+
+/* creates the servo lock; call once before any task uses the servo */
+void clockSyncClientInit(void);
+
+/* local usClock time mapped onto the master's timeline */
+uint64_t clockSyncNow(void);
+
+/* master time of a future event mapped back onto the local usClock */
+uint64_t clockSyncLocalTime(uint64_t masterUs);
+
+/* consistent copy of the servo state for reporting */
+void clockSyncSnapshot(ClockSync *out);
+
+/* pthread entry; arg0 is unused */
+void *clockSyncFxn(void *arg0);
+
+#endif /* CLOCKSYNCCLIENT_H_ */
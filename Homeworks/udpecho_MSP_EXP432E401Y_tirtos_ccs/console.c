@@ -0,0 +1,103 @@
+/*
+ *    ======== console.c ========
+ *    Serial console task. Each completed line runs through shellExecute()
+ *    and its output goes out in one UART write.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <pthread.h>
+
+#include <ti/drivers/UART.h>
+#include <ti/display/Display.h>
+
+#include "console.h"
+#include "lineEdit.h"
+#include "shell.h"
+
+extern Display_Handle display;
+
+extern void fdOpenSession();
+extern void *TaskSelf();
+
+static const char banner[] = "\r\n*** MSP432 Command Shell Ready ***\r\n"
+    "Type -help for a list of commands.\r\n\r\n";
+
+static UART_Handle     uart;
+static pthread_mutex_t writeLock;
+
+/*
+ *  ======== consoleWrite ========
+ */
+void consoleWrite(const char *s, size_t n)
+{
+    pthread_mutex_lock(&writeLock);
+    if (uart != NULL) {
+        UART_write(uart, s, n);
+    }
+    pthread_mutex_unlock(&writeLock);
+}
+
+/*
+ *  ======== uartWrite ========
+ */
+static void uartWrite(void *ctx, const char *s, size_t n)
+{
+    consoleWrite(s, n);
+}
+
+/*
+ *  ======== consoleInit ========
+ */
+void consoleInit(void)
+{
+    pthread_mutexattr_t attrs;
+
+    pthread_mutexattr_init(&attrs);
+    pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&writeLock, &attrs);
+    pthread_mutexattr_destroy(&attrs);
+}
+
+/*
+ *  ======== consoleFxn ========
+ */
+void *consoleFxn(void *arg0)
+{
+    static LineEdit ed;
+    static char     response[CONSOLE_RESPONSE];
+    UART_Params     params;
+    size_t          n;
+    char            ch;
+
+    /* commands such as -mcast act on sockets from this task */
+    fdOpenSession(TaskSelf());
+
+    UART_init();
+    UART_Params_init(&params);
+    params.baudRate       = CONSOLE_BAUD;
+    params.readDataMode   = UART_DATA_BINARY;
+    params.writeDataMode  = UART_DATA_BINARY;
+    params.readReturnMode = UART_RETURN_FULL;
+    params.readEcho       = UART_ECHO_OFF;
+    uart = UART_open(CONSOLE_UART, &params);
+    if (uart == NULL) {
+        Display_printf(display, 0, 0, "Error: console UART not opened.\n");
+        return (NULL);
+    }
+
+    lineEditInit(&ed, uartWrite, NULL);
+    consoleWrite(banner, sizeof(banner) - 1);
+    lineEditPrompt(&ed);
+
+    for (;;) {
+        /* blocks; this is the lowest priority task */
+        if (UART_read(uart, &ch, 1) != 1 || !lineEditFeed(&ed, ch)) {
+            continue;
+        }
+        n = shellExecute(ed.buf, response, sizeof(response));
+        consoleWrite(response, n);
+        lineEditPrompt(&ed);
+    }
+}
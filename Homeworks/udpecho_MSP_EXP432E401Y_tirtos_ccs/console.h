@@ -0,0 +1,34 @@
+/*
+ *    ======== console.h ========
+ *    Serial console: the line editor (lineEdit.h) in front of the
+ *    same command set as the UDP control port (shellExecute()).
+ */
+
+#ifndef CONSOLE_H_
+#define CONSOLE_H_
+
+#include <stddef.h>
+
+#include "ti_drivers_config.h"
+
+/*
+ *  The XDS110 UART (the USB port), where the uartecho shell was; the
+ *  Display log moved to UART7 (boosterpack.4 TX, boosterpack.3 RX).
+ */
+#define CONSOLE_UART        CONFIG_UART_0
+#define CONSOLE_BAUD        115200
+#define CONSOLE_RESPONSE    2048    /* output of one command line */
+
+/* creates the write lock; before consoleFxn or any consoleWrite() */
+void consoleInit(void);
+
+/*
+ *  Writes n bytes out of the console port, between the console's own
+ *  writes rather than into them. Dropped until the port is open.
+ */
+void consoleWrite(const char *s, size_t n);
+
+/* pthread entry; arg0 is unused */
+void *consoleFxn(void *arg0);
+
+#endif /* CONSOLE_H_ */
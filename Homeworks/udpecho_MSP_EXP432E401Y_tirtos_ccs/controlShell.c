@@ -0,0 +1,786 @@
+/*
+ *    ======== controlShell.c ========
+ *    Commands served on the UDP control port and the serial console.
+ *    Syntax follows the UART shell: a leading '-', then space separated
+ *    arguments.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <arpa/inet.h>
+#include <pthread.h>
+
+#include "appTasks.h"
+#include "audioClip.h"
+#include "audioPlayback.h"
+#include "audioRx.h"
+#include "audioTx.h"
+#include "boardShell.h"
+#include "clientTable.h"
+#include "clockSyncClient.h"
+#include "echoCore.h"
+#include "mixer.h"
+#include "netStats.h"
+#include "shell.h"
+#include "udpEcho.h"
+#include "udpGen.h"
+#include "udpPace.h"
+#include "usClock.h"
+
+#define CONTROL_MAX_CLIENTS 16
+#define MAX_CMD_LEN         128
+#define MIXBENCH_BLOCKS     2000
+#define MAX_TASKS           12
+#define SHELL_MAX_DEPTH     4       /* -if and -script lines inside lines */
+
+uint32_t shellUnknownCommands;
+uint32_t shellLongLines;
+
+static pthread_mutex_t shellLock;
+static unsigned        depth;
+static bool            mayWait;        /* false for the UDP server */
+
+static struct {
+    char  *buf;
+    size_t len, cap;
+    bool   truncated;
+} resp;
+
+/*
+ *  ======== vput ========
+ *  printf into the response, noting when it runs out of room.
+ */
+static int vput(const char *fmt, va_list ap)
+{
+    size_t room = resp.cap - resp.len;
+    int    n;
+
+    n = vsnprintf(resp.buf + resp.len, room, fmt, ap);
+    if (n < 0) {
+        return (n);
+    }
+    if ((size_t)n >= room) {
+        /* vsnprintf kept room - 1 characters plus a NUL we do not send */
+        resp.len = resp.cap - 1;
+        resp.truncated = true;
+        return (n);
+    }
+    resp.len += n;
+
+    return (n);
+}
+
+/*
+ *  ======== put ========
+ */
+static void put(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vput(fmt, ap);
+    va_end(ap);
+}
+
+/*
+ *  ======== shellPut ========
+ */
+void shellPut(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vput(fmt, ap);
+    va_end(ap);
+}
+
+/*
+ *  ======== putPrn ========
+ *  put() with the printf signature the NDK's reporting calls take.
+ */
+static int putPrn(const char *fmt, ...)
+{
+    va_list ap;
+    int     n;
+
+    va_start(ap, fmt);
+    n = vput(fmt, ap);
+    va_end(ap);
+
+    return (n);
+}
+
+/*
+ *  ======== cmdClients ========
+ */
+static void cmdClients(void)
+{
+    static ClientStats clients[CONTROL_MAX_CLIENTS];
+    uint32_t now = clientNowMs();
+    unsigned n, i;
+
+    n = clientSnapshot(clients, CONTROL_MAX_CLIENTS);
+    put("%u clients, %u evicted\r\n", n, clientEvictions);
+    for (i = 0; i < n; i++) {
+        const ClientStats *c = &clients[i];
+        uint32_t ip = ntohl(c->addr);
+
+        put("%u.%u.%u.%u:%u pkts %u bytes %u age %ums rtt %u/%u/%uus\r\n",
+            (ip >> 24) & 0xFF, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF,
+            ntohs(c->port), c->packets, c->bytes, now - c->lastSeen,
+            c->rttCount ? c->rttMin : 0,
+            c->rttCount ? (uint32_t)(c->rttSum / c->rttCount) : 0,
+            c->rttMax);
+    }
+}
+
+/*
+ *  ======== cmdStats ========
+ */
+static void cmdStats(void)
+{
+    MixStats mix;
+    unsigned streams;
+
+    put("echo  pkts %u bytes %u errors %u pps %u\r\n", echoStats.packets,
+        echoStats.bytes, echoStats.errors,
+        echoCorePps(&echoStats, (uint32_t)(usClockNow() / 1000000)));
+    put("tx    pkts %u bytes %u errors %u overruns %u\r\n",
+        audioTxStats.packets, audioTxStats.bytes, audioTxStats.sendErrors,
+        audioTxStats.overruns);
+    put("rx    pkts %u bytes %u bad %u\r\n", audioRxStats.packets,
+        audioRxStats.bytes, audioRxStats.badPackets);
+    pthread_mutex_lock(&audioRxLock);
+    mix = audioRxMixer.stats;
+    streams = mixStreams(&audioRxMixer);
+    pthread_mutex_unlock(&audioRxLock);
+    put("mix   streams %u joined %u expired %u rejected %u local %u\r\n",
+        streams, mix.joined, mix.expired, mix.rejected, mix.local);
+    put("fec   k %u tx parity %u rx parity %u recovered %u unrecoverable %u\r\n",
+        audioTxFecK(), audioTxStats.fecPackets, audioRxStats.fecPackets,
+        audioRxStats.fecRecovered, audioRxStats.fecUnrecoverable);
+}
+
+/*
+ *  ======== cmdNet ========
+ *  Interface, per-socket counters summed over the tasks that use each
+ *  socket, and the NDK's memory pools.
+ */
+static void cmdNet(void)
+{
+    uint32_t    ip = ntohl(netInterface.addr);
+    uint32_t    kbps, burst;
+    NetCounters c;
+    unsigned    s;
+
+    put("if-%u  %s %u.%u.%u.%u, %u changes, last %us ago\r\n",
+        netInterface.ifIdx, netInterface.up ? "up" : "down",
+        (ip >> 24) & 0xFF, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF,
+        netInterface.changes, (clientNowMs() - netInterface.sinceMs) / 1000);
+    udpPaceConfig(&kbps, &burst);
+    put("echo  %u pps, errors %u (%u paced out)\r\n",
+        echoCorePps(&echoStats, (uint32_t)(usClockNow() / 1000000)),
+        echoStats.errors, echoStats.paced);
+    put("pace  %s, best effort dropped %u, media timed out %u\r\n",
+        kbps ? "on" : "off", udpPaceStats.dropped, udpPaceStats.timedOut);
+    for (s = 0; s < NETSOCK_NUM; s++) {
+        netStatsSocket((NetSock)s, &c);
+        if (c.rxPackets == 0 && c.txPackets == 0 && c.errors == 0) {
+            continue;
+        }
+        put("%-11s rx %u/%u tx %u/%u errors %u\r\n", netSockNames[s],
+            c.rxPackets, c.rxBytes, c.txPackets, c.txBytes, c.errors);
+    }
+    netPoolReport(putPrn);
+}
+
+/*
+ *  ======== cmdTasks ========
+ *  Priority and stack use of each task, and the audio deadlines they
+ *  are arranged around: a capture block the sender did not take in time
+ *  is an overrun, a block the DAC played as silence with no mixed frame
+ *  queued an underrun.
+ */
+static void cmdTasks(void)
+{
+    static TaskInfo tasks[MAX_TASKS];
+    unsigned n, i;
+
+    n = appTasksInfo(tasks, MAX_TASKS);
+    put("task       pri stack  peak\r\n");
+    for (i = 0; i < n; i++) {
+        put("%-10s %3d %5u %5u\r\n", tasks[i].name, tasks[i].priority,
+            (unsigned)tasks[i].stackSize, (unsigned)tasks[i].stackPeak);
+    }
+    put("audio capture overruns %u playback underruns %u\r\n",
+        audioCaptureOverruns, audioPlaybackUnderruns);
+}
+
+/*
+ *  ======== cmdSync ========
+ */
+static void cmdSync(void)
+{
+    static const char *state[] = { "unsynced", "measuring drift", "locked" };
+    static ClockSync cs;
+
+    clockSyncSnapshot(&cs);
+    if (CLOCKSYNC_MASTER[0] == '\0') {
+        put("sync  master\r\n");
+        return;
+    }
+    put("sync  %s to %s, offset %d us drift %d ppb\r\n", state[cs.state],
+        CLOCKSYNC_MASTER, (int)(cs.offsetNs / 1000), (int)cs.driftPpb);
+    put("      exchanges %u rejected %u steps %u delay %u us err %d ns\r\n",
+        cs.stats.exchanges, cs.stats.rejected, cs.stats.steps,
+        cs.stats.lastDelayUs, (int)cs.stats.lastErrorNs);
+}
+
+/*
+ *  ======== cmdMcast ========
+ *  -mcast [join <group> | leave]; no argument shows the group.
+ */
+static void cmdMcast(char *op, char *group)
+{
+    if (op != NULL && !strcmp(op, "join") && group != NULL) {
+        if (!udpAudioJoin(group)) {
+            put("?? cannot join %s\r\n", group);
+            return;
+        }
+    }
+    else if (op != NULL && !strcmp(op, "leave")) {
+        udpAudioLeave();
+    }
+    else if (op != NULL) {
+        put("?? -mcast [join <group> | leave]\r\n");
+        return;
+    }
+    put("audio group %s\r\n", udpAudioGroup() ? udpAudioGroup() : "none");
+}
+
+/*
+ *  ======== cmdAdapt ========
+ *  -adapt [on|off]; no argument shows the state.
+ */
+static void cmdAdapt(char *arg)
+{
+    const AdaptStats *st = &audioTxAdapt.stats;
+    const AdaptMode  *m = audioAdaptMode(&audioTxAdapt);
+
+    if (arg != NULL) {
+        if (!strcmp(arg, "on")) {
+            audioTxSetAdapt(true);
+        }
+        else if (!strcmp(arg, "off")) {
+            audioTxSetAdapt(false);
+        }
+        else {
+            put("?? -adapt [on|off]\r\n");
+            return;
+        }
+    }
+    put("adapt %s, mode pt %u x %u frames; up %u down %u\r\n",
+        audioTxAdaptEnabled() ? "on" : "off", m->pt, m->framesPerPacket,
+        st->up, st->down);
+    put("      reports %u loss %u/1000 jitter %u us rtt %u us\r\n",
+        st->reports, st->lastLoss, st->lastJitterUs, st->lastRttUs);
+}
+
+/*
+ *  ======== cmdFec ========
+ *  -fec [k]; no argument shows the setting.
+ */
+static void cmdFec(char *arg)
+{
+    if (arg != NULL && !audioTxSetFec(strtoul(arg, NULL, 10))) {
+        put("?? fec k is 0 (off), 2, 4, 8 or 16\r\n");
+        return;
+    }
+    put("fec k %u\r\n", audioTxFecK());
+}
+
+/*
+ *  ======== cmdTx ========
+ *  -tx <host> <port> <frames per packet> [pcmu|pcma|l16|dvi4] points the
+ *  RTP sender somewhere else, a multicast group included; no argument
+ *  shows where it sends.
+ */
+static void cmdTx(char *host)
+{
+    static const struct {
+        const char *name;
+        uint8_t     pt;
+    } formats[] = {
+        { "pcmu", RTP_PT_PCMU }, { "pcma", RTP_PT_PCMA },
+        { "l16",  RTP_PT_L16 },  { "dvi4", RTP_PT_DVI4 },
+    };
+    char     dest[AUDIOTX_HOSTLEN];
+    uint16_t port;
+    unsigned fpp, i;
+    uint8_t  pt;
+
+    if (host != NULL) {
+        char *portArg = strtok(NULL, " \t");
+        char *fppArg = strtok(NULL, " \t");
+        char *format = strtok(NULL, " \t");
+
+        i = 0;
+        if (format != NULL) {
+            while (i < sizeof(formats) / sizeof(formats[0]) &&
+                    strcmp(format, formats[i].name)) {
+                i++;
+            }
+        }
+        port = portArg ? (uint16_t)strtoul(portArg, NULL, 10) : 0;
+        if (port == 0 || fppArg == NULL ||
+                i == sizeof(formats) / sizeof(formats[0]) ||
+                !audioTxConfigure(host, port, strtoul(fppArg, NULL, 10))) {
+            put("?? -tx host port fpp(1-%u) [pcmu|pcma|l16|dvi4]\r\n",
+                AUDIOTX_MAX_FPP);
+            return;
+        }
+        if (format != NULL) {
+            audioTxSetPayloadType(formats[i].pt);
+        }
+    }
+
+    audioTxConfig(dest, &port, &fpp, &pt);
+    i = 0;
+    while (i < sizeof(formats) / sizeof(formats[0]) && formats[i].pt != pt) {
+        i++;
+    }
+    put("tx    %s:%u, %u frames/packet, %s\r\n", dest, port, fpp,
+        i < sizeof(formats) / sizeof(formats[0]) ? formats[i].name : "?");
+}
+
+/*
+ *  ======== cmdPace ========
+ *  -pace [off | <kbit/s> [burst bytes]]; no argument shows the setting.
+ */
+static void cmdPace(char *arg, char *burstArg)
+{
+    uint32_t kbps, burst;
+
+    udpPaceConfig(&kbps, &burst);
+    if (arg != NULL) {
+        kbps = strcmp(arg, "off") ? strtoul(arg, NULL, 10) : 0;
+        if (burstArg != NULL) {
+            burst = strtoul(burstArg, NULL, 10);
+        }
+        udpPaceConfigure(kbps, burst);
+        udpPaceConfig(&kbps, &burst);
+    }
+    if (kbps == 0) {
+        put("pace  off\r\n");
+    }
+    else {
+        put("pace  %u kbit/s burst %u reserve %u\r\n", kbps, burst,
+            UDPPACE_RESERVE);
+    }
+    put("      passed %u deferred %u (%u ms) dropped %u timed out %u\r\n",
+        udpPaceStats.passed, udpPaceStats.deferred,
+        udpPaceStats.deferredUs / 1000, udpPaceStats.dropped,
+        udpPaceStats.timedOut);
+}
+
+/*
+ *  ======== cmdUdpGen ========
+ *  -udpgen <host> <port> <size> <rate> <count> starts a run, -udpgen stop
+ *  ends it early, and -udpgen alone shows the current or last run.
+ */
+static void cmdUdpGen(char *host)
+{
+    UdpGenStatus st;
+    uint64_t     us;
+    uint32_t     ip, pps;
+
+    if (host != NULL && !strcmp(host, "stop")) {
+        udpGenStop();
+    }
+    else if (host != NULL) {
+        char *port = strtok(NULL, " \t");
+        char *size = strtok(NULL, " \t");
+        char *rate = strtok(NULL, " \t");
+        char *count = strtok(NULL, " \t");
+
+        if (count == NULL || !udpGenStart(host, strtoul(port, NULL, 10),
+                strtoul(size, NULL, 10), strtoul(rate, NULL, 10),
+                strtoul(count, NULL, 10))) {
+            put("?? -udpgen host port size(%u-%u) rate(0-%u/s) count, "
+                "one run at a time\r\n", UDPGEN_HDR_LEN, UDPGEN_MAX_SIZE,
+                UDPGEN_MAX_RATE);
+            return;
+        }
+    }
+
+    udpGenStatus(&st);
+    if (st.count == 0) {
+        put("udpgen idle\r\n");
+        return;
+    }
+    ip = ntohl(st.host);
+    us = st.endUs - st.startUs;
+    pps = us ? (uint32_t)(st.sent * 1000000ull / us) : 0;
+    put("udpgen %s %u.%u.%u.%u:%u size %u rate %u%s count %u\r\n",
+        st.running ? "running to" : "sent to", (ip >> 24) & 0xFF,
+        (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF, st.port, st.size,
+        st.rate, st.rate ? "/s" : " (back to back)", st.count);
+    put("       sent %u errors %u in %u ms: %u pps %u kbit/s, max backlog "
+        "%u\r\n", st.sent, st.errors, (uint32_t)(us / 1000), pps,
+        (uint32_t)((uint64_t)pps * st.size * 8 / 1000), st.maxBacklog);
+}
+
+/*
+ *  ======== cmdClip ========
+ *  -clip [play | loop | stop]; alone it shows the upload and playback.
+ */
+static void cmdClip(char *arg)
+{
+    static const char *const status[] = {
+        "receiving", "done", "bad crc", "bad size", "bad format",
+        "bad session"
+    };
+    AudioClipStatus st;
+    uint64_t        us;
+
+    if (arg != NULL) {
+        if (!strcmp(arg, "stop")) {
+            audioClipStop();
+        }
+        else if (strcmp(arg, "play") && strcmp(arg, "loop")) {
+            put("?? -clip [play | loop | stop]\r\n");
+            return;
+        }
+        else if (!audioClipPlay(!strcmp(arg, "loop"))) {
+            put("?? no complete clip to play\r\n");
+            return;
+        }
+    }
+
+    audioClipStatus(&st);
+    if (st.arenaSize == 0) {
+        put("clip  no arena, the heap could not spare %u bytes\r\n",
+            AUDIOCLIP_ARENA_SIZE);
+        return;
+    }
+    if (!st.active) {
+        put("clip  none, upload up to %u bytes to port %u\r\n",
+            st.arenaSize, AUDIOCLIP_PORT);
+        return;
+    }
+    put("clip  session %u pt %u %u bytes, %u of %u chunks, %s\r\n",
+        st.session, st.format, st.length, st.received, st.chunks,
+        status[st.status]);
+    if (st.endUs != 0) {
+        us = st.endUs - st.startUs;
+        put("      upload %u ms, %u kbit/s\r\n", (uint32_t)(us / 1000),
+            us ? (uint32_t)((uint64_t)st.length * 8000 / us) : 0);
+    }
+    put("      %s at byte %u, played %u times\r\n",
+        st.playing ? (st.loop ? "looping" : "playing") : "stopped",
+        st.position, st.plays);
+    put("      acks %u duplicates %u out of window %u bad chunks %u\r\n",
+        st.stats.acks, st.stats.duplicates, st.stats.outOfWindow,
+        st.stats.badChunks);
+}
+
+/*
+ *  ======== benchAdd ========
+ *  Nanoseconds to add one stream's block, averaged over MIXBENCH_BLOCKS.
+ */
+static uint32_t benchAdd(void (*add)(int16_t *, const int16_t *, unsigned))
+{
+    int16_t  acc[AUDIO_BLOCKSIZE];
+    int16_t  in[AUDIO_BLOCKSIZE];
+    uint64_t start;
+    unsigned i;
+
+    memset(acc, 0, sizeof(acc));
+
+    for (i = 0; i < AUDIO_BLOCKSIZE; i++) {
+        in[i] = (int16_t)(i * 1031);    /* some of these saturate */
+    }
+    start = usClockNow();
+    for (i = 0; i < MIXBENCH_BLOCKS; i++) {
+        add(acc, in, AUDIO_BLOCKSIZE);
+    }
+
+    return ((uint32_t)((usClockNow() - start) * 1000 / MIXBENCH_BLOCKS));
+}
+
+/*
+ *  ======== cmdMixBench ========
+ *  Cost of mixing one more stream into an 8 ms block.
+ */
+static void cmdMixBench(void)
+{
+    ShellContext ctx;
+    uint32_t     simd, c;
+
+    if (!mayWait) {
+        put("!! -mixbench takes seconds; run it from the console or "
+            "telnet\r\n");
+        return;
+    }
+
+    /* a busy loop; the other shells should not have to wait it out */
+    shellSuspend(&ctx);
+    simd = benchAdd(mixAdd);
+    c = benchAdd(mixAddC);
+    shellResume(&ctx);
+
+    put("mix per stream per %u-sample block: mixAdd %u ns, C %u ns "
+        "(%u.%02u%% of the block at %u streams)\r\n", AUDIO_BLOCKSIZE,
+        simd, c, simd * MIX_MAX_STREAMS / 80000,
+        simd * MIX_MAX_STREAMS / 800 % 100, MIX_MAX_STREAMS);
+}
+
+/*
+ *  ======== cmdEcho ========
+ *  -echo [plain|reflect]; no argument shows the current mode.
+ */
+static void cmdEcho(char *arg)
+{
+    if (arg != NULL) {
+        if (!strcmp(arg, "plain")) {
+            echoCoreMode = ECHO_MODE_PLAIN;
+        }
+        else if (!strcmp(arg, "reflect")) {
+            echoCoreMode = ECHO_MODE_REFLECT;
+        }
+        else {
+            put("?? echo mode is plain or reflect\r\n");
+            return;
+        }
+    }
+    put("echo mode %s\r\n",
+        echoCoreMode == ECHO_MODE_REFLECT ? "reflect" : "plain");
+}
+
+/*
+ *  ======== cmdHelp ========
+ *  -help [topic]; the network commands, then the board commands.
+ */
+static void cmdHelp(char *topic)
+{
+    if (topic != NULL) {
+        if (*topic == '-') {
+            topic++;
+        }
+        if (!boardShellHelp(topic)) {
+            put("No help for that topic\r\n");
+        }
+        return;
+    }
+    put("-adapt   : [on|off] audio codec and packet size from feedback\r\n"
+        "-clients : per-client packet counters\r\n"
+        "-clip    : [play|loop|stop] clip uploaded to port 1003\r\n"
+        "-echo    : [plain|reflect] timestamp echo replies\r\n"
+        "-fec     : [k] audio parity every k packets, 0 for none\r\n"
+        "-mcast   : [join <group> | leave] audio multicast group\r\n"
+        "-mixbench: cost of mixing one audio stream\r\n"
+        "-net     : interface, socket counters (pkts/bytes), pools\r\n"
+        "-pace    : [off | kbit/s [burst]] UDP send rate limit\r\n"
+        "-stats   : echo and audio counters\r\n"
+        "-sync    : clock sync state\r\n"
+        "-tasks   : task priorities, stack use, audio deadline misses\r\n"
+        "-tx      : [host port fpp [pcmu|pcma|l16|dvi4]] RTP destination\r\n"
+        "-udpgen  : [host port size rate count | stop] test load\r\n");
+    boardShellHelpList();
+}
+
+/*
+ *  ======== handleLine ========
+ */
+static void handleLine(char *line)
+{
+    char *cmd = strtok(line, " \t");
+
+    if (cmd == NULL) {
+        return;
+    }
+    if (!strcmp(cmd, "-clients")) {
+        cmdClients();
+    }
+    else if (!strcmp(cmd, "-clip")) {
+        cmdClip(strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-stats")) {
+        cmdStats();
+    }
+    else if (!strcmp(cmd, "-sync")) {
+        cmdSync();
+    }
+    else if (!strcmp(cmd, "-net")) {
+        cmdNet();
+    }
+    else if (!strcmp(cmd, "-tasks")) {
+        cmdTasks();
+    }
+    else if (!strcmp(cmd, "-mixbench")) {
+        cmdMixBench();
+    }
+    else if (!strcmp(cmd, "-adapt")) {
+        cmdAdapt(strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-pace")) {
+        char *arg = strtok(NULL, " \t");
+
+        cmdPace(arg, strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-udpgen")) {
+        cmdUdpGen(strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-fec")) {
+        cmdFec(strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-tx")) {
+        cmdTx(strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-mcast")) {
+        char *op = strtok(NULL, " \t");
+
+        cmdMcast(op, strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-echo")) {
+        cmdEcho(strtok(NULL, " \t"));
+    }
+    else if (!strcmp(cmd, "-help")) {
+        cmdHelp(strtok(NULL, " \t"));
+    }
+    else if (!boardShellCommand(cmd, strtok(NULL, ""))) {
+        shellUnknownCommands++;
+        put("?? unknown command %s\r\n", cmd);
+    }
+}
+
+/*
+ *  ======== shellInit ========
+ */
+void shellInit(void)
+{
+    pthread_mutexattr_t attrs;
+
+    pthread_mutexattr_init(&attrs);
+    pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&shellLock, &attrs);
+    pthread_mutexattr_destroy(&attrs);
+}
+
+/*
+ *  ======== shellRunLine ========
+ */
+void shellRunLine(char *line)
+{
+    if (depth >= SHELL_MAX_DEPTH) {
+        put("!! payloads nested too deep\r\n");
+        return;
+    }
+    depth++;
+    handleLine(line);
+    depth--;
+}
+
+/*
+ *  ======== shellSuspend ========
+ */
+void shellSuspend(ShellContext *ctx)
+{
+    ctx->buf = resp.buf;
+    ctx->len = resp.len;
+    ctx->cap = resp.cap;
+    ctx->truncated = resp.truncated;
+    ctx->depth = depth;
+    ctx->mayWait = mayWait;
+    pthread_mutex_unlock(&shellLock);
+}
+
+/*
+ *  ======== shellResume ========
+ */
+void shellResume(const ShellContext *ctx)
+{
+    pthread_mutex_lock(&shellLock);
+    resp.buf = ctx->buf;
+    resp.len = ctx->len;
+    resp.cap = ctx->cap;
+    resp.truncated = ctx->truncated;
+    depth = ctx->depth;
+    mayWait = ctx->mayWait;
+}
+
+/*
+ *  ======== shellMayWait ========
+ */
+bool shellMayWait(void)
+{
+    return (mayWait);
+}
+
+/*
+ *  ======== execute ========
+ */
+static size_t execute(char *request, char *response, size_t cap,
+    bool wait)
+{
+    static const char tail[] = "!! response truncated\r\n";
+    char  *line, *next;
+    size_t len;
+
+    if (cap < sizeof(tail)) {
+        return (0);
+    }
+    pthread_mutex_lock(&shellLock);
+    depth = 0;
+    mayWait = wait;
+    resp.buf = response;
+    resp.len = 0;
+    resp.cap = cap;
+    resp.truncated = false;
+
+    for (line = request; line && *line; line = next) {
+        next = strpbrk(line, "\r\n");
+        if (next) {
+            *next++ = '\0';
+        }
+        if (*line == '\0') {
+            continue;
+        }
+        if (strlen(line) >= MAX_CMD_LEN) {
+            shellLongLines++;
+            put("!! line too long\r\n");
+            continue;
+        }
+        handleLine(line);
+    }
+
+    if (resp.truncated) {
+        memcpy(response + cap - (sizeof(tail) - 1), tail, sizeof(tail) - 1);
+        resp.len = cap;
+    }
+    len = resp.len;
+    pthread_mutex_unlock(&shellLock);
+
+    return (len);
+}
+
+/*
+ *  ======== shellExecute ========
+ */
+size_t shellExecute(char *request, char *response, size_t cap)
+{
+    return (execute(request, response, cap, true));
+}
+
+/*
+ *  ======== shellExecuteNoWait ========
+ */
+size_t shellExecuteNoWait(char *request, char *response, size_t cap)
+{
+    return (execute(request, response, cap, false));
+}
@@ -0,0 +1,157 @@
+/*
+ *    ======== echoCore.c ========
+ */
+
+#include "echoCore.h"
+
+volatile EchoMode echoCoreMode = ECHO_MODE_PLAIN;
+
+static uint32_t get32(const uint8_t *p)
+{
+    return (((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+            ((uint32_t)p[2] << 8) | p[3]);
+}
+
+static void put64(uint8_t *p, uint64_t v)
+{
+    int i;
+
+    for (i = 7; i >= 0; i--) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+/*
+ *  ======== wantsStamps ========
+ */
+static bool wantsStamps(const uint8_t *buf, unsigned len)
+{
+    return (echoCoreMode == ECHO_MODE_REFLECT && len >= ECHO_TS_HDR_LEN &&
+            get32(buf) == ECHO_TS_MAGIC);
+}
+
+/*
+ *  ======== echoCoreProcess ========
+ */
+unsigned echoCoreProcess(uint8_t *buf, unsigned len, unsigned cap,
+                         uint64_t rxUs)
+{
+    if (len > cap) {
+        return (0);
+    }
+    if (wantsStamps(buf, len)) {
+        put64(&buf[ECHO_TS_RX_OFF], rxUs);
+    }
+
+    /* otherwise a plain echo: the reply is the request */
+    return (len);
+}
+
+/*
+ *  ======== echoCoreStampTx ========
+ */
+void echoCoreStampTx(uint8_t *buf, unsigned len, uint64_t txUs)
+{
+    if (wantsStamps(buf, len)) {
+        put64(&buf[ECHO_TS_TX_OFF], txUs);
+    }
+}
+
+/*
+ *  ======== echoCoreCount ========
+ */
+bool echoCoreCount(EchoStats *s, unsigned bytes, uint32_t nowSec)
+{
+    bool rolled = false;
+
+    if (nowSec != s->windowStart) {
+        /* a window with a gap in traffic reads low, which is what we want */
+        if (s->windowStart != 0) {
+            s->pps = s->windowPackets / (nowSec - s->windowStart);
+            rolled = true;
+        }
+        s->windowStart = nowSec;
+        s->windowPackets = 0;
+    }
+
+    s->packets++;
+    s->bytes += bytes;
+    s->windowPackets++;
+
+    return (rolled);
+}
+
+/*
+ *  ======== echoCorePps ========
+ */
+uint32_t echoCorePps(const EchoStats *s, uint32_t nowSec)
+{
+    uint32_t start = s->windowStart;
+    uint32_t packets = s->windowPackets;
+
+    /* the window still open has the last second's; an older one is stale */
+    if (start == 0 || nowSec <= start) {
+        return (s->pps);
+    }
+
+    return (packets / (nowSec - start));
+}
+
+/*
+ *  ======== echoCoreRun ========
+ */
+int echoCoreRun(const EchoIo *io, void *ctx, EchoMsg *msgs, unsigned batch,
+                EchoStats *s)
+{
+    unsigned  i, n;
+    int       got, sent;
+    uint64_t  now;
+
+    if (batch > ECHO_MAX_BATCH) {
+        batch = ECHO_MAX_BATCH;
+    }
+
+    for (;;) {
+        got = io->recvBatch(ctx, msgs, batch);
+        if (got < 0) {
+            return (got);
+        }
+        now = io->nowUs(ctx);
+
+        /* compact the replies to the front so the shim sends one run */
+        n = 0;
+        for (i = 0; i < (unsigned)got; i++) {
+            unsigned len = echoCoreProcess(msgs[i].buf, msgs[i].len,
+                    msgs[i].cap, now);
+
+            if (len == 0) {
+                continue;
+            }
+            if (n != i) {
+                EchoMsg t = msgs[n];
+
+                msgs[n] = msgs[i];
+                msgs[i] = t;
+            }
+            msgs[n++].len = len;
+        }
+        now = io->nowUs(ctx);
+        for (i = 0; i < n; i++) {
+            echoCoreStampTx(msgs[i].buf, msgs[i].len, now);
+        }
+
+        sent = n ? io->sendBatch(ctx, msgs, n) : 0;
+        if (io->release) {
+            io->release(ctx);
+        }
+        if (sent < 0) {
+            sent = 0;
+        }
+        s->errors += n - (unsigned)sent;
+
+        for (i = 0; i < (unsigned)sent; i++) {
+            echoCoreCount(s, msgs[i].len, (uint32_t)(now / 1000000));
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/*
+ *    ======== echoCore.h ========
+ *    Portable UDP echo logic. The core never touches a socket: a shim
+ *    supplies batch receive/send (NDK BSD sockets on the board, recvmmsg/
+ *    sendmmsg on Linux in tools/echoIoLinux.c) and the core turns each
+ *    received datagram into its reply and keeps the counters. Plain C99.
+ *
+ *    Reflect mode (TWAMP-light style): a request at least ECHO_TS_HDR_LEN
+ *    long that starts with ECHO_TS_MAGIC gets the reflector's receive and
+ *    transmit times written into its header; other requests are echoed
+ *    unchanged. All fields are big-endian:
+ *        0   magic "ETS1"
+ *        4   client sequence number      (not touched)
+ *        8   client send time, 64-bit    (not touched)
+ *        16  reflector receive time, us, 64-bit
+ *        24  reflector transmit time, us, 64-bit
+ *    tx - rx is the time spent on the board, so the client can subtract it
+ *    from its RTT to get the network part.
+ */
+
+#ifndef ECHOCORE_H_
+#define ECHOCORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ECHO_MAX_BATCH      32
+
+#define ECHO_TS_MAGIC       0x45545331u     /* "ETS1" */
+#define ECHO_TS_HDR_LEN     32
+#define ECHO_TS_RX_OFF      16
+#define ECHO_TS_TX_OFF      24
+
+typedef enum {
+    ECHO_MODE_PLAIN,
+    ECHO_MODE_REFLECT
+} EchoMode;
+
+extern volatile EchoMode echoCoreMode;
+
+typedef struct {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t errors;
+    uint32_t paced;                 /* of the errors, dropped by udpPace.h */
+    uint32_t pps;                   /* as of the last packet; see echoCorePps() */
+    uint32_t windowStart;           /* seconds; 0 until the first packet */
+    uint32_t windowPackets;
+} EchoStats;
+
+typedef struct {
+    uint8_t *buf;
+    unsigned len;                   /* received length in, reply length out */
+    unsigned cap;                   /* size of buf */
+    void    *peer;                  /* shim-owned source/destination address */
+} EchoMsg;
+
+typedef struct {
+    /*
+     *  Fills up to max messages (buf, cap and peer preset by the shim),
+     *  blocking until at least one arrives. Returns the count, or < 0 to
+     *  stop the loop.
+     */
+    int (*recvBatch)(void *ctx, EchoMsg *msgs, unsigned max);
+
+    /* sends msgs[0..n) back to their peers; returns how many went out */
+    int (*sendBatch)(void *ctx, EchoMsg *msgs, unsigned n);
+
+    /* optional: the batch is finished, its buffers may be recycled */
+    void (*release)(void *ctx);
+
+    /* free-running microsecond clock */
+    uint64_t (*nowUs)(void *ctx);
+} EchoIo;
+
+/*
+ *  Turns one received datagram, received at rxUs, into its reply, in place.
+ *  Returns the reply length; 0 means send nothing.
+ */
+unsigned echoCoreProcess(uint8_t *buf, unsigned len, unsigned cap,
+                         uint64_t rxUs);
+
+/* stamps a processed reply with its transmit time; call just before send */
+void echoCoreStampTx(uint8_t *buf, unsigned len, uint64_t txUs);
+
+/*
+ *  Counts one echoed packet of the given size. Returns true when this call
+ *  closed a one-second window, i.e. when s->pps has a fresh value.
+ */
+bool echoCoreCount(EchoStats *s, unsigned bytes, uint32_t nowSec);
+
+/*
+ *  The echo rate at nowSec. s->pps only moves when a packet arrives, so
+ *  once traffic stops this decays the rate over the time since the
+ *  current window opened, down towards 0, rather than keep the last
+ *  busy second's.
+ */
+uint32_t echoCorePps(const EchoStats *s, uint32_t nowSec);
+
+/*
+ *  Receive, process and send in batches of up to batch (<= ECHO_MAX_BATCH)
+ *  until recvBatch fails. Returns that failure code.
+ */
+int echoCoreRun(const EchoIo *io, void *ctx, EchoMsg *msgs, unsigned batch,
+                EchoStats *s);
+
+#endif /* ECHOCORE_H_ */
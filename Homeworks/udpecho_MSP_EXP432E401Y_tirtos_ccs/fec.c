@@ -0,0 +1,221 @@
+/*
+ *    ======== fec.c ========
+ *    XOR-parity FEC encoder and decoder; see fec.h.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fec.h"
+#include "rtp.h"
+
+static uint16_t get16(const uint8_t *p)
+{
+    return ((uint16_t)((p[0] << 8) | p[1]));
+}
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+/*
+ *  ======== fecXor ========
+ */
+void fecXor(uint8_t *dst, const uint8_t *src, unsigned len)
+{
+    unsigned i = 0;
+
+    if ((((uintptr_t)dst | (uintptr_t)src) & 3) == 0) {
+        uint32_t       *d = (uint32_t *)dst;
+        const uint32_t *s = (const uint32_t *)src;
+
+        for (; i + 4 <= len; i += 4) {
+            *d++ ^= *s++;
+        }
+    }
+    for (; i < len; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+/*
+ *  ======== fecEncInit ========
+ */
+bool fecEncInit(FecEncoder *enc, unsigned k)
+{
+    if (k == 1 || k > FEC_MAX_K || (k & (k - 1)) != 0) {
+        return (false);
+    }
+    enc->k = k;
+    enc->count = 0;
+
+    return (true);
+}
+
+/*
+ *  ======== fecEncAdd ========
+ */
+unsigned fecEncAdd(FecEncoder *enc, const uint8_t *pkt, unsigned len)
+{
+    uint8_t *out = (uint8_t *)enc->packet;
+    uint16_t seq;
+    RtpHeader hdr;
+
+    if (enc->k == 0 || len < RTP_HDR_LEN || len > FEC_MAX_MEDIA) {
+        enc->count = 0;
+        return (0);
+    }
+    seq = get16(&pkt[2]);
+
+    if (enc->count == 0 || seq != (uint16_t)(enc->base + enc->count)) {
+        /* groups start on a multiple of k; wait for the next one */
+        if ((seq & (enc->k - 1)) != 0) {
+            enc->count = 0;
+            return (0);
+        }
+        enc->base = seq;
+        enc->count = 0;
+        enc->maxLen = 0;
+        enc->lenXor = 0;
+        memset(&out[FEC_PARITY_OFF], 0, FEC_MAX_MEDIA);
+    }
+
+    fecXor(&out[FEC_PARITY_OFF], pkt, len);
+    enc->lenXor ^= (uint16_t)len;
+    if (len > enc->maxLen) {
+        enc->maxLen = len;
+    }
+    if (++enc->count < enc->k) {
+        return (0);
+    }
+
+    /* group complete: the parity packet rides on the media SSRC */
+    hdr.pt     = RTP_PT_FEC;
+    hdr.marker = false;
+    hdr.seq    = enc->seq++;
+    hdr.ts     = ((uint32_t)pkt[4] << 24) | ((uint32_t)pkt[5] << 16) |
+                 ((uint32_t)pkt[6] << 8) | pkt[7];
+    hdr.ssrc   = ((uint32_t)pkt[8] << 24) | ((uint32_t)pkt[9] << 16) |
+                 ((uint32_t)pkt[10] << 8) | pkt[11];
+    rtpWriteHeader(out, &hdr);
+    put16(&out[RTP_HDR_LEN], enc->base);
+    out[RTP_HDR_LEN + 2] = (uint8_t)enc->k;
+    out[RTP_HDR_LEN + 3] = 0;
+    put16(&out[RTP_HDR_LEN + 4], enc->lenXor);
+    put16(&out[RTP_HDR_LEN + 6], 0);
+
+    enc->count = 0;
+    enc->stats.parity++;
+
+    return (FEC_PARITY_OFF + enc->maxLen);
+}
+
+/*
+ *  ======== fecDecInit ========
+ */
+void fecDecInit(FecDecoder *dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+/*
+ *  ======== groupFor ========
+ *  The slot for the group starting at base, recycled if it held an
+ *  older group.
+ */
+static FecGroup *groupFor(FecDecoder *dec, uint16_t base)
+{
+    FecGroup *g = &dec->group[(base / dec->k) & 1];
+
+    if (!g->used || g->base != base) {
+        if (g->used && !g->done && g->seen < dec->k) {
+            dec->stats.unrecoverable++;     /* its parity never came */
+        }
+        g->used = true;
+        g->done = false;
+        g->base = base;
+        g->lenXor = 0;
+        g->mask = 0;
+        g->seen = 0;
+        memset(g->acc, 0, sizeof(g->acc));
+    }
+
+    return (g);
+}
+
+/*
+ *  ======== fecDecMedia ========
+ */
+void fecDecMedia(FecDecoder *dec, const uint8_t *pkt, unsigned len)
+{
+    FecGroup *g;
+    uint16_t  seq;
+    uint16_t  bit;
+
+    if (dec->k == 0 || len < RTP_HDR_LEN || len > FEC_MAX_MEDIA) {
+        return;
+    }
+    seq = get16(&pkt[2]);
+    g = groupFor(dec, seq & ~(dec->k - 1));
+    bit = (uint16_t)(1u << (seq & (dec->k - 1)));
+    if (g->done || (g->mask & bit)) {
+        return;                 /* recovered already, late, or a duplicate */
+    }
+    g->mask |= bit;
+
+    fecXor((uint8_t *)g->acc, pkt, len);
+    g->lenXor ^= (uint16_t)len;
+    g->seen++;
+}
+
+/*
+ *  ======== fecDecParity ========
+ */
+unsigned fecDecParity(FecDecoder *dec, uint8_t *pkt, unsigned len)
+{
+    FecGroup *g;
+    unsigned  k;
+    unsigned  recLen;
+    uint16_t  base;
+
+    if (len < FEC_PARITY_OFF || len - FEC_PARITY_OFF > FEC_MAX_MEDIA) {
+        return (0);
+    }
+    base = get16(&pkt[RTP_HDR_LEN]);
+    k = pkt[RTP_HDR_LEN + 2];
+    if (k < 2 || k > FEC_MAX_K || (k & (k - 1)) != 0 ||
+            (base & (k - 1)) != 0) {
+        return (0);
+    }
+    dec->stats.parity++;
+    if (k != dec->k) {
+        /* first parity or a new K: nothing accumulated is usable */
+        dec->k = k;
+        dec->group[0].used = false;
+        dec->group[1].used = false;
+        return (0);
+    }
+
+    g = groupFor(dec, base);
+    if (g->done || g->seen + 1 != k) {
+        if (!g->done && g->seen + 1 < k) {
+            dec->stats.unrecoverable++;
+        }
+        g->done = true;
+        return (0);
+    }
+    g->done = true;
+
+    /* the parity XOR the survivors is the missing packet */
+    recLen = get16(&pkt[RTP_HDR_LEN + 4]) ^ g->lenXor;
+    if (recLen < RTP_HDR_LEN || recLen > len - FEC_PARITY_OFF) {
+        return (0);
+    }
+    fecXor(&pkt[FEC_PARITY_OFF], (const uint8_t *)g->acc, recLen);
+    dec->stats.recovered++;
+
+    return (recLen);
+}
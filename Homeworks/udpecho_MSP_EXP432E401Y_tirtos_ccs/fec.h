@@ -0,0 +1,96 @@
+/*
+ *    ======== fec.h ========
+ *    XOR-parity forward error correction for the RTP audio stream, in the
+ *    spirit of RFC 5109 but simpler.
+ *
+ *    Media packets are grouped by sequence number into blocks of K (a
+ *    power of two, so groups stay aligned across the 16-bit wrap). After
+ *    the last packet of a group the sender adds one parity packet: an RTP
+ *    packet with payload type RTP_PT_FEC whose payload is
+ *        0   sequence number of the group's first packet, 16-bit
+ *        2   K
+ *        3   reserved
+ *        4   XOR of the media packet lengths, 16-bit
+ *        6   reserved, 16-bit
+ *        8   XOR of the whole media packets, RTP header included, each
+ *            zero-padded to the longest
+ *    If exactly one packet of a group is missing, XORing the parity with
+ *    the others gives it back byte for byte, header and all.
+ *
+ *    Both sides work in place on packet buffers, 32 bits at a time; the
+ *    receiver keeps a running XOR per group instead of copies of the
+ *    packets. Plain C with no NDK or driver dependencies.
+ */
+
+#ifndef FEC_H_
+#define FEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "rtp.h"
+
+#define FEC_HDR_LEN     8
+#define FEC_MAX_K       16
+#define FEC_MAX_MEDIA   (1472 - RTP_HDR_LEN - FEC_HDR_LEN)
+#define FEC_PARITY_OFF  (RTP_HDR_LEN + FEC_HDR_LEN)
+
+typedef struct {
+    uint32_t parity;            /* parity packets sent or received */
+    uint32_t recovered;
+    uint32_t unrecoverable;     /* groups with more than one loss */
+} FecStats;
+
+typedef struct {
+    /* parity packet under construction; words so the XOR can be wide */
+    uint32_t packet[(FEC_PARITY_OFF + FEC_MAX_MEDIA + 3) / 4];
+    unsigned k;                 /* 0: FEC off */
+    unsigned count;             /* media packets in the current group */
+    unsigned maxLen;
+    uint16_t base;
+    uint16_t lenXor;
+    uint16_t seq;               /* parity packets have their own sequence */
+    FecStats stats;
+} FecEncoder;
+
+typedef struct {
+    uint32_t acc[(FEC_MAX_MEDIA + 3) / 4];
+    bool     used;
+    bool     done;              /* parity already applied */
+    uint16_t base;
+    uint16_t lenXor;
+    uint16_t mask;              /* packets accumulated, bit per seq - base */
+    unsigned seen;
+} FecGroup;
+
+typedef struct {
+    FecGroup group[2];          /* current group and the one before */
+    unsigned k;                 /* learnt from the parity packets */
+    FecStats stats;
+} FecDecoder;
+
+/* XORs len bytes of src into dst, a word at a time where aligned */
+void fecXor(uint8_t *dst, const uint8_t *src, unsigned len);
+
+/* k of 0 turns FEC off; otherwise a power of two up to FEC_MAX_K */
+bool fecEncInit(FecEncoder *enc, unsigned k);
+
+/*
+ *  Accounts one sent media packet. When it completes a group, returns the
+ *  length of the parity packet now in enc->packet, else 0.
+ */
+unsigned fecEncAdd(FecEncoder *enc, const uint8_t *pkt, unsigned len);
+
+void fecDecInit(FecDecoder *dec);
+
+/* accounts one received media packet */
+void fecDecMedia(FecDecoder *dec, const uint8_t *pkt, unsigned len);
+
+/*
+ *  Applies a received parity packet. If it recovers a lost packet, that
+ *  packet is rebuilt in place at pkt + FEC_PARITY_OFF and its length is
+ *  returned; otherwise 0.
+ */
+unsigned fecDecParity(FecDecoder *dec, uint8_t *pkt, unsigned len);
+
+#endif /* FEC_H_ */
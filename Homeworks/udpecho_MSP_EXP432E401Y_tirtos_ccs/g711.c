@@ -0,0 +1,61 @@
+/*
+ *    ======== g711.c ========
+ */
+
+#include "g711.h"
+
+/*
+ *  ======== g711EncodeUlaw ========
+ */
+unsigned g711EncodeUlaw(uint8_t *dst, const int16_t *src, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = g711LinearToUlaw(src[i]);
+    }
+
+    return (n);
+}
+
+/*
+ *  ======== g711EncodeAlaw ========
+ */
+unsigned g711EncodeAlaw(uint8_t *dst, const int16_t *src, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = g711LinearToAlaw(src[i]);
+    }
+
+    return (n);
+}
+
+/*
+ *  ======== g711DecodeUlaw ========
+ */
+unsigned g711DecodeUlaw(int16_t *dst, const uint8_t *src, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = g711UlawToLinear(src[i]);
+    }
+
+    return (n);
+}
+
+/*
+ *  ======== g711DecodeAlaw ========
+ */
+unsigned g711DecodeAlaw(int16_t *dst, const uint8_t *src, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = g711AlawToLinear(src[i]);
+    }
+
+    return (n);
+}
@@ -0,0 +1,44 @@
+/*
+ *    ======== g711.h ========
+ *    G.711 mu-law / A-law by table lookup, one load per sample. The tables
+ *    (g711Tables.c, ~24 KB of flash) are generated by g711gen.py and are
+ *    bit-exact with the ITU-T G.191 reference coder. No TI dependencies.
+ */
+
+#ifndef G711_H_
+#define G711_H_
+
+#include <stdint.h>
+
+extern const uint8_t g711UlawEnc[1 << 14];
+extern const uint8_t g711AlawEnc[1 << 13];
+extern const int16_t g711UlawDec[256];
+extern const int16_t g711AlawDec[256];
+
+static inline uint8_t g711LinearToUlaw(int16_t x)
+{
+    return (g711UlawEnc[(uint16_t)x >> 2]);
+}
+
+static inline uint8_t g711LinearToAlaw(int16_t x)
+{
+    return (g711AlawEnc[(uint16_t)x >> 3]);
+}
+
+static inline int16_t g711UlawToLinear(uint8_t c)
+{
+    return (g711UlawDec[c]);
+}
+
+static inline int16_t g711AlawToLinear(uint8_t c)
+{
+    return (g711AlawDec[c]);
+}
+
+/* block helpers; each returns the number of bytes/samples written (n) */
+unsigned g711EncodeUlaw(uint8_t *dst, const int16_t *src, unsigned n);
+unsigned g711EncodeAlaw(uint8_t *dst, const int16_t *src, unsigned n);
+unsigned g711DecodeUlaw(int16_t *dst, const uint8_t *src, unsigned n);
+unsigned g711DecodeAlaw(int16_t *dst, const uint8_t *src, unsigned n);
+
+#endif /* G711_H_ */
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+    ======== g711gen.py ========
+    Writes g711Tables.c: the G.711 encode/decode lookup tables.
+
+    The tables follow the ITU-T G.191 reference coder (g711.c in the STL),
+    so a lookup is bit-exact with it. Re-run after changing anything here:
+
+        python g711gen.py > g711Tables.c
+"""
+
+def ulaw_encode(pcm14):
+    """14-bit two's complement linear -> mu-law byte (G.191 ulaw_compress).
+
+    The magnitude of a negative sample is its one's complement, ~x, not
+    -x: the reference coder works on the 16-bit sample as (~x) >> 2.
+    """
+    absno = (~pcm14 if pcm14 < 0 else pcm14) + 33
+    absno = min(absno, 0x1FFF)
+    segno = 1
+    i = absno >> 6
+    while i:
+        segno += 1
+        i >>= 1
+    code = ((8 - segno) << 4) | (0xF - ((absno >> segno) & 0xF))
+    return code | 0x80 if pcm14 >= 0 else code
+
+def ulaw_decode(u):
+    u = ~u & 0xFF
+    t = (((u & 0x0F) << 3) + 0x84) << ((u & 0x70) >> 4)
+    return (0x84 - t) if (u & 0x80) else (t - 0x84)
+
+def alaw_encode(pcm13):
+    """13-bit two's complement linear -> A-law byte (G.191 alaw_compress).
+
+    As for mu-law a negative sample's magnitude is ~x, here (~x) >> 4 of
+    the 16-bit sample, i.e. (~pcm13) >> 1.
+    """
+    ix = (~pcm13 if pcm13 < 0 else pcm13) >> 1
+    if ix > 15:
+        iexp = 1
+        while ix > 16 + 15:
+            ix >>= 1
+            iexp += 1
+        ix -= 16
+        ix += iexp << 4
+    if pcm13 >= 0:
+        ix |= 0x80
+    return ix ^ 0x55
+
+def alaw_decode(a):
+    a ^= 0x55
+    t = (a & 0x0F) << 4
+    seg = (a & 0x70) >> 4
+    if seg == 0:
+        t += 8
+    elif seg == 1:
+        t += 0x108
+    else:
+        t = (t + 0x108) << (seg - 1)
+    return t if (a & 0x80) else -t
+
+def signed(i, bits):
+    return i - (1 << bits) if i >= (1 << (bits - 1)) else i
+
+def emit(name, ctype, values, per_line, fmt):
+    print()
+    print("const %s %s[%d] = {" % (ctype, name, len(values)))
+    for i in range(0, len(values), per_line):
+        print("    " + ", ".join(fmt(v) for v in values[i:i + per_line]) + ",")
+    print("};")
+
+def main():
+    print("""/*
+ *    ======== g711Tables.c ========
+ *    GENERATED by g711gen.py -- do not edit.
+ *
+ *    Encode tables are indexed by the top 14 (mu-law) or 13 (A-law) bits of
+ *    the 16-bit sample taken as unsigned, so negative samples sit in the
+ *    upper half. Decode tables give the 16-bit linear value of each code.
+ */
+
+#include "g711.h\"""")
+    emit("g711UlawEnc", "uint8_t",
+         [ulaw_encode(signed(i, 14)) for i in range(1 << 14)],
+         16, lambda v: "0x%02X" % v)
+    emit("g711AlawEnc", "uint8_t",
+         [alaw_encode(signed(i, 13)) for i in range(1 << 13)],
+         16, lambda v: "0x%02X" % v)
+    emit("g711UlawDec", "int16_t", [ulaw_decode(u) for u in range(256)],
+         8, lambda v: "%6d" % v)
+    emit("g711AlawDec", "int16_t", [alaw_decode(a) for a in range(256)],
+         8, lambda v: "%6d" % v)
+
+if __name__ == "__main__":
+    main()
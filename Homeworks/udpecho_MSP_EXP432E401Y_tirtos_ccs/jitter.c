@@ -0,0 +1,270 @@
+/*
+ *    ======== jitter.c ========
+ *    Adaptive jitter buffer.
+ *
+ *    Depth control: the target is JB_MIN_DEPTH frames plus twice the
+ *    smoothed interarrival jitter. Every JB_ADAPT_FRAMES playouts the
+ *    smallest depth seen is compared with it: one frame is dropped if the
+ *    buffer never got near empty, one concealed frame is inserted if it got
+ *    too close. A frame missing at playout is lost (concealed and skipped)
+ *    when newer frames are waiting, or an underrun (concealed and held)
+ *    when the buffer is empty.
+ */
+
+#include <string.h>
+
+#include "jitter.h"
+
+#define BLK         AUDIO_BLOCKSIZE
+
+/* sequence numbers further back than this are not stragglers (RFC 3550) */
+#define MAX_MISORDER    100
+
+/*
+ *  ======== slotOf ========
+ */
+static unsigned slotOf(const JitterBuffer *jb, uint32_t ts)
+{
+    return (((ts - jb->tsBase) / BLK) % JB_SLOTS);
+}
+
+/*
+ *  ======== clearSlots ========
+ */
+static void clearSlots(JitterBuffer *jb)
+{
+    memset(jb->valid, 0, sizeof(jb->valid));
+}
+
+/*
+ *  ======== jbInit ========
+ */
+void jbInit(JitterBuffer *jb)
+{
+    memset(jb, 0, sizeof(*jb));
+    jb->targetDepth = JB_MIN_DEPTH + 1;
+    jb->winMin = ~0u;
+}
+
+/*
+ *  ======== jbDepth ========
+ */
+unsigned jbDepth(const JitterBuffer *jb)
+{
+    int32_t ahead = (int32_t)(jb->newestTs - jb->playTs);
+
+    return (ahead > 0 ? (unsigned)ahead / BLK : 0);
+}
+
+/*
+ *  ======== restart ========
+ *  Starts playing a stream afresh from the packet at seq and ts. The
+ *  depth target is kept; the path has not changed.
+ */
+static void restart(JitterBuffer *jb, uint32_t ssrc, uint16_t seq,
+                    uint32_t ts, int32_t transit)
+{
+    clearSlots(jb);
+    jb->started     = true;
+    jb->ssrc        = ssrc;
+    jb->tsBase      = ts;
+    jb->playTs      = ts - jb->targetDepth * BLK;
+    jb->preroll     = jb->targetDepth;
+    jb->newestTs    = ts;
+    jb->highestSeq  = seq - 1;
+    jb->lastTransit = transit;
+    jb->lossRun     = 0;
+}
+
+/*
+ *  ======== jbPut ========
+ */
+unsigned jbPut(JitterBuffer *jb, uint32_t ssrc, uint16_t seq, uint32_t ts,
+               const int16_t *samples, unsigned nFrames, uint32_t arrival)
+{
+    int32_t  transit = (int32_t)(arrival - ts);
+    int32_t  ahead = (int32_t)(ts - jb->playTs);
+    unsigned filed = 0;
+    unsigned i;
+
+    if (!jb->started || ssrc != jb->ssrc) {
+        if (jb->started) {
+            jb->stats.resyncs++;
+        }
+        restart(jb, ssrc, seq, ts, transit);
+    }
+    else if (ahead >= JB_SLOTS * BLK || (ahead < -JB_SLOTS * BLK &&
+            (uint16_t)(jb->highestSeq - seq) > MAX_MISORDER)) {
+        /*
+         *  Outside the window, and not a straggler: the sender restarted
+         *  (same SSRC, new timestamp and sequence bases) or jumped ahead.
+         *  Left alone, a restart would be late until its timestamps caught
+         *  up with ours, which could take days.
+         */
+        jb->stats.resyncs++;
+        restart(jb, ssrc, seq, ts, transit);
+    }
+
+    jb->stats.received++;
+
+    if ((int16_t)(seq - jb->highestSeq) > 0) {
+        /* in order: update the RFC 3550 jitter estimate and the target */
+        int32_t  d = transit - jb->lastTransit;
+        uint32_t j;
+
+        jb->highestSeq  = seq;
+        jb->lastTransit = transit;
+        if (d < 0) {
+            d = -d;
+        }
+        jb->jitter += d - ((jb->jitter + 8) >> 4);
+
+        j = jb->jitter >> 4;
+        jb->targetDepth = JB_MIN_DEPTH + (2 * j + BLK - 1) / BLK;
+        if (jb->targetDepth > JB_MAX_DEPTH) {
+            jb->targetDepth = JB_MAX_DEPTH;
+        }
+    }
+    else if (seq != jb->highestSeq) {
+        jb->stats.reordered++;
+    }
+
+    for (i = 0; i < nFrames; i++) {
+        uint32_t fts = ts + i * BLK;
+        int32_t  ahead = (int32_t)(fts - jb->playTs);
+        unsigned slot;
+
+        if (ahead < 0) {
+            jb->stats.late++;
+            continue;
+        }
+        if (ahead >= JB_SLOTS * BLK) {
+            /* sender jumped (or we stalled): restart around this frame */
+            jb->stats.resyncs++;
+            clearSlots(jb);
+            jb->playTs   = fts - (jb->targetDepth - 1) * BLK;
+            jb->preroll  = jb->targetDepth - 1;
+            jb->newestTs = fts;
+        }
+
+        slot = slotOf(jb, fts);
+        if (jb->valid[slot] && jb->slotTs[slot] == fts) {
+            jb->stats.duplicates++;
+            continue;
+        }
+        memcpy(jb->frame[slot], &samples[i * BLK], BLK * sizeof(int16_t));
+        jb->slotTs[slot] = fts;
+        jb->valid[slot]  = true;
+        filed++;
+
+        if ((int32_t)(fts + BLK - jb->newestTs) > 0) {
+            jb->newestTs = fts + BLK;
+        }
+    }
+
+    return (filed);
+}
+
+/*
+ *  ======== fadeGain ========
+ *  Q15 gain after k consecutive concealed frames.
+ */
+static int32_t fadeGain(unsigned k)
+{
+    if (k >= JB_FADE_FRAMES) {
+        return (0);
+    }
+    return (32767 * (int32_t)(JB_FADE_FRAMES - k) / JB_FADE_FRAMES);
+}
+
+/*
+ *  ======== conceal ========
+ *  Repeat the last good frame, fading out across consecutive losses.
+ */
+static void conceal(JitterBuffer *jb, int16_t *out)
+{
+    int32_t g0 = fadeGain(jb->lossRun);
+    int32_t g1 = fadeGain(jb->lossRun + 1);
+    int     n;
+
+    for (n = 0; n < BLK; n++) {
+        int32_t g = g0 + ((g1 - g0) * n) / BLK;
+        out[n] = (int16_t)((jb->lastFrame[n] * g) >> 15);
+    }
+    jb->lossRun++;
+}
+
+/*
+ *  ======== jbGet ========
+ */
+bool jbGet(JitterBuffer *jb, int16_t *out)
+{
+    unsigned slot;
+    unsigned depth;
+
+    if (!jb->started) {
+        memset(out, 0, BLK * sizeof(int16_t));
+        return (false);
+    }
+
+    depth = jbDepth(jb);
+    if (depth < jb->winMin) {
+        jb->winMin = depth;
+    }
+    if (++jb->winCount >= JB_ADAPT_FRAMES) {
+        if (jb->winMin > jb->targetDepth + 1) {
+            jb->adjust = -1;
+        }
+        else if (jb->winMin + 1 < jb->targetDepth) {
+            jb->adjust = 1;
+        }
+        jb->winMin = ~0u;
+        jb->winCount = 0;
+    }
+
+    if (jb->adjust > 0) {
+        /* grow: play a concealed frame without consuming one */
+        jb->adjust = 0;
+        jb->stats.stretched++;
+        conceal(jb, out);
+        return (false);
+    }
+    if (jb->adjust < 0 && depth > 1) {
+        /* shrink: skip the frame due now */
+        slot = slotOf(jb, jb->playTs);
+        jb->valid[slot] = false;
+        jb->playTs += BLK;
+        jb->stats.dropped++;
+    }
+    jb->adjust = 0;
+
+    slot = slotOf(jb, jb->playTs);
+    if (jb->valid[slot] && jb->slotTs[slot] == jb->playTs) {
+        memcpy(out, jb->frame[slot], BLK * sizeof(int16_t));
+        memcpy(jb->lastFrame, out, BLK * sizeof(int16_t));
+        jb->valid[slot] = false;
+        jb->playTs += BLK;
+        jb->lossRun = 0;
+        jb->preroll = 0;
+        return (true);
+    }
+
+    /* the depth a (re)start leaves in front of the first frame is no loss */
+    if (jb->preroll > 0) {
+        jb->preroll--;
+        jb->playTs += BLK;
+        memset(out, 0, BLK * sizeof(int16_t));
+        return (false);
+    }
+
+    conceal(jb, out);
+    if (jbDepth(jb) == 0) {
+        jb->stats.underruns++;          /* hold: let the buffer refill */
+    }
+    else {
+        jb->stats.lost++;
+        jb->playTs += BLK;
+    }
+
+    return (false);
+}
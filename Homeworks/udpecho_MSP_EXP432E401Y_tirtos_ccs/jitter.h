@@ -0,0 +1,82 @@
+/*
+ *    ======== jitter.h ========
+ *    Timestamp-ordered adaptive jitter buffer for the RTP audio stream.
+ *
+ *    Frames are AUDIO_BLOCKSIZE samples and are slotted by RTP timestamp,
+ *    so arrival order does not matter. The playout point is steered so the
+ *    smallest depth seen over a window of JB_ADAPT_FRAMES matches a target
+ *    derived from the RFC 3550 interarrival jitter estimate. Plain C; the
+ *    caller provides locking.
+ */
+
+#ifndef JITTER_H_
+#define JITTER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audioCapture.h"
+
+#define JB_SLOTS        32      /* frames of storage, 256 ms */
+#define JB_MIN_DEPTH    1       /* frames */
+#define JB_MAX_DEPTH    (JB_SLOTS - 4)
+#define JB_ADAPT_FRAMES 32      /* depth is steered once per window */
+#define JB_FADE_FRAMES  4       /* concealment fades to silence over this */
+
+typedef struct {
+    uint32_t received;
+    uint32_t late;              /* arrived after their playout time */
+    uint32_t lost;              /* missing at playout, concealed and skipped */
+    uint32_t underruns;         /* buffer ran dry, concealed and held */
+    uint32_t stretched;         /* frames inserted to grow the buffer */
+    uint32_t reordered;         /* sequence number below the highest seen */
+    uint32_t duplicates;
+    uint32_t dropped;           /* frames skipped to shrink the buffer */
+    uint32_t resyncs;           /* stream jumped or restarted */
+} JitterStats;
+
+typedef struct {
+    int16_t  frame[JB_SLOTS][AUDIO_BLOCKSIZE];
+    uint32_t slotTs[JB_SLOTS];
+    bool     valid[JB_SLOTS];
+
+    bool     started;
+    uint32_t ssrc;
+    uint32_t tsBase;            /* slot 0 timestamp */
+    uint32_t playTs;            /* timestamp of the next frame to play */
+    unsigned preroll;           /* frames of silence before the first */
+    uint32_t newestTs;          /* end of the newest frame received */
+    uint16_t highestSeq;
+
+    int32_t  lastTransit;       /* arrival - ts, for the jitter estimate */
+    uint32_t jitter;            /* RFC 3550 J, samples << 4 */
+    unsigned targetDepth;       /* frames, minimum over a window */
+    unsigned winMin;            /* smallest depth in the current window */
+    unsigned winCount;
+    int      adjust;            /* -1 drop / +1 stretch at the next get */
+
+    int16_t  lastFrame[AUDIO_BLOCKSIZE];
+    unsigned lossRun;           /* consecutive concealed frames */
+
+    JitterStats stats;
+} JitterBuffer;
+
+void jbInit(JitterBuffer *jb);
+
+/*
+ *  Inserts nFrames consecutive frames starting at timestamp ts. arrival is
+ *  the local playout clock in samples when the packet was received.
+ *  Returns the number of frames filed, leaving out late ones and
+ *  duplicates. A packet far outside the window that is not a straggler
+ *  by its sequence number restarts the stream.
+ */
+unsigned jbPut(JitterBuffer *jb, uint32_t ssrc, uint16_t seq, uint32_t ts,
+               const int16_t *samples, unsigned nFrames, uint32_t arrival);
+
+/* always fills out[AUDIO_BLOCKSIZE]; returns false if it was concealed */
+bool jbGet(JitterBuffer *jb, int16_t *out);
+
+/* frames buffered ahead of the playout point */
+unsigned jbDepth(const JitterBuffer *jb);
+
+#endif /* JITTER_H_ */
@@ -0,0 +1,164 @@
+/*
+ *    ======== lineEdit.c ========
+ */
+
+#include <string.h>
+#include <ctype.h>
+
+#include "lineEdit.h"
+
+#define PROMPT "> "
+
+static void put(LineEdit *e, const char *s, size_t n)
+{
+    e->write(e->ctx, s, n);
+}
+
+static void putStr(LineEdit *e, const char *s)
+{
+    put(e, s, strlen(s));
+}
+
+/*
+ *  ======== redraw ========
+ *  Rewrites the line, blanking what is left of one oldLen long, and puts
+ *  the terminal's cursor back on ours.
+ */
+static void redraw(LineEdit *e, size_t oldLen)
+{
+    static const char blanks[] = "        ";
+    size_t n = sizeof(PROMPT) - 1 + oldLen;
+
+    putStr(e, "\r" PROMPT);
+    put(e, e->buf, e->len);
+    while (n > 0) {
+        size_t k = n < sizeof(blanks) - 1 ? n : sizeof(blanks) - 1;
+
+        put(e, blanks, k);
+        n -= k;
+    }
+    putStr(e, "\r" PROMPT);
+    put(e, e->buf, e->cursor);
+}
+
+/*
+ *  ======== lineEditInit ========
+ */
+void lineEditInit(LineEdit *e, LineEditWrite write, void *ctx)
+{
+    memset(e, 0, sizeof(*e));
+    e->write = write;
+    e->ctx = ctx;
+}
+
+/*
+ *  ======== lineEditPrompt ========
+ */
+void lineEditPrompt(LineEdit *e)
+{
+    putStr(e, PROMPT);
+}
+
+/*
+ *  ======== escape ========
+ *  The final byte of ESC [ x: up recalls the last line, down clears,
+ *  right and left move the cursor.
+ */
+static void escape(LineEdit *e, char ch)
+{
+    size_t oldLen = e->len;
+
+    switch (ch) {
+        case 'A':
+            if (e->hasHistory) {
+                strcpy(e->buf, e->history);
+                e->len = e->cursor = strlen(e->history);
+                redraw(e, oldLen);
+            }
+            break;
+        case 'B':
+            e->len = e->cursor = 0;
+            redraw(e, oldLen);
+            break;
+        case 'C':
+            if (e->cursor < e->len) {
+                put(e, &e->buf[e->cursor++], 1);
+            }
+            break;
+        case 'D':
+            if (e->cursor > 0) {
+                putStr(e, "\b");
+                e->cursor--;
+            }
+            break;
+    }
+}
+
+/*
+ *  ======== lineEditFeed ========
+ */
+bool lineEditFeed(LineEdit *e, char ch)
+{
+    size_t oldLen = e->len;
+
+    if (e->esc == 1) {
+        e->esc = (ch == '[') ? 2 : 0;
+        return (false);
+    }
+    if (e->esc == 2) {
+        e->esc = 0;
+        escape(e, ch);
+        return (false);
+    }
+
+    if (ch == '\r' || ch == '\n') {
+        putStr(e, "\r\n");
+        if (e->len == 0) {
+            lineEditPrompt(e);
+            return (false);
+        }
+        e->buf[e->len] = '\0';
+        strcpy(e->history, e->buf);
+        e->hasHistory = true;
+        e->len = e->cursor = 0;
+        return (true);
+    }
+
+    if (ch == 0x08 || ch == 0x7F) {
+        if (e->cursor > 0) {
+            memmove(&e->buf[e->cursor - 1], &e->buf[e->cursor],
+                e->len - e->cursor);
+            e->len--;
+            e->cursor--;
+            redraw(e, oldLen);
+        }
+    }
+    else if (ch == 0x15) {
+        e->len = e->cursor = 0;
+        redraw(e, oldLen);
+    }
+    else if (ch == 0x1B) {
+        e->esc = 1;
+    }
+    else if (isprint((unsigned char)ch)) {
+        if (e->len >= LINEEDIT_MAX - 1) {
+            putStr(e, "\r\n!! character-overflow (128 max) start again\r\n");
+            e->len = e->cursor = 0;
+            lineEditPrompt(e);
+        }
+        else if (e->cursor < e->len) {
+            memmove(&e->buf[e->cursor + 1], &e->buf[e->cursor],
+                e->len - e->cursor);
+            e->buf[e->cursor++] = ch;
+            e->len++;
+            redraw(e, oldLen);
+        }
+        else {
+            e->buf[e->len++] = ch;
+            e->cursor = e->len;
+            put(e, &ch, 1);
+        }
+    }
+
+    return (false);
+}
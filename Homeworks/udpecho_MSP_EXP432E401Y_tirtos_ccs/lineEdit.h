@@ -0,0 +1,40 @@
+/*
+ *    ======== lineEdit.h ========
+ *    The serial shell's line editor (backspace, ^U, cursor keys, one
+ *    line of history) as a byte-at-a-time state machine. Plain C with no
+ *    driver dependencies: echo and redraws go through a write callback, so
+ *    the same editor serves a UART or a socket, one LineEdit per terminal.
+ */
+
+#ifndef LINEEDIT_H_
+#define LINEEDIT_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define LINEEDIT_MAX    128         /* including the NUL, as MAX_CMD_LEN */
+
+typedef void (*LineEditWrite)(void *ctx, const char *s, size_t n);
+
+typedef struct {
+    char          buf[LINEEDIT_MAX];
+    size_t        len;
+    size_t        cursor;
+    char          history[LINEEDIT_MAX];
+    bool          hasHistory;
+    unsigned char esc;              /* 0, or 1/2 after ESC and ESC [ */
+    LineEditWrite write;
+    void         *ctx;
+} LineEdit;
+
+void lineEditInit(LineEdit *e, LineEditWrite write, void *ctx);
+void lineEditPrompt(LineEdit *e);
+
+/*
+ *  Feeds one received byte. Returns true when it completes a non-empty
+ *  line, which is then in e->buf, NUL terminated, until the next call;
+ *  the caller runs it and prompts again.
+ */
+bool lineEditFeed(LineEdit *e, char ch);
+
+#endif /* LINEEDIT_H_ */
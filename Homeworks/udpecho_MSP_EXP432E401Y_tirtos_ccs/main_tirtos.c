@@ -40,6 +40,8 @@
 
 #include <ti/drivers/Board.h>
 
+#include "appTasks.h"
+
 extern void ti_ndk_config_Global_startupFxn();
 
 Display_Handle display;
@@ -61,6 +63,9 @@ int main(void)
 
     ti_ndk_config_Global_startupFxn();
 
+    /* everything that does not wait for an address */
+    appTasksBoot();
+
     /* Start BIOS */
     BIOS_start();
 
@@ -0,0 +1,189 @@
+/*
+ *    ======== mixer.c ========
+ *    Multi-stream mixer; see mixer.h.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__ARM_FEATURE_SIMD32) && __ARM_FEATURE_SIMD32
+#include <arm_acle.h>
+#define MIX_SIMD 1
+#else
+#define MIX_SIMD 0
+#endif
+
+#include "jitter.h"
+#include "mixer.h"
+
+/*
+ *  ======== mixAddC ========
+ */
+void mixAddC(int16_t *acc, const int16_t *in, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        int32_t s = (int32_t)acc[i] + in[i];
+
+        if (s > INT16_MAX) {
+            s = INT16_MAX;
+        }
+        else if (s < INT16_MIN) {
+            s = INT16_MIN;
+        }
+        acc[i] = (int16_t)s;
+    }
+}
+
+/*
+ *  ======== mixAdd ========
+ */
+void mixAdd(int16_t *acc, const int16_t *in, unsigned n)
+{
+#if MIX_SIMD
+    unsigned i;
+
+    /* memcpy keeps it legal C; it compiles to single LDR/STR on the M4 */
+    for (i = 0; i < n; i += 2) {
+        int16x2_t a, b;
+
+        memcpy(&a, &acc[i], sizeof(a));
+        memcpy(&b, &in[i], sizeof(b));
+        a = __qadd16(a, b);
+        memcpy(&acc[i], &a, sizeof(a));
+    }
+#else
+    mixAddC(acc, in, n);
+#endif
+}
+
+/*
+ *  ======== mixInit ========
+ */
+void mixInit(Mixer *mix, uint32_t localSsrc)
+{
+    memset(mix, 0, sizeof(*mix));
+    mix->localSsrc = localSsrc;
+}
+
+/*
+ *  ======== findStream ========
+ *  The stream's slot, or a free one for a new stream, or NULL.
+ */
+static MixStream *findStream(Mixer *mix, uint32_t ssrc)
+{
+    MixStream *slot = NULL;
+    unsigned   i;
+
+    for (i = 0; i < MIX_MAX_STREAMS; i++) {
+        MixStream *s = &mix->stream[i];
+
+        if (s->used && s->ssrc == ssrc) {
+            return (s);
+        }
+        if (!s->used && slot == NULL) {
+            slot = s;
+        }
+    }
+    if (slot != NULL) {
+        slot->used = true;
+        slot->ssrc = ssrc;
+        slot->idle = 0;
+        jbInit(&slot->jb);
+        mix->stats.joined++;
+    }
+
+    return (slot);
+}
+
+/*
+ *  ======== mixPut ========
+ */
+bool mixPut(Mixer *mix, uint32_t ssrc, uint16_t seq, uint32_t ts,
+            const int16_t *samples, unsigned nFrames, uint32_t arrival)
+{
+    MixStream *s;
+
+    if (ssrc == mix->localSsrc) {
+        mix->stats.local++;
+        return (false);
+    }
+    s = findStream(mix, ssrc);
+    if (s == NULL) {
+        mix->stats.rejected++;
+        return (false);
+    }
+
+    /* a stream whose frames are all late is as good as silent */
+    if (jbPut(&s->jb, ssrc, seq, ts, samples, nFrames, arrival) == 0) {
+        return (false);
+    }
+    s->idle = 0;
+
+    return (true);
+}
+
+/*
+ *  ======== mixGet ========
+ */
+unsigned mixGet(Mixer *mix, int16_t *out)
+{
+    static int16_t frame[AUDIO_BLOCKSIZE];
+    unsigned       i, n = 0;
+
+    for (i = 0; i < MIX_MAX_STREAMS; i++) {
+        MixStream *s = &mix->stream[i];
+
+        if (!s->used) {
+            continue;
+        }
+        if (++s->idle > MIX_IDLE_FRAMES) {
+            s->used = false;
+            mix->stats.expired++;
+            continue;
+        }
+
+        /* the first stream is copied, the rest are added to it */
+        jbGet(&s->jb, n ? frame : out);
+        if (n++) {
+            mixAdd(out, frame, AUDIO_BLOCKSIZE);
+        }
+    }
+    if (n == 0) {
+        memset(out, 0, AUDIO_BLOCKSIZE * sizeof(out[0]));
+    }
+
+    return (n);
+}
+
+/*
+ *  ======== mixFind ========
+ */
+MixStream *mixFind(Mixer *mix, uint32_t ssrc)
+{
+    unsigned i;
+
+    for (i = 0; i < MIX_MAX_STREAMS; i++) {
+        if (mix->stream[i].used && mix->stream[i].ssrc == ssrc) {
+            return (&mix->stream[i]);
+        }
+    }
+
+    return (NULL);
+}
+
+/*
+ *  ======== mixStreams ========
+ */
+unsigned mixStreams(const Mixer *mix)
+{
+    unsigned i, n = 0;
+
+    for (i = 0; i < MIX_MAX_STREAMS; i++) {
+        n += mix->stream[i].used;
+    }
+
+    return (n);
+}
@@ -0,0 +1,69 @@
+/*
+ *    ======== mixer.h ========
+ *    Receive-side conference mixer: up to MIX_MAX_STREAMS RTP streams,
+ *    told apart by SSRC, each with its own jitter buffer, summed with
+ *    saturation into one block for the DAC. The board's own stream (for
+ *    example looped back by a multicast group) is never mixed in. A
+ *    stream that has no frame filed for MIX_IDLE_FRAMES frees its slot. Plain
+ *    C; the caller provides locking.
+ */
+
+#ifndef MIXER_H_
+#define MIXER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "audioCapture.h"
+#include "jitter.h"
+
+#define MIX_MAX_STREAMS     4
+#define MIX_IDLE_FRAMES     125     /* 1 s of 8 ms frames */
+
+typedef struct {
+    uint32_t joined;            /* streams given a slot */
+    uint32_t expired;           /* slots freed after going idle */
+    uint32_t rejected;          /* packets from streams that found no slot */
+    uint32_t local;             /* packets of our own stream, ignored */
+} MixStats;
+
+typedef struct {
+    bool         used;
+    uint32_t     ssrc;
+    unsigned     idle;          /* frames played since one was filed */
+    JitterBuffer jb;
+} MixStream;
+
+typedef struct {
+    MixStream stream[MIX_MAX_STREAMS];
+    uint32_t  localSsrc;
+    MixStats  stats;
+} Mixer;
+
+void mixInit(Mixer *mix, uint32_t localSsrc);
+
+/* files frames of stream ssrc, as jbPut(); false if none was filed */
+bool mixPut(Mixer *mix, uint32_t ssrc, uint16_t seq, uint32_t ts,
+            const int16_t *samples, unsigned nFrames, uint32_t arrival);
+
+/*
+ *  Plays one frame of every stream into out[AUDIO_BLOCKSIZE]; silence if
+ *  there are none. Returns the number of streams mixed.
+ */
+unsigned mixGet(Mixer *mix, int16_t *out);
+
+unsigned mixStreams(const Mixer *mix);
+
+/* the slot playing ssrc, or NULL */
+MixStream *mixFind(Mixer *mix, uint32_t ssrc);
+
+/*
+ *  acc[i] = sat16(acc[i] + in[i]) for n samples (n even). mixAdd() uses
+ *  the Cortex-M4 QADD16 (two samples per instruction) when the compiler
+ *  offers the ACLE SIMD32 intrinsics, else it is mixAddC(), the portable
+ *  fallback, which is always built so the two can be compared.
+ */
+void mixAdd(int16_t *acc, const int16_t *in, unsigned n);
+void mixAddC(int16_t *acc, const int16_t *in, unsigned n);
+
+#endif /* MIXER_H_ */
@@ -0,0 +1,49 @@
+/*
+ *    ======== netStats.c ========
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "clientTable.h"
+#include "netStats.h"
+
+NetCounters  netCounters[NETTASK_NUM][NETSOCK_NUM];
+NetInterface netInterface;
+
+const char *const netSockNames[NETSOCK_NUM] = {
+    "echo", "audio", "control", "sync", "audio tx", "sync client",
+    "udpgen", "clip", "telnet"
+};
+
+/*
+ *  ======== netStatsSocket ========
+ */
+void netStatsSocket(NetSock s, NetCounters *out)
+{
+    unsigned t;
+
+    memset(out, 0, sizeof(*out));
+    for (t = 0; t < NETTASK_NUM; t++) {
+        const NetCounters *c = &netCounters[t][s];
+
+        out->rxPackets += c->rxPackets;
+        out->rxBytes   += c->rxBytes;
+        out->txPackets += c->txPackets;
+        out->txBytes   += c->txBytes;
+        out->errors    += c->errors;
+    }
+}
+
+/*
+ *  ======== netStatsInterface ========
+ */
+void netStatsInterface(uint32_t addr, unsigned ifIdx, bool up)
+{
+    netInterface.up = up;
+    netInterface.addr = up ? addr : 0;
+    netInterface.ifIdx = ifIdx;
+    netInterface.changes++;
+    netInterface.sinceMs = clientNowMs();
+}
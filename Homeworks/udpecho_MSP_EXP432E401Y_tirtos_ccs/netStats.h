@@ -0,0 +1,100 @@
+/*
+ *    ======== netStats.h ========
+ *    Per-socket UDP counters and interface state for the -net command.
+ *
+ *    Lock-free: every task writes only its own row of counters, so a
+ *    counter has a single writer and a plain 32-bit increment is safe.
+ *    Readers sum the rows when they report. A reading taken while a task
+ *    is mid-update can be one packet behind, never torn.
+ */
+
+#ifndef NETSTATS_H_
+#define NETSTATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* tasks that own sockets */
+typedef enum {
+    NETTASK_SERVER,             /* echoFxn's select() loop */
+    NETTASK_ECHO_ZC,            /* echoZeroCopyFxn */
+    NETTASK_AUDIO_TX,           /* audioTxFxn */
+    NETTASK_CLOCKSYNC,          /* clockSyncFxn */
+    NETTASK_UDPGEN,             /* udpGenFxn */
+    NETTASK_TELNET,             /* telnetShellFxn */
+    NETTASK_NUM
+} NetTask;
+
+/* the sockets, by what they carry */
+typedef enum {
+    NETSOCK_ECHO,
+    NETSOCK_AUDIO,
+    NETSOCK_CONTROL,
+    NETSOCK_SYNC,
+    NETSOCK_AUDIO_TX,
+    NETSOCK_SYNC_CLIENT,
+    NETSOCK_UDPGEN,
+    NETSOCK_CLIP,
+    NETSOCK_TELNET,             /* every session, and the listener */
+    NETSOCK_NUM
+} NetSock;
+
+typedef struct {
+    uint32_t rxPackets;
+    uint32_t rxBytes;
+    uint32_t txPackets;
+    uint32_t txBytes;
+    uint32_t errors;            /* failed or short receives and sends */
+} NetCounters;
+
+typedef struct {
+    bool     up;
+    uint32_t addr;              /* network byte order */
+    unsigned ifIdx;
+    uint32_t changes;           /* address added or removed */
+    uint32_t sinceMs;           /* clientNowMs() of the last change */
+} NetInterface;
+
+extern NetCounters  netCounters[NETTASK_NUM][NETSOCK_NUM];
+extern NetInterface netInterface;
+
+extern const char *const netSockNames[NETSOCK_NUM];
+
+static inline void netCountRx(NetTask t, NetSock s, int bytes)
+{
+    NetCounters *c = &netCounters[t][s];
+
+    if (bytes < 0) {
+        c->errors++;
+        return;
+    }
+    c->rxPackets++;
+    c->rxBytes += bytes;
+}
+
+/* bytes is what sendto() returned, want what was asked for */
+static inline void netCountTx(NetTask t, NetSock s, int bytes, int want)
+{
+    NetCounters *c = &netCounters[t][s];
+
+    if (bytes != want) {
+        c->errors++;
+        return;
+    }
+    c->txPackets++;
+    c->txBytes += bytes;
+}
+
+/* sums one socket over every task */
+void netStatsSocket(NetSock s, NetCounters *out);
+
+/* called from netIPAddrHook */
+void netStatsInterface(uint32_t addr, unsigned ifIdx, bool up);
+
+/*
+ *  Prints the NDK memory manager's page and bucket usage through prn
+ *  (udpEchoHooks.c, next to the rest of the stack configuration).
+ */
+void netPoolReport(int (*prn)(const char *fmt, ...));
+
+#endif /* NETSTATS_H_ */
@@ -0,0 +1,198 @@
+/*
+ *    ======== rtp.c ========
+ */
+
+#include "adpcm.h"
+#include "g711.h"
+#include "rtp.h"
+
+/*
+ *  ======== rtpWriteHeader ========
+ */
+unsigned rtpWriteHeader(uint8_t *p, const RtpHeader *h)
+{
+    p[0]  = RTP_VERSION << 6;                 /* no padding, ext or CSRCs */
+    p[1]  = (h->marker ? 0x80 : 0) | (h->pt & 0x7F);
+    p[2]  = (uint8_t)(h->seq >> 8);
+    p[3]  = (uint8_t)h->seq;
+    p[4]  = (uint8_t)(h->ts >> 24);
+    p[5]  = (uint8_t)(h->ts >> 16);
+    p[6]  = (uint8_t)(h->ts >> 8);
+    p[7]  = (uint8_t)h->ts;
+    p[8]  = (uint8_t)(h->ssrc >> 24);
+    p[9]  = (uint8_t)(h->ssrc >> 16);
+    p[10] = (uint8_t)(h->ssrc >> 8);
+    p[11] = (uint8_t)h->ssrc;
+
+    return (RTP_HDR_LEN);
+}
+
+/*
+ *  ======== rtpReadHeader ========
+ */
+bool rtpReadHeader(const uint8_t *p, unsigned len, RtpHeader *h,
+                   unsigned *payloadOff, unsigned *payloadLen)
+{
+    unsigned off;
+    unsigned pad = 0;
+
+    if (len < RTP_HDR_LEN || (p[0] >> 6) != RTP_VERSION) {
+        return (false);
+    }
+
+    h->marker = (p[1] & 0x80) != 0;
+    h->pt     = p[1] & 0x7F;
+    h->seq    = ((uint16_t)p[2] << 8) | p[3];
+    h->ts     = ((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) |
+                ((uint32_t)p[6] << 8) | p[7];
+    h->ssrc   = ((uint32_t)p[8] << 24) | ((uint32_t)p[9] << 16) |
+                ((uint32_t)p[10] << 8) | p[11];
+
+    off = RTP_HDR_LEN + 4 * (p[0] & 0x0F);    /* CSRC list */
+    if (p[0] & 0x10) {                        /* header extension */
+        if (off + 4 > len) {
+            return (false);
+        }
+        off += 4 + 4 * (((unsigned)p[off + 2] << 8) | p[off + 3]);
+    }
+    if (p[0] & 0x20) {                        /* padding count in last byte */
+        pad = p[len - 1];
+    }
+    if (off + pad > len) {
+        return (false);
+    }
+
+    *payloadOff = off;
+    *payloadLen = len - off - pad;
+
+    return (true);
+}
+
+/*
+ *  ======== rtpPackL16 ========
+ */
+unsigned rtpPackL16(uint8_t *p, const int16_t *s, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        p[2 * i]     = (uint8_t)((uint16_t)s[i] >> 8);
+        p[2 * i + 1] = (uint8_t)s[i];
+    }
+
+    return (2 * n);
+}
+
+/*
+ *  ======== rtpUnpackL16 ========
+ */
+void rtpUnpackL16(int16_t *s, const uint8_t *p, unsigned n)
+{
+    unsigned i;
+
+    for (i = 0; i < n; i++) {
+        s[i] = (int16_t)(((uint16_t)p[2 * i] << 8) | p[2 * i + 1]);
+    }
+}
+
+/*
+ *  ======== rtpPayloadBytes ========
+ */
+unsigned rtpPayloadBytes(uint8_t pt, unsigned n)
+{
+    switch (pt) {
+        case RTP_PT_L16:
+            return (2 * n);
+        case RTP_PT_PCMU:
+        case RTP_PT_PCMA:
+            return (n);
+        case RTP_PT_DVI4:
+            return (RTP_DVI4_HDR_LEN + n / 2);
+        default:
+            return (0);
+    }
+}
+
+/*
+ *  ======== rtpPayloadSamples ========
+ */
+unsigned rtpPayloadSamples(uint8_t pt, unsigned len)
+{
+    switch (pt) {
+        case RTP_PT_L16:
+            return (len / 2);
+        case RTP_PT_PCMU:
+        case RTP_PT_PCMA:
+            return (len);
+        case RTP_PT_DVI4:
+            return (len > RTP_DVI4_HDR_LEN ? 2 * (len - RTP_DVI4_HDR_LEN) : 0);
+        default:
+            return (0);
+    }
+}
+
+/*
+ *  ======== rtpPackBegin ========
+ */
+unsigned rtpPackBegin(uint8_t pt, uint8_t *p, const AdpcmState *st)
+{
+    if (pt != RTP_PT_DVI4) {
+        return (0);
+    }
+    p[0] = (uint8_t)((uint16_t)st->predicted >> 8);
+    p[1] = (uint8_t)st->predicted;
+    p[2] = st->index;
+    p[3] = 0;
+
+    return (RTP_DVI4_HDR_LEN);
+}
+
+/*
+ *  ======== rtpPackSamples ========
+ */
+unsigned rtpPackSamples(uint8_t pt, uint8_t *p, const int16_t *s, unsigned n,
+                        AdpcmState *st)
+{
+    switch (pt) {
+        case RTP_PT_PCMU:
+            return (g711EncodeUlaw(p, s, n));
+        case RTP_PT_PCMA:
+            return (g711EncodeAlaw(p, s, n));
+        case RTP_PT_DVI4:
+            return (adpcmEncode(st, p, s, n));
+        default:
+            return (rtpPackL16(p, s, n));
+    }
+}
+
+/*
+ *  ======== rtpUnpackPayload ========
+ */
+unsigned rtpUnpackPayload(uint8_t pt, int16_t *s, const uint8_t *p,
+                          unsigned len)
+{
+    unsigned   n = rtpPayloadSamples(pt, len);
+    AdpcmState st;
+
+    switch (pt) {
+        case RTP_PT_PCMU:
+            g711DecodeUlaw(s, p, n);
+            break;
+        case RTP_PT_PCMA:
+            g711DecodeAlaw(s, p, n);
+            break;
+        case RTP_PT_DVI4:
+            if (n == 0 || p[2] > 88) {
+                return (0);
+            }
+            st.predicted = (int16_t)(((uint16_t)p[0] << 8) | p[1]);
+            st.index = p[2];
+            adpcmDecode(&st, s, &p[RTP_DVI4_HDR_LEN], n);
+            break;
+        default:
+            rtpUnpackL16(s, p, n);
+            break;
+    }
+
+    return (n);
+}
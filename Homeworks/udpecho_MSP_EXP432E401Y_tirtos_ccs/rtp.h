@@ -0,0 +1,72 @@
+/*
+ *    ======== rtp.h ========
+ *    RTP (RFC 3550) fixed header and payload helpers for the audio
+ *    stream. Plain C with no NDK or driver dependencies so the same code
+ *    packs on the board and parses on a host.
+ */
+
+#ifndef RTP_H_
+#define RTP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "adpcm.h"
+
+#define RTP_HDR_LEN     12
+#define RTP_VERSION     2
+
+/* payload types */
+#define RTP_PT_PCMU     0       /* G.711 mu-law, 8 kHz */
+#define RTP_PT_DVI4     5       /* IMA ADPCM, 8 kHz, 4 bits per sample */
+#define RTP_PT_PCMA     8       /* G.711 A-law, 8 kHz */
+#define RTP_PT_L16      96      /* dynamic: 16-bit linear, 8 kHz mono */
+#define RTP_PT_FEC      127     /* dynamic: XOR parity (fec.h) */
+
+typedef struct {
+    uint8_t  pt;
+    bool     marker;
+    uint16_t seq;
+    uint32_t ts;                /* in samples of the 8 kHz clock */
+    uint32_t ssrc;
+} RtpHeader;
+
+/* writes the 12-byte header, returns RTP_HDR_LEN */
+unsigned rtpWriteHeader(uint8_t *p, const RtpHeader *h);
+
+/*
+ *  Parses and validates a received packet. On success *payloadOff and
+ *  *payloadLen locate the payload (CSRCs, extension and padding skipped).
+ */
+bool rtpReadHeader(const uint8_t *p, unsigned len, RtpHeader *h,
+                   unsigned *payloadOff, unsigned *payloadLen);
+
+/* L16 is carried big-endian on the wire */
+unsigned rtpPackL16(uint8_t *p, const int16_t *s, unsigned n);
+void     rtpUnpackL16(int16_t *s, const uint8_t *p, unsigned n);
+
+#define RTP_DVI4_HDR_LEN 4      /* predicted sample, step index, reserved */
+
+/*
+ *  Payload-type dispatch over L16, PCMU, PCMA and DVI4. rtpPayloadBytes()
+ *  is the payload size for n samples and rtpPayloadSamples() the reverse;
+ *  both return 0 if the payload type is not supported (or, for the
+ *  latter, the length does not fit it).
+ */
+unsigned rtpPayloadBytes(uint8_t pt, unsigned n);
+unsigned rtpPayloadSamples(uint8_t pt, unsigned len);
+
+/*
+ *  A payload is packed as rtpPackBegin() followed by rtpPackSamples() for
+ *  each block. The ADPCM state carries across packets on the sender;
+ *  DVI4 writes it at the start of each payload. Other types ignore st.
+ */
+unsigned rtpPackBegin(uint8_t pt, uint8_t *p, const AdpcmState *st);
+unsigned rtpPackSamples(uint8_t pt, uint8_t *p, const int16_t *s, unsigned n,
+                        AdpcmState *st);
+
+/* decodes a whole payload; returns the number of samples */
+unsigned rtpUnpackPayload(uint8_t pt, int16_t *s, const uint8_t *p,
+                          unsigned len);
+
+#endif /* RTP_H_ */
@@ -0,0 +1,123 @@
+/*
+ *    ======== rtpPacker.c ========
+ */
+
+#include <string.h>
+
+#include "rtpPacker.h"
+
+/*
+ *  ======== flush ========
+ *  Sends the packet so far; the next one follows on from it.
+ */
+static void flush(RtpPacker *pk)
+{
+    rtpWriteHeader(pk->packet, &pk->hdr);
+    pk->send(pk->arg, pk->packet, pk->len);
+    pk->nextTs = pk->hdr.ts + pk->frames * pk->blockSize;
+    pk->hdr.seq++;
+    pk->hdr.marker = false;
+    pk->frames = 0;
+    pk->len = RTP_HDR_LEN;
+}
+
+/*
+ *  ======== track ========
+ *  Where the signal is and how fast it moves, for a later switch to DVI4.
+ */
+static void track(RtpPacker *pk, const int16_t *block)
+{
+    uint32_t sum = 0;
+    unsigned i;
+
+    for (i = 1; i < pk->blockSize; i++) {
+        int32_t d = (int32_t)block[i] - block[i - 1];
+
+        sum += (uint32_t)(d < 0 ? -d : d);
+    }
+    pk->lastSample = block[pk->blockSize - 1];
+    pk->meanDiff = (uint16_t)(sum / (pk->blockSize - 1));
+}
+
+/*
+ *  ======== rtpPackerInit ========
+ */
+void rtpPackerInit(RtpPacker *pk, uint8_t *packet, unsigned blockSize,
+                   uint32_t ssrc, uint16_t seq, uint8_t pt, unsigned fpp,
+                   RtpPackerSend send, RtpPackerBoundary boundary, void *arg)
+{
+    memset(pk, 0, sizeof(*pk));
+    pk->hdr.pt     = pt;
+    pk->hdr.seq    = seq;
+    pk->hdr.ssrc   = ssrc;
+    pk->hdr.marker = true;                  /* start of talkspurt */
+    adpcmInit(&pk->adpcm);
+    pk->packet     = packet;
+    pk->blockSize  = blockSize;
+    pk->fpp        = fpp;
+    pk->nextPt     = pt;
+    pk->nextFpp    = fpp;
+    pk->len        = RTP_HDR_LEN;
+    pk->send       = send;
+    pk->boundary   = boundary;
+    pk->arg        = arg;
+}
+
+/*
+ *  ======== rtpPackerSetFormat ========
+ */
+void rtpPackerSetFormat(RtpPacker *pk, uint8_t pt, unsigned fpp)
+{
+    pk->nextPt = pt;
+    pk->nextFpp = fpp;
+}
+
+/*
+ *  ======== rtpPackerBlock ========
+ */
+void rtpPackerBlock(RtpPacker *pk, const int16_t *block, uint32_t ts)
+{
+    /* blocks lost inside this packet: send it, restart */
+    if (pk->frames > 0 && ts != pk->hdr.ts + pk->frames * pk->blockSize) {
+        flush(pk);
+        pk->hdr.marker = true;
+    }
+
+    if (pk->frames == 0) {
+        /* packet boundary: the only place the format may change */
+        if (pk->boundary) {
+            pk->boundary(pk->arg);
+        }
+        if (pk->nextPt == RTP_PT_DVI4 && pk->hdr.pt != RTP_PT_DVI4) {
+            adpcmSeed(&pk->adpcm, pk->lastSample, pk->meanDiff);
+        }
+        pk->hdr.pt = pk->nextPt;
+        pk->fpp = pk->nextFpp;
+
+        /* blocks lost between packets are a gap all the same */
+        if (ts != pk->nextTs) {
+            pk->hdr.marker = true;
+        }
+        pk->hdr.ts = ts;
+        pk->len += rtpPackBegin(pk->hdr.pt, &pk->packet[pk->len], &pk->adpcm);
+    }
+
+    pk->len += rtpPackSamples(pk->hdr.pt, &pk->packet[pk->len], block,
+        pk->blockSize, &pk->adpcm);
+    if (pk->hdr.pt != RTP_PT_DVI4) {
+        track(pk, block);
+    }
+    if (++pk->frames >= pk->fpp) {
+        flush(pk);
+    }
+}
+
+/*
+ *  ======== rtpPackerEnd ========
+ */
+void rtpPackerEnd(RtpPacker *pk)
+{
+    if (pk->frames > 0) {
+        flush(pk);
+    }
+}
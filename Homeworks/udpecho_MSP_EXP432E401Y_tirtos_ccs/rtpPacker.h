@@ -0,0 +1,68 @@
+/*
+ *    ======== rtpPacker.h ========
+ *    Portable RTP packetiser: turns captured blocks, each with the sample
+ *    clock of its first sample, into packets of framesPerPacket blocks and
+ *    hands every finished packet to a send callback. audioTxFxn drives it
+ *    from the capture on the board and tools/rtpSim.c from a simulated clock
+ *    on a host. Plain C99, no TI dependencies.
+ *
+ *    The RTP timestamp is the clock of a packet's first sample. A block
+ *    that does not follow on from the one before (the capture dropped
+ *    some, or the gate held some back) sends the packet so far and starts
+ *    a new one with the marker bit, so a receiver never splices across a
+ *    gap. A switch to DVI4 seeds the coder from the last block sent in
+ *    the old format, so the new stream does not start from silence.
+ */
+
+#ifndef RTPPACKER_H_
+#define RTPPACKER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "adpcm.h"
+#include "rtp.h"
+
+/* one finished packet, header written; the buffer is reused afterwards */
+typedef void (*RtpPackerSend)(void *arg, uint8_t *packet, unsigned len);
+
+/* called as each packet starts, the one place rtpPackerSetFormat() lands */
+typedef void (*RtpPackerBoundary)(void *arg);
+
+typedef struct {
+    RtpHeader         hdr;          /* of the packet being filled */
+    AdpcmState        adpcm;        /* carries across DVI4 packets */
+    int16_t           lastSample;   /* of the last block, other formats */
+    uint16_t          meanDiff;     /* its mean sample-to-sample change */
+    uint8_t          *packet;
+    unsigned          blockSize;
+    unsigned          fpp;          /* blocks in a full packet */
+    uint8_t           nextPt;       /* the format from the next packet on */
+    unsigned          nextFpp;
+    unsigned          frames;       /* blocks in the packet so far */
+    unsigned          len;
+    uint32_t          nextTs;       /* where the last packet ended */
+    RtpPackerSend     send;
+    RtpPackerBoundary boundary;     /* may be NULL */
+    void             *arg;
+} RtpPacker;
+
+/*
+ *  packet holds RTP_HDR_LEN + fpp * blockSize * 2 bytes for the largest
+ *  fpp to be set. The first packet goes out with the marker bit and
+ *  sequence number seq.
+ */
+void rtpPackerInit(RtpPacker *pk, uint8_t *packet, unsigned blockSize,
+                   uint32_t ssrc, uint16_t seq, uint8_t pt, unsigned fpp,
+                   RtpPackerSend send, RtpPackerBoundary boundary, void *arg);
+
+/* payload type and blocks per packet from the next packet on */
+void rtpPackerSetFormat(RtpPacker *pk, uint8_t pt, unsigned fpp);
+
+/* adds one block taken at sample clock ts; may send up to two packets */
+void rtpPackerBlock(RtpPacker *pk, const int16_t *block, uint32_t ts);
+
+/* the talkspurt ends: sends whatever is queued */
+void rtpPackerEnd(RtpPacker *pk);
+
+#endif /* RTPPACKER_H_ */
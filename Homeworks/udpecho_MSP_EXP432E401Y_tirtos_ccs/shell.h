@@ -0,0 +1,71 @@
+/*
+ *    ======== shell.h ========
+ *    Command shell entry point for the UDP control port and the serial
+ *    console, telnet and board callbacks. controlShell.c implements it with
+ *    the network commands and hands the rest to boardShell.c.
+ */
+
+#ifndef SHELL_H_
+#define SHELL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ *  Runs each '\n' or '\r' separated line of request (modified in place)
+ *  through the command parser. Everything the commands print is collected
+ *  into response instead of going to the UART, so a whole batch answers as
+ *  one buffer. Output past cap is dropped and the tail is replaced with a
+ *  truncation marker. Returns the response length (not NUL terminated).
+ *  Callers in different tasks take turns on an internal lock; it inherits
+ *  priority, so a long command from the console cannot hold up the UDP
+ *  task behind it for longer than the command itself.
+ */
+size_t shellExecute(char *request, char *response, size_t cap);
+
+/*
+ *  shellExecute() for the UDP server, which also carries the audio, clock
+ *  sync and clip ports and so must not block for long: commands that take
+ *  seconds (-fresp, -mixbench) refuse to run, in payloads too.
+ */
+size_t shellExecuteNoWait(char *request, char *response, size_t cap);
+
+/* creates the lock; call once before any task can reach shellExecute() */
+void shellInit(void);
+
+/*
+ *  For commands only, with the lock held: printf into the response, and
+ *  run a line (modified in place) as if it came in the request. -if and
+ *  -script run their payloads this way; nesting stops at a few levels.
+ */
+void shellPut(const char *fmt, ...);
+void shellRunLine(char *line);
+
+/* for commands: false if the caller cannot wait (shellExecuteNoWait()) */
+bool shellMayWait(void);
+
+/*
+ *  A command that waits or computes for a long time (-fresp, -mixbench)
+ *  lets go of the lock in between, so the other shells are not held up
+ *  behind it (its own caller still is): shellSuspend() keeps where
+ *  its response stands and unlocks, shellResume() locks again and carries
+ *  on. Arguments must be parsed before suspending; another caller's
+ *  commands run meanwhile.
+ */
+typedef struct {
+    char    *buf;
+    size_t   len, cap;
+    bool     truncated;
+    unsigned depth;
+    bool     mayWait;
+} ShellContext;
+
+void shellSuspend(ShellContext *ctx);
+void shellResume(const ShellContext *ctx);
+
+/* lines that were not a command, and lines over the length limit */
+extern uint32_t shellUnknownCommands;
+extern uint32_t shellLongLines;
+
+#endif /* SHELL_H_ */
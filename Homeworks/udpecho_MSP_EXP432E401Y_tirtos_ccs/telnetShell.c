@@ -0,0 +1,339 @@
+/*
+ *    ======== telnetShell.c ========
+ *    TCP shell sessions. Each session has its own LineEdit and output
+ *    buffer: echo, redraws and command output collect in the buffer and go
+ *    out in one send() when a command line is done, when the bytes of one
+ *    recv() have all been handled, or when the buffer fills, so a remote
+ *    terminal does not cost a TCP segment per character.
+ *
+ *    Just enough telnet for a plain client: the server offers to echo and
+ *    to suppress go-ahead, which puts the client in character mode, and
+ *    skips whatever the client negotiates back.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+/* BSD support */
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+
+#include <ti/display/Display.h>
+
+#include "lineEdit.h"
+#include "netStats.h"
+#include "shell.h"
+#include "telnetShell.h"
+
+/* telnet commands and options (RFC 854, 857, 858) */
+#define IAC     255
+#define DONT    254
+#define DO      253
+#define WONT    252
+#define WILL    251
+#define SB      250
+#define SE      240
+#define OPT_ECHO    1
+#define OPT_SGA     3
+
+typedef enum {
+    TN_DATA,
+    TN_IAC,                         /* after IAC */
+    TN_OPTION,                      /* after IAC WILL/WONT/DO/DONT */
+    TN_SB,                          /* inside IAC SB ... IAC SE */
+    TN_SB_IAC
+} TelnetState;
+
+typedef struct {
+    int          sock;              /* -1 when the slot is free */
+    LineEdit     ed;
+    char         out[TELNET_OUTBUF];
+    size_t       outLen;
+    TelnetState  state;
+    bool         cr;                /* drop the LF or NUL after a CR */
+    bool         closing;
+} TelnetSession;
+
+extern Display_Handle display;
+
+extern void fdOpenSession();
+extern void fdCloseSession();
+extern void *TaskSelf();
+
+static const char banner[] = "\r\n*** MSP432 Command Shell Ready ***\r\n"
+    "Type -help for a list of commands, -exit to leave.\r\n\r\n";
+
+static const char busy[] = "!! all sessions in use\r\n";
+
+static const unsigned char negotiate[] = {
+    IAC, WILL, OPT_ECHO, IAC, WILL, OPT_SGA
+};
+
+static TelnetSession sessions[TELNET_MAX_SESSIONS];
+
+/*
+ *  ======== flush ========
+ *  Sends what the session has buffered. A session whose peer has gone,
+ *  or has stopped reading for TELNET_SEND_TIMEOUT_MS (SO_SNDTIMEO, set in
+ *  sessionOpen), is marked for closing and its output dropped, so one
+ *  stalled client cannot hold up the task that serves the others.
+ */
+static void flush(TelnetSession *s)
+{
+    size_t sent = 0;
+    int    n;
+
+    while (sent < s->outLen && !s->closing) {
+        n = send(s->sock, s->out + sent, s->outLen - sent, 0);
+
+        /* TCP may take part of it; a failure or a timeout ends it */
+        netCountTx(NETTASK_TELNET, NETSOCK_TELNET, n,
+            n > 0 ? n : (int)(s->outLen - sent));
+        if (n <= 0) {
+            s->closing = true;
+            break;
+        }
+        sent += n;
+    }
+    s->outLen = 0;
+}
+
+/*
+ *  ======== sessionWrite ========
+ *  The LineEdit write callback; only a full buffer sends.
+ */
+static void sessionWrite(void *ctx, const char *p, size_t n)
+{
+    TelnetSession *s = ctx;
+    size_t         k;
+
+    while (n > 0) {
+        k = TELNET_OUTBUF - s->outLen;
+        k = n < k ? n : k;
+        memcpy(s->out + s->outLen, p, k);
+        s->outLen += k;
+        p += k;
+        n -= k;
+        if (s->outLen == TELNET_OUTBUF) {
+            flush(s);
+        }
+    }
+}
+
+/*
+ *  ======== telnetData ========
+ *  Strips telnet commands; true if ch is a byte for the line editor.
+ */
+static bool telnetData(TelnetSession *s, unsigned char ch)
+{
+    switch (s->state) {
+        case TN_IAC:
+            /* IAC IAC is a data 255, which the editor would ignore */
+            s->state = (ch >= WILL && ch <= DONT) ? TN_OPTION :
+                (ch == SB) ? TN_SB : TN_DATA;
+            return (false);
+        case TN_OPTION:
+            s->state = TN_DATA;
+            return (false);
+        case TN_SB:
+            s->state = (ch == IAC) ? TN_SB_IAC : TN_SB;
+            return (false);
+        case TN_SB_IAC:
+            s->state = (ch == SE) ? TN_DATA : TN_SB;
+            return (false);
+        default:
+            break;
+    }
+
+    if (ch == IAC) {
+        s->state = TN_IAC;
+        return (false);
+    }
+
+    /* a telnet newline is CR LF, or CR NUL for a bare CR */
+    if (s->cr && (ch == '\n' || ch == '\0')) {
+        s->cr = false;
+        return (false);
+    }
+    s->cr = (ch == '\r');
+
+    return (true);
+}
+
+/*
+ *  ======== sessionOpen ========
+ */
+static void sessionOpen(int sock)
+{
+    TelnetSession *s = NULL;
+    struct timeval timeout;
+    int            one = 1;
+    unsigned       i;
+
+    for (i = 0; i < TELNET_MAX_SESSIONS && s == NULL; i++) {
+        if (sessions[i].sock == -1) {
+            s = &sessions[i];
+        }
+    }
+    if (s == NULL) {
+        send(sock, busy, sizeof(busy) - 1, MSG_DONTWAIT);
+        close(sock);
+        return;
+    }
+
+    /* we coalesce ourselves; what we send should go at once */
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    timeout.tv_sec  = 0;
+    timeout.tv_usec = TELNET_SEND_TIMEOUT_MS * 1000;
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    memset(s, 0, sizeof(*s));
+    s->sock = sock;
+    s->state = TN_DATA;
+    lineEditInit(&s->ed, sessionWrite, s);
+    sessionWrite(s, (const char *)negotiate, sizeof(negotiate));
+    sessionWrite(s, banner, sizeof(banner) - 1);
+    lineEditPrompt(&s->ed);
+    flush(s);
+}
+
+/*
+ *  ======== sessionClose ========
+ */
+static void sessionClose(TelnetSession *s)
+{
+    close(s->sock);
+    s->sock = -1;
+}
+
+/*
+ *  ======== sessionInput ========
+ *  Runs one recv()'s worth of bytes through the editor and the shell.
+ */
+static void sessionInput(TelnetSession *s, const uint8_t *p, int len)
+{
+    static char response[TELNET_RESPONSE];
+    size_t      n;
+    int         i;
+
+    for (i = 0; i < len && !s->closing; i++) {
+        if (!telnetData(s, p[i]) || !lineEditFeed(&s->ed, (char)p[i])) {
+            continue;
+        }
+        if (!strcmp(s->ed.buf, "-exit")) {
+            flush(s);
+            s->closing = true;
+            break;
+        }
+        n = shellExecute(s->ed.buf, response, sizeof(response));
+        sessionWrite(s, response, n);
+        lineEditPrompt(&s->ed);
+        flush(s);
+    }
+
+    /* the echo of whatever was typed since */
+    flush(s);
+}
+
+/*
+ *  ======== openListener ========
+ */
+static int openListener(void)
+{
+    struct sockaddr_in addr;
+    int                sock;
+    int                one = 1;
+
+    sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == -1) {
+        return (-1);
+    }
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(TELNET_PORT);
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            listen(sock, TELNET_MAX_SESSIONS) != 0) {
+        close(sock);
+        return (-1);
+    }
+
+    return (sock);
+}
+
+/*
+ *  ======== telnetShellFxn ========
+ */
+void *telnetShellFxn(void *arg0)
+{
+    static uint8_t buffer[256];
+    fd_set         readSet;
+    int            listener, maxFd, sock, n;
+    unsigned       i;
+
+    fdOpenSession(TaskSelf());
+
+    for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+        sessions[i].sock = -1;
+    }
+
+    listener = openListener();
+    if (listener == -1) {
+        Display_printf(display, 0, 0, "Error: telnet port %d not bound.\n",
+            TELNET_PORT);
+        fdCloseSession(TaskSelf());
+        return (NULL);
+    }
+    Display_printf(display, 0, 0, "  telnet shell on port %d\n", TELNET_PORT);
+
+    for (;;) {
+        FD_ZERO(&readSet);
+        FD_SET(listener, &readSet);
+        maxFd = listener;
+        for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+            if (sessions[i].sock != -1) {
+                FD_SET(sessions[i].sock, &readSet);
+                if (sessions[i].sock > maxFd) {
+                    maxFd = sessions[i].sock;
+                }
+            }
+        }
+
+        if (select(maxFd + 1, &readSet, NULL, NULL, NULL) <= 0) {
+            continue;
+        }
+
+        if (FD_ISSET(listener, &readSet)) {
+            sock = accept(listener, NULL, NULL);
+            if (sock != -1) {
+                sessionOpen(sock);
+            }
+        }
+
+        for (i = 0; i < TELNET_MAX_SESSIONS; i++) {
+            TelnetSession *s = &sessions[i];
+
+            if (s->sock == -1 || !FD_ISSET(s->sock, &readSet)) {
+                continue;
+            }
+            n = recv(s->sock, buffer, sizeof(buffer), 0);
+            netCountRx(NETTASK_TELNET, NETSOCK_TELNET, n);
+            if (n <= 0) {
+                s->closing = true;
+            }
+            else {
+                sessionInput(s, buffer, n);
+            }
+            if (s->closing) {
+                sessionClose(s);
+            }
+        }
+    }
+}
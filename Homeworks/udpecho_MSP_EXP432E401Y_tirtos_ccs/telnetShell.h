@@ -0,0 +1,23 @@
+/*
+ *    ======== telnetShell.h ========
+ *    The console's shell over TCP: each connection gets its own line
+ *    editor in front of the same command set (shellExecute()).
+ */
+
+#ifndef TELNETSHELL_H_
+#define TELNETSHELL_H_
+
+#define TELNET_PORT         23
+#define TELNET_MAX_SESSIONS 3
+#define TELNET_OUTBUF       512     /* per session; a full one goes out */
+#define TELNET_RESPONSE     2048    /* output of one command line */
+#define TELNET_SEND_TIMEOUT_MS 250  /* a send stalled this long closes it */
+
+/*
+ *  pthread entry; arg0 is unused. One task serves the listener and every
+ *  session from a select() loop, so sessions take turns as the console
+ *  and control port do.
+ */
+void *telnetShellFxn(void *arg0);
+
+#endif /* TELNETSHELL_H_ */
@@ -0,0 +1,67 @@
+/*
+ *    ======== tokenBucket.c ========
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "tokenBucket.h"
+
+#define US_PER_S    1000000
+
+/*
+ *  ======== tbInit ========
+ */
+void tbInit(TokenBucket *b, uint32_t rateBps, uint32_t burst,
+            uint64_t nowUs)
+{
+    b->rateBps = rateBps;
+    b->burst = burst;
+    b->tokens = (int64_t)burst * US_PER_S;
+    b->lastUs = nowUs;
+}
+
+/*
+ *  ======== refill ========
+ */
+static void refill(TokenBucket *b, uint64_t nowUs)
+{
+    int64_t  full = (int64_t)b->burst * US_PER_S;
+    uint64_t elapsed = nowUs - b->lastUs;
+
+    b->lastUs = nowUs;
+    if (b->tokens >= full) {
+        return;
+    }
+    /* compare before multiplying: a long idle spell would overflow */
+    if (elapsed >= (uint64_t)(full - b->tokens) / b->rateBps + 1) {
+        b->tokens = full;
+    }
+    else {
+        b->tokens += (int64_t)(elapsed * b->rateBps);
+    }
+}
+
+/*
+ *  ======== tbTake ========
+ */
+uint32_t tbTake(TokenBucket *b, unsigned len, unsigned reserve,
+                uint64_t nowUs)
+{
+    uint64_t want = (uint64_t)len + reserve;
+    int64_t  need;
+
+    if (b->rateBps == 0) {
+        return (0);
+    }
+    refill(b, nowUs);
+
+    need = (int64_t)(want < b->burst ? want : b->burst) * US_PER_S;
+    if (b->tokens < need) {
+        /* rounded up, so waiting that long is always enough */
+        return ((uint32_t)((need - b->tokens + b->rateBps - 1) / b->rateBps));
+    }
+    b->tokens -= (int64_t)len * US_PER_S;
+
+    return (0);
+}
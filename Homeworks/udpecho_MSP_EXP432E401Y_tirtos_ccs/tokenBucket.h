@@ -0,0 +1,42 @@
+/*
+ *    ======== tokenBucket.h ========
+ *    Token bucket rate limiter. Tokens are bytes; they accrue at rateBps
+ *    up to burst, and a send of len bytes takes len of them. A send bigger
+ *    than the bucket goes once the bucket is full and leaves it in debt,
+ *    so the long-run rate holds for any packet size.
+ *
+ *    A reserve gives two classes of traffic: a send that asks to leave
+ *    reserve bytes behind cannot drain the bucket below them, so a flood of
+ *    such sends still leaves room for the sends that ask for none.
+ *
+ *    Tokens are kept in byte-microseconds so no fraction of a byte is lost
+ *    between calls, whatever the rate. Plain C with no NDK or driver
+ *    dependencies; the caller provides the clock and any locking.
+ */
+
+#ifndef TOKENBUCKET_H_
+#define TOKENBUCKET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint32_t rateBps;               /* bytes per second, 0 for no limit */
+    uint32_t burst;                 /* bucket depth, bytes */
+    int64_t  tokens;                /* byte-us; negative after a big send */
+    uint64_t lastUs;
+} TokenBucket;
+
+/* starts with a full bucket */
+void tbInit(TokenBucket *b, uint32_t rateBps, uint32_t burst,
+            uint64_t nowUs);
+
+/*
+ *  Takes len bytes if they are there, with reserve bytes to spare, and
+ *  returns 0; otherwise takes nothing and returns the microseconds until
+ *  they will be.
+ */
+uint32_t tbTake(TokenBucket *b, unsigned len, unsigned reserve,
+                uint64_t nowUs);
+
+#endif /* TOKENBUCKET_H_ */
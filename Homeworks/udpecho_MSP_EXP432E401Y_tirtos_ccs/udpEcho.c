@@ -51,39 +51,261 @@
 
 #include <ti/display/Display.h>
 
+#include "audioAdapt.h"
+#include "audioClip.h"
+#include "audioRx.h"
+#include "clientTable.h"
+#include "clockSync.h"
+#include "echoCore.h"
+#include "netStats.h"
+#include "shell.h"
+#include "udpEcho.h"
+#include "udpPace.h"
+#include "usClock.h"
+
 #define UDPPACKETSIZE 1472
 #define MAXPORTLEN    6
 
+/* rxUs is the usClock time at which the datagram was read */
+typedef void (*UdpHandler)(int sock, uint8_t *buf, int len,
+    struct sockaddr_in *from, socklen_t fromLen, uint64_t rxUs);
+
+typedef struct {
+    const char *name;
+    uint16_t    port;
+    UdpHandler  handler;
+    NetSock     id;             /* row in the -net counters */
+    int         sock;
+} UdpService;
+
 extern Display_Handle display;
 
 extern void fdOpenSession();
 extern void fdCloseSession();
 extern void *TaskSelf();
 
+EchoStats echoStats;
+uint32_t  udpEchoIfAddr;
+
+static struct {
+    bool           joined;
+    struct ip_mreq mreq;
+    char           name[INET_ADDRSTRLEN];
+} audioGroup;
+
 /*
- *  ======== echoFxn ========
- *  Echoes UDP messages.
- *
+ *  ======== reply ========
+ *  sendto() for the handlers, counted against the server task. Replies
+ *  are best effort: this task must not block with audio arriving, so one
+ *  that finds no tokens is dropped (udpPace.h) and 0 returned.
  */
-void *echoFxn(void *arg0)
+static int reply(NetSock id, int sock, const void *buf, int len,
+    struct sockaddr_in *to, socklen_t toLen)
+{
+    int bytesSent;
+
+    if (!udpPace(len, PACE_DROP)) {
+        return (0);
+    }
+    bytesSent = sendto(sock, buf, len, 0, (struct sockaddr *)to, toLen);
+    netCountTx(NETTASK_SERVER, id, bytesSent, len);
+
+    return (bytesSent);
+}
+
+/*
+ *  ======== echoPacket ========
+ *  NDK side of the portable echo core, one datagram per select() wakeup.
+ */
+static void echoPacket(int sock, uint8_t *buf, int len,
+    struct sockaddr_in *from, socklen_t fromLen, uint64_t rxUs)
+{
+    int      bytesSent;
+    int      replyLen;
+    uint64_t txUs;
+
+    replyLen = echoCoreProcess(buf, len, UDPPACKETSIZE, rxUs);
+    if (replyLen == 0) {
+        return;
+    }
+
+    txUs = usClockNow();
+    echoCoreStampTx(buf, replyLen, txUs);
+
+    bytesSent = reply(NETSOCK_ECHO, sock, buf, replyLen, from, fromLen);
+    if (bytesSent != replyLen) {
+        echoStats.errors++;
+        if (bytesSent == 0) {
+            echoStats.paced++;
+        }
+        return;
+    }
+    echoCoreCount(&echoStats, bytesSent, (uint32_t)(txUs / 1000000));
+}
+
+/*
+ *  ======== audioPacket ========
+ */
+static void audioPacket(int sock, uint8_t *buf, int len,
+    struct sockaddr_in *from, socklen_t fromLen, uint64_t rxUs)
+{
+    unsigned n;
+    uint32_t ssrc;
+    uint64_t probeUs;
+
+    /* feedback probes share the port; the report goes back to the sender */
+    if (audioAdaptIsProbe(buf, len, &ssrc, &probeUs)) {
+        n = audioRxProbe(buf, len);
+        if (n > 0) {
+            reply(NETSOCK_AUDIO, sock, buf, n, from, fromLen);
+        }
+        return;
+    }
+    audioRxPacket(buf, len);
+}
+
+/*
+ *  ======== controlPacket ========
+ *  Each datagram is a batch of command lines; all their output goes back
+ *  as one datagram.
+ */
+static void controlPacket(int sock, uint8_t *buf, int len,
+    struct sockaddr_in *from, socklen_t fromLen, uint64_t rxUs)
+{
+    static char request[UDPPACKETSIZE + 1];
+    static char response[UDPPACKETSIZE];
+    size_t      n;
+
+    memcpy(request, buf, len);
+    request[len] = '\0';
+
+    /* this task also takes in audio, clock sync and clips; no waiting */
+    n = shellExecuteNoWait(request, response, sizeof(response));
+    if (n > 0) {
+        reply(NETSOCK_CONTROL, sock, response, n, from, fromLen);
+    }
+}
+
+/*
+ *  ======== syncPacket ========
+ *  Server half of a clock sync exchange: stamp t2 and t3, send it back.
+ */
+static void syncPacket(int sock, uint8_t *buf, int len,
+    struct sockaddr_in *from, socklen_t fromLen, uint64_t rxUs)
+{
+    unsigned n = clockSyncReflect(buf, len, rxUs);
+
+    if (n == 0) {
+        return;
+    }
+    clockSyncStampTx(buf, usClockNow());
+    reply(NETSOCK_SYNC, sock, buf, n, from, fromLen);
+}
+
+/*
+ *  ======== clipPacket ========
+ *  Clip upload: store the chunk, ACK as the protocol asks (clipXfer.h).
+ */
+static void clipPacket(int sock, uint8_t *buf, int len,
+    struct sockaddr_in *from, socklen_t fromLen, uint64_t rxUs)
+{
+    uint8_t  ack[CLIPXFER_ACK_LEN];
+    unsigned n = audioClipPacket(buf, len, ack);
+
+    if (n > 0) {
+        reply(NETSOCK_CLIP, sock, ack, n, from, fromLen);
+    }
+}
+
+static UdpService services[] = {
+#if !ECHO_ZEROCOPY
+    { "echo",    UDPECHO_PORT,    echoPacket,    NETSOCK_ECHO,    -1 },
+#endif
+    { "audio",   AUDIORX_PORT,    audioPacket,   NETSOCK_AUDIO,   -1 },
+    { "control", UDPCONTROL_PORT, controlPacket, NETSOCK_CONTROL, -1 },
+    { "sync",    CLOCKSYNC_PORT,  syncPacket,    NETSOCK_SYNC,    -1 },
+    { "clip",    AUDIOCLIP_PORT,  clipPacket,    NETSOCK_CLIP,    -1 },
+};
+
+#define NUM_SERVICES (sizeof(services) / sizeof(services[0]))
+
+/*
+ *  ======== audioSocket ========
+ */
+static int audioSocket(void)
+{
+    unsigned i;
+
+    for (i = 0; i < NUM_SERVICES; i++) {
+        if (services[i].port == AUDIORX_PORT) {
+            return (services[i].sock);
+        }
+    }
+
+    return (-1);
+}
+
+/*
+ *  ======== udpAudioLeave ========
+ */
+void udpAudioLeave(void)
+{
+    if (!audioGroup.joined) {
+        return;
+    }
+    setsockopt(audioSocket(), IPPROTO_IP, IP_DROP_MEMBERSHIP,
+        &audioGroup.mreq, sizeof(audioGroup.mreq));
+    audioGroup.joined = false;
+    audioGroup.name[0] = '\0';
+}
+
+/*
+ *  ======== udpAudioJoin ========
+ */
+bool udpAudioJoin(const char *group)
+{
+    struct ip_mreq mreq;
+    int            sock = audioSocket();
+
+    if (sock == -1 || inet_pton(AF_INET, group, &mreq.imr_multiaddr) != 1 ||
+            !IN_MULTICAST(ntohl(mreq.imr_multiaddr.s_addr))) {
+        return (false);
+    }
+    mreq.imr_interface.s_addr = udpEchoIfAddr;
+
+    udpAudioLeave();
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq,
+            sizeof(mreq)) != 0) {
+        Display_printf(display, 0, 0, "Error: join %s failed.\n", group);
+        return (false);
+    }
+    audioGroup.mreq = mreq;
+    audioGroup.joined = true;
+    strncpy(audioGroup.name, group, sizeof(audioGroup.name) - 1);
+
+    return (true);
+}
+
+/*
+ *  ======== udpAudioGroup ========
+ */
+const char *udpAudioGroup(void)
+{
+    return (audioGroup.joined ? audioGroup.name : NULL);
+}
+
+/*
+ *  ======== openService ========
+ */
+static int openService(uint16_t port)
 {
-    int                bytesRcvd;
-    int                bytesSent;
     int                status;
     int                server = -1;
-    fd_set             readSet;
     struct addrinfo    hints;
     struct addrinfo    *res, *p;
-    struct sockaddr_in clientAddr;
-    socklen_t          addrlen;
-    char               buffer[UDPPACKETSIZE];
     char               portNumber[MAXPORTLEN];
 
-    fdOpenSession(TaskSelf());
-
-    Display_printf(display, 0, 0, "UDP Echo example started\n");
-
-    sprintf(portNumber, "%d", *(uint16_t *)arg0);
+    sprintf(portNumber, "%d", port);
 
     memset(&hints, 0, sizeof(hints));
     hints.ai_family   = AF_INET;
@@ -95,7 +317,7 @@ void *echoFxn(void *arg0)
     if (status != 0) {
         Display_printf(display, 0, 0, "Error: getaddrinfo() failed: %s\n",
             gai_strerror(status));
-        goto shutdown;
+        return (-1);
     }
 
     for (p = res; p != NULL; p = p->ai_next) {
@@ -110,55 +332,94 @@ void *echoFxn(void *arg0)
         }
 
         close(server);
+        server = -1;
     }
+    freeaddrinfo(res);
 
-    if (server == -1) {
-        Display_printf(display, 0, 0, "Error: socket not created.\n");
-        goto shutdown;
-    } else if (p == NULL) {
-        Display_printf(display, 0, 0, "Error: bind failed.\n");
-        goto shutdown;
-    } else {
-        freeaddrinfo(res);
-        res = NULL;
+    return (server);
+}
+
+/*
+ *  ======== echoFxn ========
+ *  Serves every port in services[] from one select() loop.
+ *
+ */
+void *echoFxn(void *arg0)
+{
+    int                bytesRcvd;
+    int                status;
+    uint64_t           rxUs;
+    int                maxFd = -1;
+    unsigned           i;
+    fd_set             readSet;
+    struct sockaddr_in clientAddr;
+    socklen_t          addrlen;
+    static uint32_t    bufferWords[UDPPACKETSIZE / 4];  /* aligned for FEC */
+    uint8_t           *buffer = (uint8_t *)bufferWords;
+
+    fdOpenSession(TaskSelf());
+
+    Display_printf(display, 0, 0, "UDP Echo example started\n");
+
+    for (i = 0; i < NUM_SERVICES; i++) {
+        services[i].sock = openService(services[i].port);
+        if (services[i].sock == -1) {
+            Display_printf(display, 0, 0, "Error: %s port %d not bound.\n",
+                services[i].name, services[i].port);
+            goto shutdown;
+        }
+        if (services[i].sock > maxFd) {
+            maxFd = services[i].sock;
+        }
+        Display_printf(display, 0, 0, "  %s on port %d\n", services[i].name,
+            services[i].port);
+    }
+
+    if (AUDIORX_GROUP[0] != '\0' && udpAudioJoin(AUDIORX_GROUP)) {
+        Display_printf(display, 0, 0, "  audio joined %s\n", AUDIORX_GROUP);
     }
 
     do {
-        /*
-         *  readSet and addrlen are value-result arguments, which must be reset
-         *  in between each select() and recvfrom() call
-         */
+        /* readSet is a value-result argument and is rebuilt every pass */
         FD_ZERO(&readSet);
-        FD_SET(server, &readSet);
-        addrlen = sizeof(clientAddr);
+        for (i = 0; i < NUM_SERVICES; i++) {
+            FD_SET(services[i].sock, &readSet);
+        }
 
         /* Wait forever for the reply */
-        status = select(server + 1, &readSet, NULL, NULL, NULL);
-        if (status > 0) {
-            if (FD_ISSET(server, &readSet)) {
-                bytesRcvd = recvfrom(server, buffer, UDPPACKETSIZE, 0,
-                        (struct sockaddr *)&clientAddr, &addrlen);
-
-                if (bytesRcvd > 0) {
-                    bytesSent = sendto(server, buffer, bytesRcvd, 0,
-                            (struct sockaddr *)&clientAddr, addrlen);
-                    if (bytesSent < 0 || bytesSent != bytesRcvd) {
-                        Display_printf(display, 0, 0,
-                                "Error: sendto failed.\n");
-                        goto shutdown;
-                    }
-                }
+        status = select(maxFd + 1, &readSet, NULL, NULL, NULL);
+        if (status <= 0) {
+            break;
+        }
+
+        for (i = 0; i < NUM_SERVICES; i++) {
+            if (!FD_ISSET(services[i].sock, &readSet)) {
+                continue;
+            }
+
+            addrlen = sizeof(clientAddr);
+            bytesRcvd = recvfrom(services[i].sock, buffer, UDPPACKETSIZE, 0,
+                    (struct sockaddr *)&clientAddr, &addrlen);
+            netCountRx(NETTASK_SERVER, services[i].id, bytesRcvd);
+            if (bytesRcvd <= 0) {
+                continue;
             }
+            rxUs = usClockNow();
+
+            clientCountPacket(clientAddr.sin_addr.s_addr, clientAddr.sin_port,
+                bytesRcvd, clientNowMs());
+            services[i].handler(services[i].sock, buffer, bytesRcvd,
+                &clientAddr, addrlen, rxUs);
         }
     } while (status > 0);
 
 shutdown:
-    if (res) {
-        freeaddrinfo(res);
-    }
-
-    if (server != -1) {
-        close(server);
+    udpAudioLeave();
+    for (i = 0; i < NUM_SERVICES; i++) {
+        if (services[i].sock != -1) {
+            close(services[i].sock);
+            services[i].sock = -1;
+        }
     }
 
     fdCloseSession(TaskSelf());
@@ -0,0 +1,45 @@
+/*
+ *    ======== udpEcho.h ========
+ *    UDP echo tasks and the counters they share.
+ */
+
+#ifndef UDPECHO_H_
+#define UDPECHO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "echoCore.h"
+
+#define UDPECHO_PORT        1000
+#define UDPCONTROL_PORT     1001
+#define ECHO_ZEROCOPY       1   /* echo port served by echoZeroCopyFxn */
+
+/* shared by both echo paths; pps rolls once a second (echoCoreCount) */
+extern EchoStats echoStats;
+
+/*
+ *  pthread entries. echoFxn serves the audio, control, sync and clip
+ *  ports (and the echo port unless ECHO_ZEROCOPY) from one select() loop;
+ *  arg0 is unused.
+ *  echoZeroCopyFxn serves only the echo port, passed in arg0.
+ */
+void *echoFxn(void *arg0);
+
+/*
+ *  Joins or leaves a multicast group (dotted quad) on the audio port, so
+ *  one sender's stream reaches every joined board with a single send.
+ *  Membership is reported by the NDK's IGMP. The interface address comes
+ *  from netIPAddrHook. One group at a time; joining another leaves the
+ *  current one. Call from shell commands only, which take turns (shell.h);
+ *  the calling task needs an fd session.
+ */
+bool udpAudioJoin(const char *group);
+void udpAudioLeave(void);
+const char *udpAudioGroup(void);
+
+/* the interface address, network byte order; 0 until DHCP completes */
+extern uint32_t udpEchoIfAddr;
+void *echoZeroCopyFxn(void *arg0);
+
+#endif /* UDPECHO_H_ */
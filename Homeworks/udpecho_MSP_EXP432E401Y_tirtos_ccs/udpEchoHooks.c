@@ -37,6 +37,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include <pthread.h>
 
@@ -48,30 +49,219 @@
 #include <ti/net/slnetutils.h>
 
 #include <ti/display/Display.h>
+#include <ti/drivers/GPIO.h>
+#include <ti/drivers/Timer.h>
 #include <ti/drivers/emac/EMACMSP432E4.h>
 
-#define UDPPORT 1000
+#include "appTasks.h"
+#include "audioCapture.h"
+#include "audioClip.h"
+#include "audioPlayback.h"
+#include "audioProc.h"
+#include "audioRx.h"
+#include "boardShell.h"
+#include "clientTable.h"
+#include "clockSyncClient.h"
+#include "console.h"
+#include "netStats.h"
+#include "shell.h"
+#include "telnetShell.h"
+#include "udpEcho.h"
+#include "udpGen.h"
+#include "udpPace.h"
+#include "usClock.h"
 
-#define UDPHANDLERSTACK 4096
+
+#define UDPSTACK        4096
+#define AUDIOTXSTACK    2048
+#define PLAYOUTSTACK    1024
+#define CLOCKSYNCSTACK  2048
+#define CONSOLESTACK    3072    /* -script and -if nest command lines */
+#define UDPGENSTACK     1024
+#define TELNETSTACK     3072
+#define EVENTSTACK      3072
+#define STACK_FILL      0xBE    /* as the kernel paints its own stacks */
 #define IFPRI  4   /* Ethernet interface priority */
 
 /* Prototypes */
 extern Display_Handle display;
 extern void *echoFxn(void *arg0);
+extern void *echoZeroCopyFxn(void *arg0);
+extern void *audioTxFxn(void *arg0);
+
+typedef struct {
+    const char *name;
+    void     *(*fxn)(void *);
+    void       *arg0;
+    int         priority;
+    size_t      stackSize;
+    uint64_t   *stack;              /* 8-byte aligned for the AAPCS */
+    bool        started;
+} AppTask;
+
+static uint16_t echoPort = UDPECHO_PORT;
+static uint32_t ssrc;
+
+static uint64_t udpStack[UDPSTACK / 8];
+static uint64_t zcStack[UDPSTACK / 8];
+static uint64_t txStack[AUDIOTXSTACK / 8];
+static uint64_t playoutStack[PLAYOUTSTACK / 8];
+static uint64_t syncStack[CLOCKSYNCSTACK / 8];
+static uint64_t consoleStack[CONSOLESTACK / 8];
+static uint64_t genStack[UDPGENSTACK / 8];
+static uint64_t telnetStack[TELNETSTACK / 8];
+static uint64_t eventStack[EVENTSTACK / 8];
 
 /*
- *  ======== netIPAddrHook ========
- *  user defined network IP address hook
+ *  Every pthread in the firmware. The NDK's own thread and the sample
+ *  clock interrupts sit above all of these. Of ours, playout is highest:
+ *  it owes the DAC a frame every 8 ms and a burst of packets or a slow
+ *  command must not starve it. The UDP server (which feeds the jitter
+ *  buffer) and the sender are next, as audio. The zero-copy echo, clock
+ *  sync, the packet generator and the shells take what is left; clock
+ *  sync timestamps both ends, so waiting costs it nothing but a rejected
+ *  sample, and the generator measures what the link gives the board with
+ *  audio running. Board events run -callback and -ticker payloads, which
+ *  wait their turn like any other shell command.
+ *
+ *  Playout, the console and board events start at boot (appTasksBoot());
+ *  the rest use sockets and start when the interface has an address.
+ *  Stacks are static and painted so -tasks can report the peak use.
  */
-void netIPAddrHook(uint32_t IPAddr, unsigned int IfIdx, unsigned int fAdd)
+static AppTask appTasks[] = {
+    {"playout",   audioPlayoutFxn, NULL,      3, PLAYOUTSTACK,   playoutStack},
+    {"udp",       echoFxn,         NULL,      2, UDPSTACK,       udpStack},
+    {"audio tx",  audioTxFxn,      &ssrc,     2, AUDIOTXSTACK,   txStack},
+    {"echo zc",   echoZeroCopyFxn, &echoPort, 1, UDPSTACK,       zcStack},
+    {"clocksync", clockSyncFxn,    NULL,      1, CLOCKSYNCSTACK, syncStack},
+    {"udpgen",    udpGenFxn,       NULL,      1, UDPGENSTACK,    genStack},
+    {"console",   consoleFxn,      NULL,      1, CONSOLESTACK,   consoleStack},
+    {"telnet",    telnetShellFxn,  NULL,      1, TELNETSTACK,    telnetStack},
+    {"events",    boardEventFxn,   NULL,      1, EVENTSTACK,     eventStack},
+};
+
+#define NUM_APPTASKS (sizeof(appTasks) / sizeof(appTasks[0]))
+
+/*
+ *  ======== startTask ========
+ *  Create a detached pthread on its static stack; any failure here is
+ *  fatal.
+ */
+static void startTask(void *(*fxn)(void *))
 {
-    pthread_t          thread;
     pthread_attr_t     attrs;
     struct sched_param priParam;
+    pthread_t          thread;
+    AppTask           *t = NULL;
+    unsigned           i;
     int                retc;
-    int                detachState;
+
+    for (i = 0; i < NUM_APPTASKS; i++) {
+        if (appTasks[i].fxn == fxn) {
+            t = &appTasks[i];
+        }
+    }
+    if (t == NULL || t->started) {
+        return;
+    }
+
+    /* Set priority and stack attributes */
+    pthread_attr_init(&attrs);
+    priParam.sched_priority = t->priority;
+
+    retc = pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+    if (retc != 0) {
+        Display_printf(display, 0, 0,
+                "startTask: pthread_attr_setdetachstate() failed\n");
+        while (1);
+    }
+
+    pthread_attr_setschedparam(&attrs, &priParam);
+
+    memset(t->stack, STACK_FILL, t->stackSize);
+    retc |= pthread_attr_setstack(&attrs, t->stack, t->stackSize);
+    if (retc != 0) {
+        Display_printf(display, 0, 0,
+                "startTask: pthread_attr_setstack() failed\n");
+        while (1);
+    }
+
+    retc = pthread_create(&thread, &attrs, t->fxn, t->arg0);
+    if (retc != 0) {
+        Display_printf(display, 0, 0,
+                "startTask: pthread_create() failed\n");
+        while (1);
+    }
+    t->started = true;
+}
+
+/*
+ *  ======== appTasksInfo ========
+ *  Stacks grow down, so the paint left at the low end was never touched.
+ */
+unsigned appTasksInfo(TaskInfo *info, unsigned max)
+{
+    unsigned i, n = 0;
+
+    for (i = 0; i < NUM_APPTASKS && n < max; i++) {
+        const AppTask *t = &appTasks[i];
+        const uint8_t *p = (const uint8_t *)t->stack;
+        size_t         unused = 0;
+
+        if (!t->started) {
+            continue;
+        }
+        while (unused < t->stackSize && p[unused] == STACK_FILL) {
+            unused++;
+        }
+        info[n].name = t->name;
+        info[n].priority = t->priority;
+        info[n].stackSize = t->stackSize;
+        info[n].stackPeak = t->stackSize - unused;
+        n++;
+    }
+
+    return (n);
+}
+
+/*
+ *  ======== appTasksBoot ========
+ */
+void appTasksBoot(void)
+{
+    GPIO_init();
+    Timer_init();
+
+    usClockInit();
+    clientTableInit();
+    audioCaptureInit();
+    audioPlaybackInit();
+    audioRxInit();
+    audioClipInit();
+    audioProcInit();
+    clockSyncClientInit();
+    shellInit();
+    boardShellInit();
+    consoleInit();
+    udpPaceInit();
+
+    /* the DAC playout that drains the mixer, silent until streams arrive */
+    startTask(audioPlayoutFxn);
+
+    /* the serial shell; same commands as the control port */
+    startTask(consoleFxn);
+
+    /* -callback and -ticker payloads, from the timers and switches */
+    startTask(boardEventFxn);
+}
+
+/*
+ *  ======== netIPAddrHook ========
+ *  user defined network IP address hook
+ */
+void netIPAddrHook(uint32_t IPAddr, unsigned int IfIdx, unsigned int fAdd)
+{
     uint32_t           hostByteAddr;
-    static uint16_t    arg0 = UDPPORT;
     static bool        createTask = true;
     int32_t            status = 0;
 
@@ -97,44 +287,57 @@ void netIPAddrHook(uint32_t IPAddr, unsigned int IfIdx, unsigned int fAdd)
         while (1);
     }
 
+    if (fAdd) {
+        udpEchoIfAddr = IPAddr;
+    }
+    netStatsInterface(IPAddr, IfIdx, fAdd != 0);
+
     if (fAdd && createTask) {
         /*
-         *  Create the Task that handles incoming UDP packets.
-         *  arg0 will be the port that this task listens to.
+         *  The board's address doubles as its stream's SSRC so receivers
+         *  can tell boards apart, and so we can skip our own stream.
          */
+        ssrc = hostByteAddr;
+        audioRxSetLocalSsrc(ssrc);
 
-        /* Set priority and stack size attributes */
-        pthread_attr_init(&attrs);
-        priParam.sched_priority = 1;
+        /*
+         *  The task that serves the UDP ports: RTP audio in, control and
+         *  (unless the zero-copy echo has it) echo.
+         */
+        startTask(echoFxn);
 
-        detachState = PTHREAD_CREATE_DETACHED;
-        retc = pthread_attr_setdetachstate(&attrs, detachState);
-        if (retc != 0) {
-            Display_printf(display, 0, 0,
-                    "netIPAddrHook: pthread_attr_setdetachstate() failed\n");
-            while (1);
-        }
+#if ECHO_ZEROCOPY
+        startTask(echoZeroCopyFxn);
+#endif
 
-        pthread_attr_setschedparam(&attrs, &priParam);
+        /* the RTP audio sender */
+        startTask(audioTxFxn);
 
-        retc |= pthread_attr_setstacksize(&attrs, UDPHANDLERSTACK);
-        if (retc != 0) {
-            Display_printf(display, 0, 0,
-                    "netIPAddrHook: pthread_attr_setstacksize() failed\n");
-            while (1);
-        }
+        /* idle until -udpgen starts a run */
+        startTask(udpGenFxn);
 
-        retc = pthread_create(&thread, &attrs, echoFxn, (void *)&arg0);
-        if (retc != 0) {
-            Display_printf(display, 0, 0,
-                    "netIPAddrHook: pthread_create() failed\n");
-            while (1);
+        /* follow the master's clock unless we are the master */
+        if (CLOCKSYNC_MASTER[0] != '\0') {
+            startTask(clockSyncFxn);
         }
 
+        /* the TCP shell; same commands as the control port */
+        startTask(telnetShellFxn);
+
         createTask = false;
     }
 }
 
+/*
+ *  ======== netPoolReport ========
+ *  The NDK's own usage map of its small-block allocator: pages in use and,
+ *  per bucket size, blocks in use and the high-water mark.
+ */
+void netPoolReport(int (*prn)(const char *fmt, ...))
+{
+    mmCheck(MMCHECK_MAP, prn);
+}
+
 /*
  *  ======== serviceReport ========
  *  NDK service report.  Initially, just reports common system issues.
@@ -154,9 +357,8 @@ void serviceReport(uint32_t item, uint32_t status, uint32_t report, void *h)
     if ((item == CFGITEM_SERVICE_DHCPCLIENT) &&
             (status == CIS_SRV_STATUS_ENABLED) &&
             (report & NETTOOLS_STAT_FAULT)) {
+        /* the console and audio playout carry on without a network */
         Display_printf(display, 0, 0,
                 "DHCP Client initialization failed; check your network.\n");
-
-        while (1);
     }
 }
@@ -0,0 +1,179 @@
+/*
+ *    ======== udpEchoZc.c ========
+ *    Zero-copy UDP echo on the NDK native socket API.
+ *
+ *    recvncfrom() hands back the stack's own packet buffer instead of
+ *    copying it into ours; the payload goes straight back out with
+ *    sendto() (the one copy left is the stack's into the TX packet) and
+ *    the RX buffers are returned to the pool as soon as the batch is
+ *    sent. This file is only the NDK shim; the loop is echoCoreRun().
+ *    Kept out of udpEcho.c because the native API and the BSD headers
+ *    both define struct sockaddr.
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include <ti/ndk/inc/netmain.h>
+
+#include <ti/display/Display.h>
+
+#include "clientTable.h"
+#include "echoCore.h"
+#include "netStats.h"
+#include "udpEcho.h"
+#include "udpPace.h"
+#include "usClock.h"
+
+#define ZC_BATCH      8       /* NDK packet buffers held at once */
+
+extern Display_Handle display;
+
+typedef struct {
+    struct sockaddr_in addr;
+    HANDLE             hBuf;        /* NDK packet buffer lent to us */
+} ZcPeer;
+
+typedef struct {
+    SOCKET   sock;
+    ZcPeer   peer[ZC_BATCH];
+    unsigned held;
+} ZcIo;
+
+/*
+ *  ======== zcRecvBatch ========
+ *  recvncfrom() fills each message with the stack's own buffer.
+ */
+static int zcRecvBatch(void *ctx, EchoMsg *msgs, unsigned max)
+{
+    ZcIo    *io = ctx;
+    unsigned n;
+
+    for (n = 0; n < max && n < ZC_BATCH; n++) {
+        ZcPeer *p = &io->peer[n];
+        void   *buf;
+        int     addrlen = sizeof(p->addr);
+        int     bytes;
+
+        /* block for the first datagram, then drain what is queued */
+        bytes = NDK_recvncfrom(io->sock, &buf, n ? MSG_DONTWAIT : 0,
+                (struct sockaddr *)&p->addr, &addrlen, &p->hBuf);
+        if (bytes < 0) {
+            /* an empty queue after the first is not an error */
+            if (n == 0) {
+                netCountRx(NETTASK_ECHO_ZC, NETSOCK_ECHO, bytes);
+                Display_printf(display, 0, 0,
+                        "Error: recvncfrom failed (%d).\n", fdError());
+                return (-1);
+            }
+            break;
+        }
+
+        msgs[n].buf  = buf;
+        msgs[n].len  = bytes;
+        msgs[n].cap  = bytes;
+        msgs[n].peer = p;
+        io->held = n + 1;
+        netCountRx(NETTASK_ECHO_ZC, NETSOCK_ECHO, bytes);
+
+        clientCountPacket(p->addr.sin_addr.s_addr, p->addr.sin_port, bytes,
+            clientNowMs());
+    }
+
+    return ((int)n);
+}
+
+/*
+ *  ======== zcSendBatch ========
+ */
+static int zcSendBatch(void *ctx, EchoMsg *msgs, unsigned n)
+{
+    ZcIo    *io = ctx;
+    unsigned i;
+    int      sent = 0;
+
+    for (i = 0; i < n; i++) {
+        ZcPeer *p = msgs[i].peer;
+        int     bytes;
+
+        if (!udpPace(msgs[i].len, PACE_DROP)) {
+            echoStats.paced++;
+            continue;
+        }
+        bytes = NDK_sendto(io->sock, msgs[i].buf, msgs[i].len, 0,
+                (struct sockaddr *)&p->addr, sizeof(p->addr));
+        netCountTx(NETTASK_ECHO_ZC, NETSOCK_ECHO, bytes, (int)msgs[i].len);
+        if (bytes == (int)msgs[i].len) {
+            sent++;
+        }
+    }
+
+    return (sent);
+}
+
+/*
+ *  ======== zcRelease ========
+ *  Give every packet of the batch back to the pool, sent or not.
+ */
+static void zcRelease(void *ctx)
+{
+    ZcIo    *io = ctx;
+    unsigned i;
+
+    for (i = 0; i < io->held; i++) {
+        NDK_recvncfree(io->peer[i].hBuf);
+    }
+    io->held = 0;
+}
+
+/*
+ *  ======== zcNowUs ========
+ */
+static uint64_t zcNowUs(void *ctx)
+{
+    return (usClockNow());
+}
+
+/*
+ *  ======== echoZeroCopyFxn ========
+ *  Echoes UDP messages without copying them through a task buffer.
+ */
+void *echoZeroCopyFxn(void *arg0)
+{
+    static ZcIo        io;
+    static EchoMsg     msgs[ZC_BATCH];
+    const EchoIo       ops = { zcRecvBatch, zcSendBatch, zcRelease, zcNowUs };
+    struct sockaddr_in localAddr;
+
+    fdOpenSession(TaskSelf());
+
+    Display_printf(display, 0, 0, "UDP Echo (zero-copy) started\n");
+
+    io.sock = NDK_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (io.sock == INVALID_SOCKET) {
+        Display_printf(display, 0, 0, "Error: socket not created.\n");
+        goto shutdown;
+    }
+
+    memset(&localAddr, 0, sizeof(localAddr));
+    localAddr.sin_family      = AF_INET;
+    localAddr.sin_addr.s_addr = INADDR_ANY;
+    localAddr.sin_port        = NDK_htons(*(uint16_t *)arg0);
+
+    if (NDK_bind(io.sock, (struct sockaddr *)&localAddr,
+            sizeof(localAddr)) < 0) {
+        Display_printf(display, 0, 0, "Error: bind failed.\n");
+        goto shutdown;
+    }
+
+    echoCoreRun(&ops, &io, msgs, ZC_BATCH, &echoStats);
+
+shutdown:
+    if (io.sock != INVALID_SOCKET) {
+        fdClose(io.sock);
+    }
+
+    fdCloseSession(TaskSelf());
+
+    return (NULL);
+}
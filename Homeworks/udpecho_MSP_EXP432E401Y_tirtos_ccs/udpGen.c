@@ -0,0 +1,233 @@
+/*
+ *    ======== udpGen.c ========
+ *    The timer callback posts a counting semaphore once per period and the
+ *    task sends one datagram per count. A task that falls behind finds
+ *    counts waiting and sends back to back until it catches up, so the
+ *    average rate holds for as long as the board can keep up; the backlog
+ *    shows when it cannot.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include <pthread.h>
+#include <sched.h>
+/* BSD support */
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <ti/drivers/Timer.h>
+#include <ti/drivers/dpl/ClockP.h>
+#include <ti/drivers/dpl/SemaphoreP.h>
+#include <ti/display/Display.h>
+
+#include "ti_drivers_config.h"
+
+#include "netStats.h"
+#include "udpGen.h"
+#include "usClock.h"
+
+#define UDPGEN_POLL_MS      100     /* how often a stalled run checks stop */
+#define UDPGEN_FILL         0xA5
+
+extern Display_Handle display;
+
+extern void fdOpenSession();
+extern void *TaskSelf();
+
+static SemaphoreP_Handle startSem;
+static SemaphoreP_Handle tickSem;
+static Timer_Handle      timer;
+static volatile uint32_t ticks;
+static volatile bool     stopRequested;
+static UdpGenStatus      status;
+static uint32_t          buffer[UDPGEN_MAX_SIZE / 4];
+
+/*
+ *  ======== put32 ========
+ */
+static void put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+/*
+ *  ======== tickCallback ========
+ */
+static void tickCallback(Timer_Handle handle, int_fast16_t st)
+{
+    ticks++;
+    SemaphoreP_post(tickSem);
+}
+
+/*
+ *  ======== udpGenStart ========
+ *  Called from the shell, which serializes its callers.
+ */
+bool udpGenStart(const char *host, uint16_t port, unsigned size,
+                 uint32_t rate, uint32_t count)
+{
+    struct in_addr addr;
+
+    if (startSem == NULL || status.running ||
+            inet_pton(AF_INET, host, &addr) != 1 || port == 0 ||
+            size < UDPGEN_HDR_LEN || size > UDPGEN_MAX_SIZE ||
+            rate > UDPGEN_MAX_RATE || count == 0) {
+        return (false);
+    }
+
+    memset(&status, 0, sizeof(status));
+    status.host = addr.s_addr;
+    status.port = port;
+    status.size = size;
+    status.rate = rate;
+    status.count = count;
+    status.running = true;
+    stopRequested = false;
+    SemaphoreP_post(startSem);
+
+    return (true);
+}
+
+/*
+ *  ======== udpGenStop ========
+ */
+void udpGenStop(void)
+{
+    stopRequested = true;
+}
+
+/*
+ *  ======== udpGenStatus ========
+ */
+void udpGenStatus(UdpGenStatus *st)
+{
+    *st = status;
+    if (st->running) {
+        st->endUs = usClockNow();
+    }
+}
+
+/*
+ *  ======== run ========
+ */
+static void run(int sock)
+{
+    uint8_t           *p = (uint8_t *)buffer;
+    struct sockaddr_in dest;
+    uint32_t           pollTicks;
+    uint32_t           seq;
+    uint64_t           txUs;
+    int                n;
+
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_port = htons(status.port);
+    dest.sin_addr.s_addr = status.host;
+
+    memset(p, UDPGEN_FILL, status.size);
+    put32(p, UDPGEN_MAGIC);
+    pollTicks = UDPGEN_POLL_MS * 1000 / ClockP_getSystemTickPeriod();
+
+    /* drop ticks left over from a stopped run */
+    while (SemaphoreP_pend(tickSem, SemaphoreP_NO_WAIT) == SemaphoreP_OK) {
+    }
+    ticks = 0;
+
+    status.startUs = usClockNow();
+    if (status.rate != 0) {
+        Timer_setPeriod(timer, Timer_PERIOD_COUNTS,
+            USCLOCK_CPU_HZ / status.rate);
+        Timer_start(timer);
+    }
+
+    for (seq = 0; seq < status.count && !stopRequested; ) {
+        if (status.rate != 0) {
+            if (SemaphoreP_pend(tickSem, pollTicks) != SemaphoreP_OK) {
+                continue;
+            }
+            /* ticks beyond the one this send answers */
+            if (ticks - seq - 1 > status.maxBacklog) {
+                status.maxBacklog = ticks - seq - 1;
+            }
+        }
+
+        txUs = usClockNow();
+        put32(p + 4, seq);
+        put32(p + 8, (uint32_t)(txUs >> 32));
+        put32(p + 12, (uint32_t)txUs);
+        seq++;
+
+        n = sendto(sock, p, status.size, 0, (struct sockaddr *)&dest,
+                sizeof(dest));
+        netCountTx(NETTASK_UDPGEN, NETSOCK_UDPGEN, n, status.size);
+        if (n == (int)status.size) {
+            status.sent++;
+        }
+        else {
+            status.errors++;
+        }
+
+        /* back to back, let the console and the other low tasks in */
+        if (status.rate == 0) {
+            sched_yield();
+        }
+    }
+
+    if (status.rate != 0) {
+        Timer_stop(timer);
+    }
+    status.endUs = usClockNow();
+}
+
+/*
+ *  ======== udpGenFxn ========
+ */
+void *udpGenFxn(void *arg0)
+{
+    Timer_Params params;
+    uint64_t     us;
+    int          sock;
+
+    fdOpenSession(TaskSelf());
+
+    /* the period is set per run */
+    Timer_Params_init(&params);
+    params.period        = USCLOCK_CPU_HZ / 1000;
+    params.periodUnits   = Timer_PERIOD_COUNTS;
+    params.timerMode     = Timer_CONTINUOUS_CALLBACK;
+    params.timerCallback = tickCallback;
+    timer = Timer_open(CONFIG_TIMER_1, &params);
+    tickSem = SemaphoreP_create(0, NULL);
+    if (timer == NULL || tickSem == NULL) {
+        Display_printf(display, 0, 0, "udpGen: timer not opened.\n");
+        return (NULL);
+    }
+    startSem = SemaphoreP_createBinary(0);
+
+    for (;;) {
+        SemaphoreP_pend(startSem, SemaphoreP_WAIT_FOREVER);
+
+        sock = socket(AF_INET, SOCK_DGRAM, 0);
+        if (sock == -1) {
+            Display_printf(display, 0, 0, "udpGen: socket failed.\n");
+            status.running = false;
+            continue;
+        }
+        run(sock);
+        close(sock);
+
+        us = status.endUs - status.startUs;
+        Display_printf(display, 0, 0,
+            "udpGen: sent %u errors %u in %u ms, %u pps\n", status.sent,
+            status.errors, (uint32_t)(us / 1000),
+            us ? (uint32_t)(status.sent * 1000000ull / us) : 0);
+        status.running = false;
+    }
+}
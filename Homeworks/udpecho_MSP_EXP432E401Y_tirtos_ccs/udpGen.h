@@ -0,0 +1,55 @@
+/*
+ *    ======== udpGen.h ========
+ *    Board-side UDP packet generator for measuring transmit capacity.
+ *
+ *    Each datagram comes from one preallocated buffer with only its header
+ *    rewritten, big-endian:
+ *        0   magic "UGN1"
+ *        4   sequence number, from 0
+ *        8   usClock transmit time, 64-bit
+ *    and the rest a fixed fill. A hardware timer releases one datagram per
+ *    tick, so the rate does not depend on the RTOS tick; rate 0 sends back
+ *    to back. The generator is its own pacer and bypasses udpPace.
+ */
+
+#ifndef UDPGEN_H_
+#define UDPGEN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UDPGEN_MAGIC        0x55474E31u     /* "UGN1" */
+#define UDPGEN_HDR_LEN      16
+#define UDPGEN_MAX_SIZE     1472
+#define UDPGEN_MAX_RATE     50000           /* datagrams per second */
+
+typedef struct {
+    bool     running;
+    uint32_t host;                  /* network byte order */
+    uint16_t port;
+    unsigned size;
+    uint32_t rate;                  /* per second, 0 for back to back */
+    uint32_t count;
+    uint32_t sent;
+    uint32_t errors;                /* sendto() failed or was short */
+    uint32_t maxBacklog;            /* most timer ticks waiting on a send */
+    uint64_t startUs;
+    uint64_t endUs;                 /* or now, while running */
+} UdpGenStatus;
+
+/*
+ *  Starts a run in the generator task and returns at once. Fails if a
+ *  run is going or an argument is out of range (size UDPGEN_HDR_LEN to
+ *  UDPGEN_MAX_SIZE, rate up to UDPGEN_MAX_RATE, count from 1).
+ */
+bool udpGenStart(const char *host, uint16_t port, unsigned size,
+                 uint32_t rate, uint32_t count);
+void udpGenStop(void);
+
+/* the current or last run */
+void udpGenStatus(UdpGenStatus *st);
+
+/* pthread entry; waits for runs. arg0 is unused */
+void *udpGenFxn(void *arg0);
+
+#endif /* UDPGEN_H_ */
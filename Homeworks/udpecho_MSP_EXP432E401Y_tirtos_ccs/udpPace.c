@@ -0,0 +1,102 @@
+/*
+ *    ======== udpPace.c ========
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include <pthread.h>
+
+#include "tokenBucket.h"
+#include "udpPace.h"
+#include "usClock.h"
+
+PaceStats udpPaceStats;
+
+static pthread_mutex_t paceLock;
+static TokenBucket     bucket;
+static uint32_t        paceKbps;
+
+/*
+ *  ======== udpPaceInit ========
+ */
+void udpPaceInit(void)
+{
+    pthread_mutexattr_t attrs;
+
+    pthread_mutexattr_init(&attrs);
+    pthread_mutexattr_setprotocol(&attrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&paceLock, &attrs);
+    pthread_mutexattr_destroy(&attrs);
+
+    udpPaceConfigure(UDPPACE_DEF_KBPS, UDPPACE_DEF_BURST);
+}
+
+/*
+ *  ======== udpPaceConfigure ========
+ */
+void udpPaceConfigure(uint32_t kbps, uint32_t burst)
+{
+    if (burst < UDPPACE_RESERVE) {
+        burst = UDPPACE_RESERVE;
+    }
+    pthread_mutex_lock(&paceLock);
+    paceKbps = kbps;
+    tbInit(&bucket, kbps * 125, burst, usClockNow());
+    pthread_mutex_unlock(&paceLock);
+}
+
+/*
+ *  ======== udpPaceConfig ========
+ */
+void udpPaceConfig(uint32_t *kbps, uint32_t *burst)
+{
+    pthread_mutex_lock(&paceLock);
+    *kbps = paceKbps;
+    *burst = bucket.burst;
+    pthread_mutex_unlock(&paceLock);
+}
+
+/*
+ *  ======== udpPace ========
+ */
+bool udpPace(unsigned len, PaceMode mode)
+{
+    uint64_t start = usClockNow();
+    uint64_t now = start;
+    uint32_t waitUs;
+    unsigned reserve = (mode == PACE_DROP) ? UDPPACE_RESERVE : 0;
+
+    pthread_mutex_lock(&paceLock);
+    while ((waitUs = tbTake(&bucket, len + UDPPACE_OVERHEAD, reserve,
+            now)) != 0) {
+        if (mode == PACE_DROP) {
+            udpPaceStats.dropped++;
+            pthread_mutex_unlock(&paceLock);
+            return (false);
+        }
+        if (now - start + waitUs > UDPPACE_MAX_WAIT_MS * 1000) {
+            udpPaceStats.timedOut++;
+            pthread_mutex_unlock(&paceLock);
+            return (false);
+        }
+
+        /* other senders run meanwhile; they may take the tokens first */
+        pthread_mutex_unlock(&paceLock);
+        usleep(waitUs);
+        pthread_mutex_lock(&paceLock);
+        now = usClockNow();
+    }
+
+    if (now == start) {
+        udpPaceStats.passed++;
+    }
+    else {
+        udpPaceStats.deferred++;
+        udpPaceStats.deferredUs += (uint32_t)(now - start);
+    }
+    pthread_mutex_unlock(&paceLock);
+
+    return (true);
+}
@@ -0,0 +1,59 @@
+/*
+ *    ======== udpPace.h ========
+ *    One token bucket (tokenBucket.h) in front of every UDP send on the
+ *    board, so a burst of echo replies or feedback cannot fill the NDK's
+ *    buffer pools or the link ahead of the audio stream.
+ *
+ *    Sends come in two kinds. Best-effort sends (echo, control and sync
+ *    replies, probes, reports) never wait: without tokens to spare above
+ *    UDPPACE_RESERVE they are dropped, so the task serving the UDP ports
+ *    never blocks. Paced sends (the RTP media and parity) may use the
+ *    reserve and, when even that is empty, wait for tokens up to
+ *    UDPPACE_MAX_WAIT_MS, less than the capture ring holds, before they
+ *    too are dropped.
+ *
+ *    Pacing is off until -pace sets a rate: it would otherwise cap, and
+ *    quietly drop, the very echo load a throughput test is measuring.
+ */
+
+#ifndef UDPPACE_H_
+#define UDPPACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UDPPACE_DEF_KBPS    0       /* kbit/s; 0 is off, -pace turns it on */
+#define UDPPACE_DEF_BURST   16384   /* bytes */
+#define UDPPACE_RESERVE     4096    /* bytes only paced sends may use */
+#define UDPPACE_OVERHEAD    28      /* IPv4 and UDP headers per datagram */
+#define UDPPACE_MAX_WAIT_MS 40
+
+typedef enum {
+    PACE_DROP,                      /* best effort */
+    PACE_WAIT                       /* may defer */
+} PaceMode;
+
+typedef struct {
+    uint32_t passed;                /* sent without waiting */
+    uint32_t deferred;              /* waited for tokens, then sent */
+    uint32_t deferredUs;            /* total time spent waiting */
+    uint32_t dropped;               /* best effort, no tokens */
+    uint32_t timedOut;              /* paced, waited too long */
+} PaceStats;
+
+extern PaceStats udpPaceStats;
+
+void udpPaceInit(void);
+
+/* kbps 0 turns pacing off; burst below UDPPACE_RESERVE is raised to it */
+void udpPaceConfigure(uint32_t kbps, uint32_t burst);
+void udpPaceConfig(uint32_t *kbps, uint32_t *burst);
+
+/*
+ *  Call before each sendto() with the payload length. Returns true if
+ *  the datagram may go now (after any wait), false if it is to be
+ *  dropped. Blocks only in PACE_WAIT.
+ */
+bool udpPace(unsigned len, PaceMode mode);
+
+#endif /* UDPPACE_H_ */
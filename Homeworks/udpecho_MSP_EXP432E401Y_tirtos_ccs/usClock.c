@@ -0,0 +1,88 @@
+/*
+ *    ======== usClock.c ========
+ *    The DWT cycle counter runs at the CPU clock and wraps every 35.8 s
+ *    at 120 MHz. It is widened to 64 bits in software by counting wraps;
+ *    a periodic ClockP callback reads it well inside one wrap so a quiet
+ *    network cannot make us miss one.
+ */
+
+#include <stdint.h>
+
+#include <ti/drivers/dpl/ClockP.h>
+#include <ti/drivers/dpl/HwiP.h>
+
+#include "usClock.h"
+
+#define DEMCR           (*(volatile uint32_t *)0xE000EDFC)
+#define DEMCR_TRCENA    (1u << 24)
+#define DWT_CTRL        (*(volatile uint32_t *)0xE0001000)
+#define DWT_CTRL_CYCEN  (1u << 0)
+#define DWT_CYCCNT      (*(volatile uint32_t *)0xE0001004)
+
+#define USCLOCK_POLL_US 10000000u   /* well inside one 35.8 s wrap */
+
+static uint32_t lastCycles;
+static uint32_t wraps;
+
+/*
+ *  ======== readCycles ========
+ *  64-bit cycle count; the caller holds interrupts off.
+ */
+static uint64_t readCycles(void)
+{
+    uint32_t now = DWT_CYCCNT;
+
+    if (now < lastCycles) {
+        wraps++;
+    }
+    lastCycles = now;
+
+    return (((uint64_t)wraps << 32) | now);
+}
+
+/*
+ *  ======== pollFxn ========
+ */
+static void pollFxn(uintptr_t arg)
+{
+    usClockNow();
+}
+
+/*
+ *  ======== usClockInit ========
+ */
+void usClockInit(void)
+{
+    static ClockP_Handle poll;
+    ClockP_Params        params;
+    uint32_t             ticks;
+
+    if (poll != NULL) {
+        return;
+    }
+
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCEN;
+
+    ticks = USCLOCK_POLL_US / ClockP_getSystemTickPeriod();
+    ClockP_Params_init(&params);
+    params.period = ticks;
+    params.startFlag = true;
+    poll = ClockP_create(pollFxn, ticks, &params);
+}
+
+/*
+ *  ======== usClockNow ========
+ */
+uint64_t usClockNow(void)
+{
+    uintptr_t key;
+    uint64_t  cycles;
+
+    key = HwiP_disable();
+    cycles = readCycles();
+    HwiP_restore(key);
+
+    return (cycles / (USCLOCK_CPU_HZ / 1000000));
+}
@@ -0,0 +1,20 @@
+/*
+ *    ======== usClock.h ========
+ *    Free-running 64-bit microsecond counter for packet timestamps, built
+ *    on the Cortex-M4 DWT cycle counter. Monotonic from usClockInit() and
+ *    safe to read from any task or interrupt.
+ */
+
+#ifndef USCLOCK_H_
+#define USCLOCK_H_
+
+#include <stdint.h>
+
+#define USCLOCK_CPU_HZ      120000000u
+
+/* enables the cycle counter; call once before the network tasks start */
+void usClockInit(void);
+
+uint64_t usClockNow(void);
+
+#endif /* USCLOCK_H_ */
@@ -0,0 +1,70 @@
+/*
+ *  vad.c
+ *  Block energy + zero-crossing voice activity detector with hangover.
+ *  Author: Salim Sadman Bishal
+ *
+ *  A block is speech if its energy clears ratio x floor, or clears half of
+ *  that while crossing zero often enough to be an unvoiced sound (s, f, t)
+ *  that energy alone would miss. The first few blocks only seed the floor.
+ *  After that it follows the background quickly while closed and creeps up
+ *  by a fixed fraction while open, so a step in room noise does not hold
+ *  the gate open forever but a long sentence does not close it either.
+ */
+
+#include "vad.h"
+
+void vadInit(Vad *v)
+{
+    v->floor = VAD_FLOOR_MIN;
+    v->ratio = VAD_DEF_RATIO;
+    v->hangover = VAD_DEF_HANG;
+    v->zcrMin = VAD_DEF_ZCR_MIN;
+    v->hangLeft = 0;
+    v->active = false;
+    v->energy = 0;
+    v->zcr = 0;
+    v->voicedBlocks = v->silentBlocks = 0;
+}
+
+bool vadProcess(Vad *v, const int16_t *x, unsigned n)
+{
+    uint64_t sum = 0;
+    uint16_t zcr = 0;
+    unsigned i;
+    bool speech;
+
+    if (n == 0) return v->active;
+    for (i = 0; i < n; ++i) {
+        sum += (uint32_t)((int32_t)x[i] * x[i]);
+        if (i && ((x[i] ^ x[i-1]) < 0)) zcr++;
+    }
+    v->energy = (uint32_t)(sum / n);
+    v->zcr = zcr;
+
+    uint64_t thr = (uint64_t)v->floor * v->ratio;
+    if (v->voicedBlocks + v->silentBlocks < VAD_TRAIN_BLOCKS) {
+        /* seeding: running mean of the first blocks, gate stays closed */
+        uint32_t k = v->silentBlocks + 1;
+        v->floor = (k == 1) ? v->energy
+                            : v->floor + (int32_t)(v->energy - v->floor) / (int32_t)k;
+        speech = false;
+    } else {
+        speech = (v->energy > thr) ||
+                 (v->energy > thr / 2 && zcr >= v->zcrMin);
+    }
+
+    if (speech) {
+        v->hangLeft = v->hangover;
+        v->floor += v->floor >> 9;
+    } else {
+        if (v->hangLeft) v->hangLeft--;
+        if (v->energy > v->floor) v->floor += (v->energy - v->floor) >> 4;
+        else                      v->floor -= (v->floor - v->energy) >> 4;
+    }
+    if (v->floor < VAD_FLOOR_MIN) v->floor = VAD_FLOOR_MIN;
+
+    v->active = speech || v->hangLeft;
+    if (v->active) v->voicedBlocks++;
+    else           v->silentBlocks++;
+    return v->active;
+}
@@ -0,0 +1,41 @@
+/*
+ *  vad.h
+ *  Block energy + zero-crossing voice activity detector with hangover.
+ *  Author: Salim Sadman Bishal
+ *
+ *  Works on Q15 blocks after echo cancellation. The background level is
+ *  tracked while the detector is closed, so the threshold is relative to
+ *  the room rather than an absolute level. No TI headers.
+ */
+
+#ifndef VAD_H_
+#define VAD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define VAD_DEF_RATIO    4    // open when energy > 4x noise floor (~6 dB)
+#define VAD_DEF_HANG     12   // blocks held open after speech ends
+#define VAD_DEF_ZCR_MIN  12   // crossings/block that mark unvoiced speech
+#define VAD_FLOOR_MIN    1024 // mean square, about -60 dBFS
+#define VAD_TRAIN_BLOCKS 8    // blocks used to seed the floor after init
+
+typedef struct {
+    uint32_t floor;       // background mean square
+    uint16_t ratio;       // open threshold, multiple of floor
+    uint16_t hangover;    // blocks
+    uint16_t zcrMin;
+    uint16_t hangLeft;
+    bool     active;      // last decision, including hangover
+    uint32_t energy;      // last block mean square
+    uint16_t zcr;         // last block zero crossings
+    uint32_t voicedBlocks;
+    uint32_t silentBlocks;
+} Vad;
+
+void vadInit(Vad *v);
+
+/* returns true if the block should be passed on */
+bool vadProcess(Vad *v, const int16_t *x, unsigned n);
+
+#endif /* VAD_H_ */